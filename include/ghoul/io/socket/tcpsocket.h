@@ -30,6 +30,7 @@
 
 #include <ghoul/io/socket/sockettype.h>
 #include <ghoul/misc/exception.h>
+#include <ghoul/misc/task.h>
 #include <array>
 #include <atomic>
 #include <condition_variable>
@@ -38,9 +39,12 @@
 #include <thread>
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 struct addrinfo;
 
+namespace ghoul { class ThreadPool; }
+
 namespace ghoul::io {
 
 class TcpSocketServer;
@@ -88,7 +92,96 @@ public:
     template <typename T = char>
     bool put(const T* buffer, size_t nItems = 1);
 
+    /**
+     * The awaitable that is returned by #getAsync. The coroutine handle type is a
+     * template parameter, so this class can be declared without requiring C++20.
+     */
+    class InputAwaitable {
+    public:
+        /// Reads the input into the buffer and returns <code>true</code> if enough input
+        /// has arrived already and no other coroutine is waiting, or if the socket is
+        /// disconnected, in which case the coroutine is not suspended
+        bool await_ready();
+
+        /// Resumes the coroutine on the ThreadPool once the input has been read into the
+        /// buffer or the socket has been disconnected
+        template <typename Handle>
+        void await_suspend(Handle handle);
+
+        /// Returns whether the input was read into the buffer. The socket is not accessed
+        /// anymore, so it might already have been destroyed if it was disconnected
+        bool await_resume();
+
+    private:
+        friend class TcpSocket;
+        InputAwaitable(TcpSocket& socket, ThreadPool& pool, char* buffer, size_t nBytes);
+
+        TcpSocket& _socket;
+        ThreadPool& _pool;
+        char* _buffer;
+        size_t _nBytes;
+        bool _success = false;
+    };
+
+    /**
+     * Returns an awaitable that behaves like #get but does not block the calling thread
+     * while waiting for the input. Instead, the awaiting C++20 coroutine is suspended and
+     * resumed on one of the Worker%s of the \p pool as soon as \p nItems items have
+     * arrived or the socket was disconnected. If multiple coroutines are waiting at the
+     * same time, the input is handed to them in the order in which they started waiting.
+     * Reading from the same socket with #get, #peek, or #skip while a coroutine is
+     * waiting is not supported:
+     * \verbatim
+int32_t value;
+bool success = co_await socket.getAsync(pool, &value);
+\endverbatim
+     *
+     * \param pool The ThreadPool on which the awaiting coroutine is resumed
+     * \param buffer The buffer that receives the items. It has to stay valid until the
+     *        awaiting coroutine has been resumed
+     * \param nItems The number of items that are read
+     * \return The awaitable, which returns <code>false</code> if the socket was
+     *         disconnected before all items were read
+     */
+    template <typename T = char>
+    InputAwaitable getAsync(ThreadPool& pool, T* buffer, size_t nItems = 1);
+
 private:
+    /// A callback that is waiting for a number of bytes from the input queue, which are
+    /// read into the buffer before the callback is called with <code>true</code>
+    struct InputWaiter {
+        char* buffer;
+        size_t nBytes;
+        std::function<void(bool)> callback;
+    };
+
+    /**
+     * Reads \p nBytes bytes from the input queue into the \p buffer if they have arrived
+     * already and no InputWaiter is waiting before, or determines that the socket is
+     * disconnected. The \p success is set to whether the bytes were read.
+     *
+     * \return <code>true</code> if the bytes were read or the socket is disconnected
+     */
+    bool tryGetInput(char* buffer, size_t nBytes, bool& success);
+
+    /**
+     * Reads \p nBytes bytes from the input queue into the \p buffer and calls the
+     * \p callback with <code>true</code> as soon as they have arrived and all previous
+     * InputWaiter%s have received their input, or calls it with <code>false</code> when
+     * the socket is disconnected. If that is possible already, the \p callback is called
+     * immediately on the calling thread, otherwise it is called on the thread that
+     * receives the input.
+     */
+    void whenInputAvailable(char* buffer, size_t nBytes,
+        std::function<void(bool)> callback);
+
+    /**
+     * Hands the input to the InputWaiter%s in the order in which they started waiting and
+     * calls and removes the callbacks of all InputWaiter%s that received their input, or
+     * of all InputWaiter%s if the socket is disconnected.
+     */
+    void notifyInputWaiters();
+
     /**
      * Read size bytes from the socket, store them in buffer and dequeue them from input.
      * Block until size bytes have been read.
@@ -141,6 +234,9 @@ private:
     std::condition_variable _inputNotifier;
     std::deque<char> _inputQueue;
     std::array<char, 4096> _inputBuffer = { 0 };
+    // The callbacks waiting for input in the order in which they receive it, protected
+    // by the _inputQueueMutex
+    std::deque<InputWaiter> _inputWaiters;
 
     std::mutex _outputBufferMutex;
     std::mutex _outputQueueMutex;
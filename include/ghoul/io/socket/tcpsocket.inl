@@ -45,4 +45,23 @@ bool TcpSocket::put(const T* buffer, size_t nItems) {
     return putBytes(reinterpret_cast<const char*>(buffer), nItems * sizeof(T));
 }
 
+template <typename T>
+TcpSocket::InputAwaitable TcpSocket::getAsync(ThreadPool& pool, T* buffer, size_t nItems)
+{
+    char* bytes = reinterpret_cast<char*>(buffer);
+    return InputAwaitable(*this, pool, bytes, nItems * sizeof(T));
+}
+
+template <typename Handle>
+void TcpSocket::InputAwaitable::await_suspend(Handle handle) {
+    // The awaitable lives in the coroutine frame, which might be resumed before
+    // 'whenInputAvailable' returns, so we must not touch any members after this call
+    ThreadPool* pool = &_pool;
+    bool* success = &_success;
+    _socket.whenInputAvailable(_buffer, _nBytes, [pool, success, handle](bool s) mutable {
+        *success = s;
+        internal::scheduleTask(pool, Task([handle]() mutable { handle.resume(); }));
+    });
+}
+
 } // namespace ghoul::io
@@ -30,13 +30,19 @@
 #include <ghoul/misc/exception.h>
 #include <filesystem>
 #include <tuple>
+#include <vector>
 
 struct lua_State;
 
-namespace ghoul { class Dictionary; }
+namespace ghoul {
+    class Dictionary;
+    class ThreadPool;
+} // namespace ghoul
 
 namespace ghoul::lua {
 
+class LuaStatePool;
+
 struct LuaError : public RuntimeError {
     explicit LuaError(std::string msg);
 };
@@ -199,6 +205,32 @@ void loadDictionaryFromFile(const std::string& filename, ghoul::Dictionary& dict
 ghoul::Dictionary loadDictionaryFromFile(const std::string& filename,
     lua_State* state = nullptr);
 
+/**
+ * Loads the Lua scripts pointed to by the \p filenames concurrently by executing them as
+ * tasks in the \p threadPool. Each script is loaded as by #loadDictionaryFromFile using
+ * a state that is checked out of the \p statePool for the duration of the task. This
+ * function blocks until all scripts have been loaded.
+ *
+ * \param filenames The filenames pointing to the scripts that are executed
+ * \param threadPool The ThreadPool in which the scripts are executed
+ * \param statePool The pool from which the Lua states are checked out. If this is
+ *        <code>nullptr</code>, the global pool that is also used by
+ *        #loadDictionaryFromFile is used instead
+ * \return The ghoul::Dictionary%s described by the Lua scripts in the same order as the
+ *         \p filenames
+ *
+ * \throw FormattingException If one of the scripts does not return a valid table
+ * \throw LuaRuntimeException If one of the scripts could not be loaded or executed. If
+ *        multiple scripts fail, the exception of the first one in the order of the
+ *        \p filenames is rethrown after all other scripts have finished
+ * \pre All \p filenames must be paths to existing files
+ * \pre This function must not be called from a task that is executed in the
+ *      \p threadPool
+ */
+std::vector<ghoul::Dictionary> loadDictionariesFromFiles(
+    const std::vector<std::filesystem::path>& filenames, ThreadPool& threadPool,
+    LuaStatePool* statePool = nullptr);
+
 /**
  * Loads a Lua configuration into the given #ghoul::Dictionary%, extending the passed in
  * dictionary. This method will overwrite values with the same keys, but will not remove
@@ -295,7 +327,9 @@ ghoul::Dictionary loadArrayDictionaryFromString(const std::string& script,
  * \p dictionary. This method will overwrite values with the same keys, but will not
  * remove any other keys from the dictionary. The \p state must have a single table object
  * at the top of the stack. The table can only contain a pure array-style table (= only
- * indexed by numbers) or a pure dictionary-style table (= no numbering indices).
+ * indexed by numbers) or a pure dictionary-style table (= no numbering indices). Nested
+ * tables are converted into Dictionaries that allocate their memory from the same memory
+ * resource as the \p dictionary.
  *
  * \param state The Lua state that is used to populate the \p dictionary
  * \param dictionary The #ghoul::Dictionary into which the values from the stack are
@@ -370,14 +404,20 @@ std::string_view luaTypeToString(int type);
  *        the newly created state by means of a \c luaL_openlibs call
  * \param strictState If this is \c true, the created Lua state will panic if an unused
  *        variable is read or being written to before being defined before
+ * \param pooledAllocator If this is \c true, the memory of the created Lua state is
+ *        managed by a LuaAllocator instead of the default allocator of the Lua library.
+ *        The LuaAllocator and its statistics can be retrieved with
+ *        LuaAllocator::fromState and are destroyed by #destroyLuaState
  * \return A valid new Lua state initialized with the default Lua libraries
  *
  * \throw LuaRuntimeException If there was an error creating the new Lua state
  */
-lua_State* createNewLuaState(bool loadStandardLibraries = true, bool strictState = false);
+lua_State* createNewLuaState(bool loadStandardLibraries = true, bool strictState = false,
+    bool pooledAllocator = false);
 
 /**
- * Destroys the passed lua state and frees all memory that is associated with it.
+ * Destroys the passed lua state and frees all memory that is associated with it,
+ * including its LuaAllocator if the state was created with one.
  *
  * \param state The Lua state that is to be deleted
  *
@@ -401,6 +441,28 @@ void destroyLuaState(lua_State* state);
  */
 void runScriptFile(lua_State* state, const std::filesystem::path& filename);
 
+/**
+ * Enables or disables the bytecode cache for Lua scripts that are loaded from files by
+ * loadDictionaryFromFile and runScriptFile. While it is enabled and the FileSystem has a
+ * CacheManager, the compiled bytecode of a script is stored in the cache directory the
+ * first time the script is loaded, and later loads of the same script use the bytecode
+ * instead of lexing and parsing the source again. Each script has a single cached file
+ * that starts with the absolute path, modification time, and size of the script and the
+ * Lua version; if any of them changes, the script is compiled again and the cached file
+ * is overwritten. The bytecode cache is disabled by default. As Lua does not verify
+ * bytecode, the cache directory must be trusted.
+ *
+ * \param enabled Whether the bytecode cache should be used
+ */
+void setBytecodeCacheEnabled(bool enabled);
+
+/**
+ * Returns whether the bytecode cache for Lua scripts is enabled.
+ *
+ * \return Whether the bytecode cache for Lua scripts is enabled
+ */
+bool isBytecodeCacheEnabled();
+
 /**
  * This function executes the Lua script provided as plain text in \p script using the
  * passed <code>lua_State</code> \p state.
@@ -31,6 +31,7 @@
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/misc/invariants.h>
 #include <filesystem>
+#include <map>
 #include <optional>
 #include <type_traits>
 #include <variant>
@@ -0,0 +1,156 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___LUAALLOCATOR___H__
+#define __GHOUL___LUAALLOCATOR___H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct lua_State;
+
+namespace ghoul::lua {
+
+/**
+ * A memory allocator for Lua states that serves small allocations from size-class pools.
+ * Lua allocates a large number of small objects, such as strings, tables, and closures.
+ * Each of these allocations is rounded up to the next multiple of #Granularity and taken
+ * from a free list for that size, which avoids a call into the general purpose allocator
+ * for most allocations. The memory for the pools is requested in chunks of #ChunkSize
+ * bytes that are all released at once when the LuaAllocator is destroyed. Allocations
+ * that are larger than #MaxPooledSize are forwarded to the C runtime.
+ *
+ * In addition, the allocator keeps Statistics about the memory usage of the Lua state
+ * that it belongs to. A LuaAllocator must only be used by a single Lua state and, just
+ * like the state itself, is not thread-safe. States that use a LuaAllocator are created
+ * by passing \c true as the \c pooledAllocator parameter to #createNewLuaState.
+ */
+class LuaAllocator {
+public:
+    /// Statistics about the memory that was requested through a LuaAllocator
+    struct Statistics {
+        /// The number of bytes that are currently allocated
+        size_t liveBytes = 0;
+        /// The largest value that #liveBytes had since the creation of the allocator
+        size_t peakBytes = 0;
+        /// The number of bytes that are reserved for the pools, including the blocks
+        /// that are waiting to be reused
+        size_t pooledBytes = 0;
+        /// The number of new memory blocks that were allocated
+        uint64_t nAllocations = 0;
+        /// The number of memory blocks that were resized
+        uint64_t nReallocations = 0;
+        /// The number of memory blocks that were freed
+        uint64_t nDeallocations = 0;
+        /// The number of allocations and reallocations that were too large for the pools
+        uint64_t nLargeAllocations = 0;
+    };
+
+    /// The size classes of the pools are multiples of this number of bytes
+    static constexpr size_t Granularity = 16;
+    /// The largest allocation in bytes that is served from the pools
+    static constexpr size_t MaxPooledSize = 256;
+    /// The number of bytes that are reserved at a time for the pools
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    LuaAllocator() = default;
+
+    /// Releases all memory that was reserved for the pools
+    ~LuaAllocator();
+
+    LuaAllocator(const LuaAllocator&) = delete;
+    LuaAllocator(LuaAllocator&&) = delete;
+    LuaAllocator& operator=(const LuaAllocator&) = delete;
+    LuaAllocator& operator=(LuaAllocator&&) = delete;
+
+    /**
+     * The allocation function that is passed to \c lua_newstate together with a pointer
+     * to the LuaAllocator as \p userData. It follows the semantics of \c lua_Alloc.
+     *
+     * \param userData The LuaAllocator that serves the request
+     * \param ptr The block that is resized or freed, or \c nullptr for new blocks
+     * \param oldSize The current size of \p ptr. If \p ptr is \c nullptr, this is the
+     *        type of the object that is created instead
+     * \param newSize The requested size of the block or 0 if \p ptr is freed
+     * \return The new block or \c nullptr if \p ptr was freed or if the request could
+     *         not be fulfilled
+     */
+    static void* allocate(void* userData, void* ptr, size_t oldSize,
+        size_t newSize) noexcept;
+
+    /**
+     * Returns the memory statistics of this allocator.
+     *
+     * \return The memory statistics of this allocator
+     */
+    const Statistics& statistics() const;
+
+    /**
+     * Returns the LuaAllocator that is used by the \p state.
+     *
+     * \param state The Lua state whose allocator is returned
+     * \return The allocator of the \p state or \c nullptr if the \p state was created
+     *         with a different allocator
+     *
+     * \pre \p state must not be nullptr
+     */
+    static LuaAllocator* fromState(lua_State* state);
+
+private:
+    /// A block in one of the free lists, which reuses the memory of the block itself
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    /// Returns a block of at least \p size bytes without updating the statistics
+    void* newBlock(size_t size) noexcept;
+
+    /// Returns the block \p ptr of \p size bytes without updating the statistics
+    void deleteBlock(void* ptr, size_t size) noexcept;
+
+    /// Takes a block of \p size bytes from the current chunk, reserving a new chunk if
+    /// the current one is full
+    void* carve(size_t size) noexcept;
+
+    /// Adds \p size bytes to the live bytes and updates the peak
+    void grow(size_t size);
+
+    /// One free list for each size class
+    std::array<FreeBlock*, MaxPooledSize / Granularity> _freeLists = {};
+
+    /// The most recently reserved chunk, which stores a pointer to the previous chunk
+    void* _chunks = nullptr;
+    /// The first byte of the current chunk that has not been handed out yet
+    std::byte* _chunkPosition = nullptr;
+    /// The end of the current chunk
+    std::byte* _chunkEnd = nullptr;
+
+    Statistics _statistics;
+};
+
+} // namespace ghoul::lua
+
+#endif // __GHOUL___LUAALLOCATOR___H__
@@ -0,0 +1,284 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___LUAPROFILER___H__
+#define __GHOUL___LUAPROFILER___H__
+
+#include <ghoul/misc/boolean.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_Debug;
+struct lua_State;
+
+namespace ghoul::lua {
+
+/**
+ * A function-level profiler for a Lua state that is based on the call and return hooks
+ * of the Lua debug interface. While it is running, the profiler gathers for every Lua
+ * and C function that is called from Lua the number of calls, the inclusive and
+ * exclusive wall-clock time, and the number and size of the memory allocations that the
+ * function made. Functions are identified by their definition, so all closures that are
+ * created from the same Lua function share their statistics. The results are available
+ * as a list of FunctionStatistics, as a human-readable #report, or, if the profiler
+ * records a trace, as a JSON file in the Chrome trace event format that can be opened in
+ * <code>chrome://tracing</code> or Perfetto.
+ *
+ * The profiler installs the hook and wraps the allocation function of the state only
+ * while it is running, so a state that is not profiled does not pay for it. If Tracy is
+ * enabled, each function call in the main thread of the state also becomes a Tracy zone.
+ * Calls inside of coroutines are not reported to Tracy, as they do not nest with the
+ * zones of the thread that resumes them.
+ *
+ * Only the main thread of the state and coroutines that are created while the profiler
+ * is running are profiled. The time during which a coroutine is suspended is not
+ * attributed to its active calls, and the calls of a coroutine that fails with an error
+ * are finished at that point. Profiled coroutines are kept alive until the profiler is
+ * stopped. While the profiler is running, LuaAllocator::fromState does not find the
+ * LuaAllocator of the state. The LuaProfiler is not thread-safe and there
+ * can only be one running LuaProfiler per Lua state.
+ */
+class LuaProfiler {
+public:
+    BooleanType(RecordTrace);
+
+    /// The profiling results for a single Lua or C function
+    struct FunctionStatistics {
+        /// The name of the function followed by its source and line, for example
+        /// <code>update (script.lua:12)</code>
+        std::string name;
+        /// The number of times the function was called
+        uint64_t nCalls = 0;
+        /// The time spent in the function including the functions that it called.
+        /// Recursive calls are only counted once
+        std::chrono::nanoseconds inclusiveTime = std::chrono::nanoseconds(0);
+        /// The time spent in the function excluding the functions that it called
+        std::chrono::nanoseconds exclusiveTime = std::chrono::nanoseconds(0);
+        /// The number of memory allocations made by the function itself
+        uint64_t nAllocations = 0;
+        /// The number of bytes allocated by the function itself
+        uint64_t allocatedBytes = 0;
+    };
+
+    /**
+     * Creates a profiler for the \p state that is not running yet.
+     *
+     * \param state The Lua state that is profiled
+     * \param recordTrace If this is \c true, every function call is recorded in addition
+     *        to the aggregated statistics so that the calls can be exported with
+     *        #chromeTrace. The memory usage of the trace grows with each call
+     *
+     * \pre \p state must not be nullptr
+     */
+    explicit LuaProfiler(lua_State* state, RecordTrace recordTrace = RecordTrace::No);
+
+    /// Stops the profiler if it is running. The profiled state must still be valid
+    ~LuaProfiler();
+
+    LuaProfiler(const LuaProfiler&) = delete;
+    LuaProfiler(LuaProfiler&&) = delete;
+    LuaProfiler& operator=(const LuaProfiler&) = delete;
+    LuaProfiler& operator=(LuaProfiler&&) = delete;
+
+    /**
+     * Starts profiling the Lua state. The results are added to the results of previous
+     * runs unless #reset is called in between.
+     *
+     * \pre The profiler must not be running
+     * \pre No other LuaProfiler must be running for the same Lua state
+     */
+    void start();
+
+    /**
+     * Stops profiling the Lua state. All function calls that are still active are
+     * treated as if they returned now. Coroutines that were created while the profiler
+     * was running lose their hook the next time they are resumed.
+     *
+     * \pre The profiler must be running
+     */
+    void stop();
+
+    /**
+     * Returns whether the profiler is currently running.
+     *
+     * \return \c true if the profiler is currently running
+     */
+    bool isRunning() const;
+
+    /**
+     * Removes all results that have been gathered so far.
+     *
+     * \pre The profiler must not be running
+     */
+    void reset();
+
+    /**
+     * Returns the results for all functions that have been called while the profiler
+     * was running, sorted by their exclusive time with the most expensive first.
+     *
+     * \return The results for all functions that have been called
+     */
+    std::vector<FunctionStatistics> statistics() const;
+
+    /**
+     * Returns a table that contains the results of #statistics in a human-readable
+     * form, with one line per function.
+     *
+     * \param nFunctions The maximum number of functions that are listed. If this is 0,
+     *        all functions are listed
+     * \return The table with the results
+     */
+    std::string report(size_t nFunctions = 0) const;
+
+    /**
+     * Returns the recorded function calls as a JSON document in the Chrome trace event
+     * format. Each Lua thread is shown as a separate thread in the trace.
+     *
+     * \return The JSON document containing the recorded trace
+     *
+     * \pre The profiler must have been created with RecordTrace::Yes
+     */
+    std::string chromeTrace() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    /// The signature of the \c lua_Alloc allocation functions
+    using AllocateFunction = void* (*)(void*, void*, size_t, size_t);
+    /// The signature of the \c lua_Hook hook functions
+    using HookFunction = void (*)(lua_State*, lua_Debug*);
+
+    /// Identifies a function by its source and the line of its definition for Lua
+    /// functions and by its address for C functions
+    struct FunctionKey {
+        const void* id;
+        int line;
+
+        bool operator==(const FunctionKey& other) const;
+    };
+
+    struct FunctionKeyHash {
+        size_t operator()(const FunctionKey& key) const;
+    };
+
+    struct Function {
+        FunctionStatistics statistics;
+        /// The number of calls of this function that are currently active
+        int nActive = 0;
+    };
+
+    /// A function call that has not returned yet
+    struct Frame {
+        size_t function;
+        Clock::time_point start;
+        Clock::duration childTime = Clock::duration(0);
+        uint64_t nAllocationsStart;
+        uint64_t allocatedBytesStart;
+        uint64_t childAllocations = 0;
+        uint64_t childAllocatedBytes = 0;
+#ifdef TRACY_ENABLE
+        /// The Tracy zone of this call, if it was started
+        bool hasZone = false;
+        uint32_t zoneId = 0;
+        int zoneActive = 0;
+#endif // TRACY_ENABLE
+    };
+
+    /// The active function calls of a Lua thread
+    struct Thread {
+        int id;
+        std::vector<Frame> frames;
+        /// Whether the thread is a coroutine that yielded and the time when it did
+        bool isSuspended = false;
+        Clock::time_point suspendedAt;
+    };
+
+    /// A recorded function call for the Chrome trace
+    struct TraceEvent {
+        size_t function;
+        int thread;
+        Clock::duration start;
+        Clock::duration duration;
+    };
+
+    /// The hook that is registered with the Lua state
+    static void hook(lua_State* state, lua_Debug* ar);
+
+    /// The allocation function that counts allocations before forwarding them
+    static void* allocate(void* userData, void* ptr, size_t oldSize,
+        size_t newSize) noexcept;
+
+    /// Handles a single call or return event of the Lua \p thread described by \p ar
+    void handleEvent(lua_State* thread, lua_Debug* ar, Clock::time_point now);
+
+    /// Returns the key of the function described by \p ar
+    static FunctionKey functionKey(lua_State* thread, lua_Debug* ar);
+
+    /// Returns the index of the function with the \p key, adding it if necessary
+    size_t functionIndex(lua_State* thread, lua_Debug* ar, const FunctionKey& key);
+
+    /// Returns the active function calls of the \p thread
+    Thread& threadData(lua_State* thread);
+
+    /// Handles the switch from the previously running thread to the \p thread at the
+    /// time \p now. The previous thread is suspended if it yielded and forgotten if it
+    /// finished, and the \p thread continues if it was suspended
+    void switchThread(lua_State* thread, Clock::time_point now);
+
+    /// Finishes the most recent call of the \p thread at the time \p now
+    void popFrame(Thread& thread, Clock::time_point now);
+
+    lua_State* _state;
+    const bool _recordTrace;
+    bool _isRunning = false;
+
+    /// The allocation function and hook that were used before the profiler started
+    AllocateFunction _previousAllocate = nullptr;
+    void* _previousAllocateData = nullptr;
+    HookFunction _previousHook = nullptr;
+    int _previousHookMask = 0;
+    int _previousHookCount = 0;
+
+    /// The number of allocations and allocated bytes since the profiler was created
+    uint64_t _nAllocations = 0;
+    uint64_t _allocatedBytes = 0;
+
+    std::unordered_map<FunctionKey, size_t, FunctionKeyHash> _functionIndices;
+    std::vector<Function> _functions;
+    std::unordered_map<lua_State*, Thread> _threads;
+    /// The thread that caused the most recent event
+    lua_State* _currentThread = nullptr;
+    /// The number of threads that have been profiled, which is used for their ids
+    int _nThreads = 0;
+    std::vector<TraceEvent> _trace;
+    Clock::time_point _epoch;
+};
+
+} // namespace ghoul::lua
+
+#endif // __GHOUL___LUAPROFILER___H__
@@ -41,6 +41,7 @@ class LuaState {
 public:
     BooleanType(IncludeStandardLibrary);
     BooleanType(StrictState);
+    BooleanType(PooledAllocator);
 
     /**
      * The constructor will create a new Lua state and optionally fill it with the Lua
@@ -50,11 +51,14 @@ public:
      *        set of Lua standard libraries
      * \param strict If this is \c true, the created Lua state will panic if an unused
      *        variable is read or being written to before being defined before
+     * \param allocator If this is \c true, the memory of the created Lua state is
+     *        managed by a LuaAllocator, which also provides memory statistics
      *
      * \throw LuaRuntimeException If an error occurs during the state creation
      */
     explicit LuaState(IncludeStandardLibrary include = IncludeStandardLibrary::Yes,
-        StrictState strict = StrictState::Yes);
+        StrictState strict = StrictState::Yes,
+        PooledAllocator allocator = PooledAllocator::No);
 
     /// Destroys the created Lua state and frees all the related memory.
     ~LuaState();
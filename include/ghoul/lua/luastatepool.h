@@ -0,0 +1,141 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___LUASTATEPOOL___H__
+#define __GHOUL___LUASTATEPOOL___H__
+
+#include <ghoul/lua/luastate.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ghoul::lua {
+
+/**
+ * A thread-safe pool of LuaState objects that can be checked out for exclusive use by
+ * one thread at a time. Creating a Lua state and loading the standard libraries is
+ * expensive, so reusing the states of the pool allows multiple threads to execute Lua
+ * scripts concurrently without paying for a new state each time. A state is checked out
+ * by calling #checkout and automatically returned to the pool when the returned Handle is
+ * destroyed. If no idle state is available, a new one is created, so checking out a
+ * state never blocks on other threads.
+ *
+ * As states are reused, global variables that a script defines remain visible to
+ * scripts that are later executed in the same state. The stack of a state is cleared
+ * when it is returned to the pool.
+ */
+class LuaStatePool {
+public:
+    /**
+     * A LuaState that is checked out of a LuaStatePool. The state is returned to the pool
+     * when the Handle is destroyed or assigned to. The LuaStatePool has to outlive all of
+     * its Handles.
+     */
+    class Handle {
+    public:
+        /// Creates a Handle that does not refer to any state
+        Handle() = default;
+        Handle(Handle&& other) noexcept = default;
+        Handle& operator=(Handle&& other) noexcept;
+        ~Handle();
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        /**
+         * Converts this Handle into the \c lua_State pointer of the checked out state.
+         *
+         * \return The contained \c lua_State pointer or \c nullptr if this Handle does
+         *         not refer to a state
+         */
+        operator lua_State*() const;
+
+    private:
+        friend class LuaStatePool;
+
+        Handle(LuaStatePool* pool, std::unique_ptr<LuaState> state);
+
+        /// Returns the state to the pool, if this Handle refers to one
+        void release();
+
+        LuaStatePool* _pool = nullptr;
+        std::unique_ptr<LuaState> _state;
+    };
+
+    /**
+     * Creates a pool that contains \p nStates pre-initialized states. All states that
+     * are created by this pool use the same \p include and \p strict settings.
+     *
+     * \param nStates The number of states that are created immediately
+     * \param include Whether the states contain the set of Lua standard libraries
+     * \param strict Whether the states panic if an undeclared variable is used
+     *
+     * \throw LuaRuntimeException If an error occurs during the state creation
+     * \pre \p nStates must not be negative
+     */
+    explicit LuaStatePool(int nStates = 0,
+        LuaState::IncludeStandardLibrary include = LuaState::IncludeStandardLibrary::Yes,
+        LuaState::StrictState strict = LuaState::StrictState::Yes);
+
+    /**
+     * Checks out a state from this pool that can be used exclusively until the returned
+     * Handle is destroyed. If no idle state is available, a new state is created.
+     *
+     * \return The Handle to the checked out state
+     *
+     * \throw LuaRuntimeException If a new state had to be created and an error occurred
+     */
+    Handle checkout();
+
+    /**
+     * Returns the number of states that are currently idle in this pool.
+     *
+     * \return The number of states that are currently idle in this pool
+     */
+    int nIdleStates() const;
+
+    /**
+     * Destroys all states that are currently idle in this pool. States that are checked
+     * out are not affected and are returned to the pool as usual.
+     */
+    void clear();
+
+private:
+    /// Returns the \p state to the list of idle states
+    void giveBack(std::unique_ptr<LuaState> state);
+
+    const LuaState::IncludeStandardLibrary _include;
+    const LuaState::StrictState _strict;
+
+    /// Protects the list of idle states
+    mutable std::mutex _mutex;
+
+    /// The states that are not checked out
+    std::vector<std::unique_ptr<LuaState>> _idleStates;
+};
+
+} // namespace ghoul::lua
+
+#endif // __GHOUL___LUASTATEPOOL___H__
@@ -143,6 +143,14 @@ public:
      */
     size_type size() const;
 
+    /**
+     * Returns the number of bytes that have been serialized but not yet deserialized,
+     * which is the maximum number of bytes that the next deserialize calls can read.
+     *
+     * \return The number of bytes that have not been deserialized yet
+     */
+    size_type remainingSize() const;
+
     /**
      * Writes the current Buffer to a file. This file will be bigger than the current
      * Buffer size because it also writes metadata to the file.
@@ -0,0 +1,217 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __GHOUL___COROUTINETASK___H__
+#define __GHOUL___COROUTINETASK___H__
+
+// Coroutines require C++20, which the users of Ghoul might compile with even though Ghoul
+// itself only requires C++17. For older language versions, this file is empty and
+// GHOUL_HAS_COROUTINES is not defined
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#define GHOUL_HAS_COROUTINES
+
+#include <ghoul/misc/task.h>
+#include <ghoul/misc/threadpool.h>
+#include <coroutine>
+#include <exception>
+#include <optional>
+
+namespace ghoul {
+
+template <typename T> class CoroutineTask;
+
+namespace internal {
+
+/**
+ * The part of the promise type of a CoroutineTask that does not depend on the type of
+ * the result. The coroutine is started lazily when it is awaited and, when it finishes,
+ * the coroutine that awaited it is resumed on the same thread.
+ */
+class CoroutinePromiseBase {
+public:
+    /// The awaiter of the final suspension point that resumes the awaiting coroutine
+    struct FinalAwaiter {
+        bool await_ready() const noexcept;
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<Promise> handle) noexcept;
+
+        void await_resume() const noexcept;
+    };
+
+    std::suspend_always initial_suspend() const noexcept;
+    FinalAwaiter final_suspend() const noexcept;
+    void unhandled_exception() noexcept;
+
+    /// Sets the coroutine that is resumed when this coroutine has finished
+    void setContinuation(std::coroutine_handle<> continuation);
+
+protected:
+    std::coroutine_handle<> _continuation;
+    std::exception_ptr _exception;
+};
+
+template <typename T>
+class CoroutinePromise : public CoroutinePromiseBase {
+public:
+    CoroutineTask<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value);
+
+    /// Returns the value or rethrows the exception of the finished coroutine
+    T result();
+
+private:
+    std::optional<T> _value;
+};
+
+template <>
+class CoroutinePromise<void> : public CoroutinePromiseBase {
+public:
+    CoroutineTask<void> get_return_object() noexcept;
+
+    void return_void() noexcept;
+
+    /// Rethrows the exception of the finished coroutine, if there was any
+    void result();
+};
+
+/// A coroutine that starts immediately and destroys itself when it has finished
+struct DetachedCoroutine {
+    struct promise_type {
+        DetachedCoroutine get_return_object() noexcept;
+        std::suspend_never initial_suspend() const noexcept;
+        std::suspend_never final_suspend() const noexcept;
+        void return_void() noexcept;
+        void unhandled_exception() noexcept;
+    };
+};
+
+} // namespace internal
+
+/**
+ * The return type of coroutines that produce a value of type \p T (or nothing, for
+ * <code>void</code>) asynchronously. A CoroutineTask starts lazily when it is awaited
+ * with <code>co_await</code> from another coroutine, which is suspended until the result
+ * is available, and the result or exception of the CoroutineTask is the result of the
+ * <code>co_await</code> expression. By awaiting ThreadPool::schedule, a coroutine moves
+ * itself onto one of the ThreadPool's Worker%s, and all coroutines that are awaiting it
+ * continue on that Worker when it has finished, so no thread is ever blocked waiting for
+ * the result. Example:
+ * \verbatim
+ghoul::CoroutineTask<std::string> readFile(ghoul::ThreadPool& pool, std::string path) {
+    co_await pool.schedule();
+    co_return loadFromDisk(path);
+}
+
+ghoul::CoroutineTask<Image> loadImage(ghoul::ThreadPool& pool, std::string path) {
+    std::string content = co_await readFile(pool, path);
+    co_return decode(content);
+}
+
+ghoul::TaskFuture<Image> image = ghoul::spawn(pool, loadImage(pool, "image.png"));
+\endverbatim
+ *
+ * A CoroutineTask owns its coroutine and can only be awaited once. It is only available
+ * if Ghoul's users are compiling with C++20, in which case GHOUL_HAS_COROUTINES is
+ * defined.
+ *
+ * \tparam T The type of the result of the coroutine
+ */
+template <typename T = void>
+class CoroutineTask {
+public:
+    using promise_type = internal::CoroutinePromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    /// The awaiter that starts the coroutine and suspends the awaiting coroutine
+    struct Awaiter {
+        bool await_ready() const noexcept;
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept;
+        T await_resume();
+
+        Handle handle;
+    };
+
+    /// Creates an invalid CoroutineTask that is not associated with any coroutine
+    CoroutineTask() = default;
+    CoroutineTask(CoroutineTask&& other) noexcept;
+    CoroutineTask& operator=(CoroutineTask&& other) noexcept;
+    ~CoroutineTask();
+
+    /**
+     * Returns whether this CoroutineTask is associated with a coroutine.
+     *
+     * \return Whether this CoroutineTask is associated with a coroutine
+     */
+    bool isValid() const;
+
+    /**
+     * Returns whether the coroutine has finished.
+     *
+     * \return Whether the coroutine has finished
+     * \pre The CoroutineTask must be valid
+     */
+    bool isReady() const;
+
+    Awaiter operator co_await() & noexcept;
+    Awaiter operator co_await() && noexcept;
+
+private:
+    friend class internal::CoroutinePromise<T>;
+    explicit CoroutineTask(Handle handle);
+
+    CoroutineTask(const CoroutineTask&) = delete;
+    CoroutineTask& operator=(const CoroutineTask&) = delete;
+
+    Handle _handle;
+};
+
+/**
+ * Starts the \p task on one of the Worker%s of the \p pool and returns a TaskFuture for
+ * its result. This connects coroutines to code that is not a coroutine itself, which
+ * can wait for the result with TaskFuture::get or attach continuations with
+ * TaskFuture::then. If the resumption of the coroutine is discarded, for example by
+ * ThreadPool::clearRemainingTasks, the coroutine is never finished.
+ *
+ * \param pool The ThreadPool on which the \p task is started
+ * \param task The coroutine that is started
+ * \return The TaskFuture that receives the result or the exception of the \p task
+ * \pre \p task must be valid
+ */
+template <typename T>
+TaskFuture<T> spawn(ThreadPool& pool, CoroutineTask<T> task);
+
+} // namespace ghoul
+
+#include "coroutinetask.inl"
+
+#endif // __cpp_impl_coroutine
+
+#endif // __GHOUL___COROUTINETASK___H__
@@ -0,0 +1,227 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <ghoul/misc/assert.h>
+#include <type_traits>
+#include <utility>
+
+namespace ghoul {
+
+namespace internal {
+
+inline bool CoroutinePromiseBase::FinalAwaiter::await_ready() const noexcept {
+    return false;
+}
+
+template <typename Promise>
+std::coroutine_handle<> CoroutinePromiseBase::FinalAwaiter::await_suspend(
+                                           std::coroutine_handle<Promise> handle) noexcept
+{
+    // Symmetric transfer to the awaiting coroutine, which prevents the stack from
+    // growing with long chains of coroutines
+    std::coroutine_handle<> continuation = handle.promise()._continuation;
+    return continuation ? continuation : std::noop_coroutine();
+}
+
+inline void CoroutinePromiseBase::FinalAwaiter::await_resume() const noexcept {}
+
+inline std::suspend_always CoroutinePromiseBase::initial_suspend() const noexcept {
+    return {};
+}
+
+inline CoroutinePromiseBase::FinalAwaiter
+CoroutinePromiseBase::final_suspend() const noexcept
+{
+    return {};
+}
+
+inline void CoroutinePromiseBase::unhandled_exception() noexcept {
+    _exception = std::current_exception();
+}
+
+inline void CoroutinePromiseBase::setContinuation(std::coroutine_handle<> continuation) {
+    _continuation = continuation;
+}
+
+template <typename T>
+CoroutineTask<T> CoroutinePromise<T>::get_return_object() noexcept {
+    return CoroutineTask<T>(
+        std::coroutine_handle<CoroutinePromise<T>>::from_promise(*this)
+    );
+}
+
+template <typename T>
+template <typename U>
+void CoroutinePromise<T>::return_value(U&& value) {
+    _value.emplace(std::forward<U>(value));
+}
+
+template <typename T>
+T CoroutinePromise<T>::result() {
+    if (_exception) {
+        std::rethrow_exception(_exception);
+    }
+    ghoul_assert(_value.has_value(), "Coroutine has not returned a value");
+    return std::move(*_value);
+}
+
+inline CoroutineTask<void> CoroutinePromise<void>::get_return_object() noexcept {
+    return CoroutineTask<void>(
+        std::coroutine_handle<CoroutinePromise<void>>::from_promise(*this)
+    );
+}
+
+inline void CoroutinePromise<void>::return_void() noexcept {}
+
+inline void CoroutinePromise<void>::result() {
+    if (_exception) {
+        std::rethrow_exception(_exception);
+    }
+}
+
+inline DetachedCoroutine DetachedCoroutine::promise_type::get_return_object() noexcept {
+    return {};
+}
+
+inline std::suspend_never
+DetachedCoroutine::promise_type::initial_suspend() const noexcept
+{
+    return {};
+}
+
+inline std::suspend_never DetachedCoroutine::promise_type::final_suspend() const noexcept
+{
+    return {};
+}
+
+inline void DetachedCoroutine::promise_type::return_void() noexcept {}
+
+inline void DetachedCoroutine::promise_type::unhandled_exception() noexcept {
+    // All exceptions are passed to the TaskPromise in 'runDetached'
+    std::terminate();
+}
+
+template <typename T>
+DetachedCoroutine runDetached(ThreadPool& pool, CoroutineTask<T> task,
+                              TaskPromise<T> promise)
+{
+    co_await pool.schedule();
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            promise.setValue();
+        }
+        else {
+            promise.setValue(co_await std::move(task));
+        }
+    }
+    catch (...) {
+        promise.setException(std::current_exception());
+    }
+}
+
+} // namespace internal
+
+template <typename T>
+bool CoroutineTask<T>::Awaiter::await_ready() const noexcept {
+    return !handle || handle.done();
+}
+
+template <typename T>
+std::coroutine_handle<> CoroutineTask<T>::Awaiter::await_suspend(
+                                               std::coroutine_handle<> awaiting) noexcept
+{
+    // Start our coroutine, which resumes the awaiting coroutine when it has finished
+    handle.promise().setContinuation(awaiting);
+    return handle;
+}
+
+template <typename T>
+T CoroutineTask<T>::Awaiter::await_resume() {
+    ghoul_assert(handle, "CoroutineTask must be valid");
+    return handle.promise().result();
+}
+
+template <typename T>
+CoroutineTask<T>::CoroutineTask(Handle handle)
+    : _handle(handle)
+{}
+
+template <typename T>
+CoroutineTask<T>::CoroutineTask(CoroutineTask&& other) noexcept
+    : _handle(std::exchange(other._handle, nullptr))
+{}
+
+template <typename T>
+CoroutineTask<T>& CoroutineTask<T>::operator=(CoroutineTask&& other) noexcept {
+    if (this != &other) {
+        if (_handle) {
+            _handle.destroy();
+        }
+        _handle = std::exchange(other._handle, nullptr);
+    }
+    return *this;
+}
+
+template <typename T>
+CoroutineTask<T>::~CoroutineTask() {
+    if (_handle) {
+        _handle.destroy();
+    }
+}
+
+template <typename T>
+bool CoroutineTask<T>::isValid() const {
+    return static_cast<bool>(_handle);
+}
+
+template <typename T>
+bool CoroutineTask<T>::isReady() const {
+    ghoul_assert(_handle, "CoroutineTask must be valid");
+    return _handle.done();
+}
+
+template <typename T>
+typename CoroutineTask<T>::Awaiter CoroutineTask<T>::operator co_await() & noexcept {
+    return Awaiter{ _handle };
+}
+
+template <typename T>
+typename CoroutineTask<T>::Awaiter CoroutineTask<T>::operator co_await() && noexcept {
+    return Awaiter{ _handle };
+}
+
+template <typename T>
+TaskFuture<T> spawn(ThreadPool& pool, CoroutineTask<T> task) {
+    ghoul_assert(task.isValid(), "task must be valid");
+
+    TaskPromise<T> promise;
+    TaskFuture<T> future = promise.future();
+    internal::runDetached(pool, std::move(task), std::move(promise));
+    return future;
+}
+
+} // namespace ghoul
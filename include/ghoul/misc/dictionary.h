@@ -27,11 +27,16 @@
 #define __GHOUL___DICTIONARY___H__
 
 #include <ghoul/glm.h>
+#include <ghoul/misc/crc32.h>
 #include <ghoul/misc/exception.h>
-#include <map>
+#include <ghoul/misc/memorypool.h>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -44,13 +49,22 @@ namespace internal {
     struct is_one_of<T, std::variant<Ts...>> :
         std::bool_constant<(std::is_same_v<T, Ts> || ...)>
     {};
+
+    // String and vector types that allocate their memory from a memory resource
+    using PmrString =
+        std::basic_string<char, std::char_traits<char>, pmr::polymorphic_allocator<char>>;
+    template <typename T>
+    using PmrVector = std::vector<T, pmr::polymorphic_allocator<T>>;
+
+    class DictionaryBinaryWriter;
 } // namespace internal
 
 /**
  * The Dictionary is a class that represents a mapping from a string to a fixed selection
  * of types. It has the ability to store and retrieve these items by unique string keys.
- * The only automatic conversion that is currently performed is to convert glm vector or
- * matrix types into std::vector types and reconstructing them on access such that:
+ * glm vector and matrix types are stored without any conversion, but they are
+ * interchangeable with std::vector types of the same value type and number of components
+ * such that:
  * <code>
  * Dictionary d;
  * d.setValue("a", glm::dvec4(1.0, 2.0, 3.0, 4.0);
@@ -63,7 +77,18 @@ namespace internal {
  * glm::dvec4 vv = e.value<glm::dvec4>("a");
  * // vv.x == 5.0 && vv.y == 6.0 && vv.z == 7.0 && vv.w == 8.0
  * </code>
- * are legal
+ * are legal.
+ *
+ * Copying a Dictionary is a constant time operation, as the copies share their values
+ * until one of them is modified, at which point the modified Dictionary receives its own
+ * copy of the values. Nested Dictionaries are shared in the same way, so modifying the
+ * copy only duplicates the top level of the tree.
+ *
+ * All memory of a Dictionary, including its keys, strings, vectors, and nested
+ * Dictionaries, is allocated from a single memory resource, which is the default memory
+ * resource unless a different one is passed to the constructor. This makes it possible
+ * to, for example, place a whole tree into an arena and release it at once. Values that
+ * are added to a Dictionary are copied into its memory resource.
  */
 class Dictionary {
 public:
@@ -78,6 +103,71 @@ public:
     /// Returns true if T is one of the allowed storage types
     template <typename T> using IsAllowedType = internal::is_one_of<T, Types>;
 
+    /// The types in which the values are stored. They correspond to the Types, except
+    /// that strings and vectors allocate their memory from the Dictionary's memory
+    /// resource
+    using StorageTypes = std::variant<
+        bool, int, double, internal::PmrString, Dictionary, internal::PmrVector<int>,
+        internal::PmrVector<double>, internal::PmrVector<internal::PmrString>,
+        glm::ivec2, glm::ivec3, glm::ivec4, glm::dvec2, glm::dvec3, glm::dvec4,
+        glm::dmat2x2, glm::dmat2x3, glm::dmat2x4, glm::dmat3x2, glm::dmat3x3,
+        glm::dmat3x4, glm::dmat4x2, glm::dmat4x3, glm::dmat4x4
+    >;
+
+    /// A single change of a Patch, which is defined after the Dictionary
+    struct Change;
+
+    /**
+     * A list of changes that turns one Dictionary into another. It is created by #diff
+     * and applied by #apply. The changes are sorted by their key and each key occurs at
+     * most once.
+     */
+    using Patch = std::vector<Change>;
+
+    /**
+     * A precomputed key that can be used in place of a string key. The key is split into
+     * its dot-separated segments and each segment is hashed on construction, which
+     * happens at compile time if the Key is declared \c constexpr. Lookups with a Key do
+     * not need to parse or hash the string again:
+     * <code>
+     * constexpr Dictionary::Key RadiusKey("Renderable.Radius");
+     * double r = dictionary.value<double>(RadiusKey);
+     * </code>
+     * The Key only references the string it was created from, which therefore has to
+     * outlive the Key.
+     */
+    class Key {
+    public:
+        /// The maximum number of dot-separated segments that a Key can consist of
+        static constexpr int MaxSegments = 8;
+
+        /**
+         * Creates a Key from the provided \p key by splitting it at each '.' and hashing
+         * each of the segments.
+         *
+         * \param key The key that is represented by this Key object
+         *
+         * \throw KeyError If \p key consists of more than MaxSegments segments
+         * \pre \p key must not be the empty string
+         */
+        explicit constexpr Key(std::string_view key);
+
+        /// Returns the full string that this Key was created from
+        constexpr std::string_view string() const;
+
+    private:
+        friend class Dictionary;
+
+        struct Segment {
+            std::string_view name;
+            unsigned int hash = 0;
+        };
+
+        std::string_view _key;
+        std::array<Segment, MaxSegments> _segments = {};
+        int _nSegments = 0;
+    };
+
 
     /// Exception that is thrown if the Dictionary does not contain a provided key
     struct KeyError : public ghoul::RuntimeError {
@@ -91,6 +181,31 @@ public:
         explicit ValueError(std::string key, std::string msg);
     };
 
+    /**
+     * Creates an empty Dictionary that allocates its memory from the default memory
+     * resource at the time the first value is added.
+     */
+    Dictionary() = default;
+
+    /**
+     * Creates an empty Dictionary that allocates all of its memory, including the memory
+     * of all nested Dictionaries, strings, and vectors, from the provided \p resource.
+     *
+     * \param resource The memory resource from which all memory is allocated. It has to
+     *        outlive the Dictionary, all of its copies, and all values retrieved from it
+     *        as a Dictionary
+     *
+     * \pre \p resource must not be nullptr
+     */
+    explicit Dictionary(pmr::memory_resource* resource);
+
+    /**
+     * Returns the memory resource from which this Dictionary allocates its memory.
+     *
+     * \return The memory resource from which this Dictionary allocates its memory
+     */
+    pmr::memory_resource* memoryResource() const;
+
     bool operator==(const Dictionary& rhs) const noexcept;
     bool operator!=(const Dictionary& rhs) const noexcept;
 
@@ -106,11 +221,11 @@ public:
      * \pre \p key must not be the empty string
      */
     template <typename T, std::enable_if_t<IsAllowedType<T>{}, int> = 0>
-    void setValue(std::string key, T value);
+    void setValue(std::string_view key, T value);
 
     // Just a helper function to make the error message a bit more palatable
     template <typename T, std::enable_if_t<!IsAllowedType<T>{}, int> = 0>
-    void setValue(std::string key, T value);
+    void setValue(std::string_view key, T value);
 
     /**
      * Retrieves the value stored at the provided \p key. The template parameter has to be
@@ -129,6 +244,19 @@ public:
     template <typename T, std::enable_if_t<IsAllowedType<T>{}, int> = 0>
     T value(std::string_view key) const;
 
+    /**
+     * Retrieves the value stored at the precomputed \p key. This function behaves the
+     * same as the overload taking a string, but does not need to parse or hash the key.
+     *
+     * \param key The key for which to retrieve the value
+     * \return The value in the Dictionary stored at the \p key
+     *
+     * \throws KeyError If the provided \p key does not exist
+     * \throws ValueError If the value stored at \p key is not of type T
+     */
+    template <typename T, std::enable_if_t<IsAllowedType<T>{}, int> = 0>
+    T value(const Key& key) const;
+
     // Just a helper function to make the error message a bit more palatable
     template <typename T, std::enable_if_t<!IsAllowedType<T>{}, int> = 0>
     T value(std::string_view key) const;
@@ -147,6 +275,18 @@ public:
     template <typename T, std::enable_if_t<IsAllowedType<T>{}, int> = 0>
     bool hasValue(std::string_view key) const;
 
+    /**
+     * Checks whether the Dictionary stores a value of type T at the precomputed \p key.
+     * This function behaves the same as the overload taking a string, but does not need
+     * to parse or hash the key.
+     *
+     * \param key The key for which to check the existence and type
+     * \return \c true if the Dictionary contains such a key and it is of the requested
+     *         type T
+     */
+    template <typename T, std::enable_if_t<IsAllowedType<T>{}, int> = 0>
+    bool hasValue(const Key& key) const;
+
     // Just a helper function to make the error message a bit more palatable
     template <typename T, std::enable_if_t<!IsAllowedType<T>{}, int> = 0>
     bool hasValue(std::string_view key) const;
@@ -163,12 +303,60 @@ public:
      */
     bool hasKey(std::string_view key) const;
 
+    /**
+     * Checks whether the Dictionary stores any value under the precomputed \p key,
+     * regardless of its type.
+     *
+     * \param key The key for which to check the existence
+     * \return \c true if the Dictionary contains such a key
+     */
+    bool hasKey(const Key& key) const;
+
+    /**
+     * Returns a pointer to the Dictionary that is stored at the provided \p key. Dotted
+     * keys are resolved by following the nested Dictionaries in place, so neither the
+     * result nor any of the Dictionaries along the path are copied. The returned pointer
+     * remains valid until this Dictionary, or any Dictionary along the path, is modified
+     * or destroyed.
+     *
+     * \param key The key of the Dictionary that should be returned
+     * \return A pointer to the Dictionary stored at \p key or \c nullptr if the key does
+     *         not exist or does not contain a Dictionary
+     *
+     * \pre \p key must not be the empty string
+     */
+    const Dictionary* subDictionary(std::string_view key) const;
+
+    /**
+     * Returns a pointer to the Dictionary that is stored at the precomputed \p key. See
+     * the overload taking a string for details.
+     *
+     * \param key The key of the Dictionary that should be returned
+     * \return A pointer to the Dictionary stored at \p key or \c nullptr if the key does
+     *         not exist or does not contain a Dictionary
+     */
+    const Dictionary* subDictionary(const Key& key) const;
+
     /**
      * Returns a list of all keys stored in the Dictionary.
      * \return A list of all keys stored in the Dictionary
      */
     std::vector<std::string_view> keys() const;
 
+    /**
+     * Calls the \p visitor for every key-value pair stored in this Dictionary in the same
+     * order in which they are returned by #keys. The values are passed as they are
+     * stored, without copying or converting them, which makes this the most efficient
+     * way to access all values of a Dictionary. Nested Dictionaries are passed as a
+     * single value and are not visited recursively. The Dictionary must not be modified
+     * while it is being visited.
+     *
+     * \param visitor The callable that is invoked as
+     *        <code>visitor(std::string_view key, const StorageTypes& value)</code>
+     */
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const;
+
     /**
      * Removes the provided \p key from the dictionary.  If the key does not exist, this
      * operation does not do anything.
@@ -199,17 +387,147 @@ public:
      */
     bool isSubset(const ghoul::Dictionary& dict) const;
 
+    /**
+     * Returns a hash of the structure and values of this Dictionary. Dictionaries that
+     * compare equal have the same hash, regardless of the order in which their values
+     * were added. The hash is computed on the first call and cached with the values, so
+     * that subsequent calls, also on copies of this Dictionary or on Dictionaries that
+     * contain it, do not have to visit the values again. Modifying the Dictionary
+     * invalidates its cached hash.
+     *
+     * \return A hash of the structure and values of this Dictionary
+     */
+    uint64_t hash() const;
+
+    /**
+     * Computes the changes that turn the Dictionary \p from into the Dictionary \p to.
+     * Nested Dictionaries that exist in both are compared recursively and result in a
+     * single change that contains the changes for the nested Dictionary. Nested
+     * Dictionaries that share their values are skipped without visiting them, and only
+     * nested Dictionaries whose #hash differs are searched for changes, which makes the
+     * comparison of large trees with few changes cheap, in particular if the hashes of
+     * \p from are already cached from a previous comparison. Nested Dictionaries with
+     * identical hashes are compared by value before they are skipped, so a collision of
+     * the hashes cannot hide a change.
+     *
+     * \param from The Dictionary that is the starting point of the changes
+     * \param to The Dictionary that is the result of applying the changes to \p from
+     * \return The changes that turn \p from into \p to, which is empty if the
+     *         Dictionaries are equal
+     */
+    static Patch diff(const Dictionary& from, const Dictionary& to);
+
+    /**
+     * Applies the changes of the \p patch to this Dictionary. Applying the result of
+     * <code>diff(a, b)</code> to a Dictionary that is equal to \c a makes it equal to
+     * \c b. Removing a key that does not exist is ignored. If an exception is thrown,
+     * this Dictionary is left unchanged.
+     *
+     * \param patch The changes that are applied to this Dictionary
+     *
+     * \throws KeyError If the \p patch modifies a nested Dictionary that does not exist
+     * \throws ValueError If the \p patch modifies a nested Dictionary at a key that
+     *         contains a different type
+     */
+    void apply(const Patch& patch);
+
 private:
-    using StorageTypes = std::variant<
-        bool, int, double, std::string, Dictionary, std::vector<int>, std::vector<double>,
-        std::vector<std::string>
-    >;
-    std::map<std::string, StorageTypes, std::less<>> _storage;
+    friend class internal::DictionaryBinaryWriter;
+
+    /**
+     * Resolves all but the last segment of the dotted \p key without copying any of the
+     * nested Dictionaries. On return, \p key only contains the last segment.
+     *
+     * \return The Dictionary that contains the last segment of \p key or \c nullptr if
+     *         any of the intermediate segments does not exist or is not a Dictionary
+     */
+    const Dictionary* findParent(std::string_view& key) const;
+
+    /**
+     * Resolves all but the last segment of the precomputed \p key without copying any of
+     * the nested Dictionaries.
+     *
+     * \return The Dictionary that contains the last segment of \p key or \c nullptr if
+     *         any of the intermediate segments does not exist or is not a Dictionary
+     */
+    const Dictionary* findParent(const Key& key) const;
+
+    /**
+     * Returns the Dictionary stored at the single segment \p key with the CRC32 \p hash.
+     *
+     * \throws KeyError If the provided \p key does not exist
+     * \throws ValueError If the value stored at \p key is not a Dictionary
+     */
+    const Dictionary& childDictionary(std::string_view key, unsigned int hash) const;
+
+    /**
+     * Returns the value of type T stored at the single segment \p key with the CRC32
+     * \p hash.
+     *
+     * \throws KeyError If the provided \p key does not exist
+     * \throws ValueError If the value stored at \p key is not of type T
+     */
+    template <typename T>
+    T valueInternal(std::string_view key, unsigned int hash) const;
+
+    /// Checks whether a value of type T is stored at the single segment \p key with the
+    /// CRC32 \p hash
+    template <typename T>
+    bool hasValueInternal(std::string_view key, unsigned int hash) const;
+
+    struct Storage;
+
+    /// Returns all key-value pairs in the same order in which they are returned by #keys
+    std::vector<std::pair<std::string_view, const StorageTypes*>> sortedEntries() const;
+
+    /// Adds the changes that turn the entries of \p from into those of \p to to the
+    /// \p patch
+    static void diffEntries(const Dictionary& from, const Dictionary& to, Patch& patch);
+
+    /// Applies the \p patch without making a copy of this Dictionary first
+    void applyInPlace(const Patch& patch);
+
+    /// Returns the value stored at the single segment \p key with the CRC32 \p hash or
+    /// \c nullptr
+    const StorageTypes* find(std::string_view key, unsigned int hash) const;
+
+    /// Returns the storage for modification. If this Dictionary does not have a storage
+    /// yet, it is created. If the storage is shared with other Dictionaries, it is
+    /// cloned first so that the modification is not visible in the other Dictionaries
+    Storage& mutableStorage();
+
+    /// The values of this Dictionary, which are shared between copies and cloned on the
+    /// first modification. A Dictionary that never contained any values has no storage
+    std::shared_ptr<Storage> _storage;
+};
+
+struct Dictionary::Change {
+    enum class Type {
+        /// The value at the key is added or replaced by the value
+        Set,
+        /// The value at the key is removed
+        Remove,
+        /// The Dictionary at the key is modified by the nested changes
+        Modify
+    };
+
+    /// The kind of this change
+    Type type = Type::Set;
+
+    /// The key of the value that is changed
+    std::string key;
+
+    /// The new value if the type is Set. Its memory is allocated from the memory resource
+    /// of the Dictionary that was passed to #diff
+    StorageTypes value;
+
+    /// The changes to the nested Dictionary if the type is Modify
+    Patch changes;
 };
 
 // Just a few helper functions to make the error message a bit more palatable
 template <typename T, std::enable_if_t<!Dictionary::IsAllowedType<T>{}, int>>
-void Dictionary::setValue(std::string, T) {
+void Dictionary::setValue(std::string_view, T) {
     static_assert(sizeof(T) == 0, "Type is not an allowed type for Dictionary");
 }
 
@@ -227,4 +545,6 @@ bool Dictionary::hasValue(std::string_view) const {
 
 } // namespace ghoul
 
+#include "dictionary.inl"
+
 #endif // __GHOUL___DICTIONARY___H__
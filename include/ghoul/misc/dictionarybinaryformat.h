@@ -0,0 +1,273 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___DICTIONARYBINARYFORMAT___H__
+#define __GHOUL___DICTIONARYBINARYFORMAT___H__
+
+#include <ghoul/misc/buffer.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/exception.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ghoul {
+
+/// This exception is thrown if binary data does not contain a valid serialized Dictionary
+struct DictionaryBinaryFormatError : public RuntimeError {
+    explicit DictionaryBinaryFormatError(std::string msg);
+};
+
+/**
+ * Serializes the \p dictionary into a compact binary representation and appends it to
+ * the \p buffer. Every value is stored with a type tag and a length, so all values keep
+ * their exact type when the Dictionary is deserialized again. Nested Dictionaries that
+ * share their storage with each other are only stored once.
+ *
+ * If the data is not compressed, the serialized bytes can be inspected in place with a
+ * DictionaryView, for example after the buffer has been written to a file that is later
+ * memory-mapped. Compressing the data with LZ4 produces smaller files, but requires a
+ * call to deserializeDictionary before any of the values can be accessed.
+ *
+ * The binary representation uses the byte order of the host and is meant for caching,
+ * not for exchanging data between machines.
+ *
+ * \param dictionary The Dictionary that should be serialized
+ * \param buffer The Buffer to which the serialized Dictionary is appended
+ * \param compress Whether the serialized values should be compressed using LZ4
+ *
+ * \throw DictionaryBinaryFormatError If the serialized Dictionary would exceed 4 GB
+ * \throw RuntimeError If there was an error compressing the data
+ */
+void serializeDictionary(const Dictionary& dictionary, Buffer& buffer,
+    Buffer::Compress compress = Buffer::Compress::No);
+
+/**
+ * Deserializes a Dictionary that was previously stored with serializeDictionary from
+ * the current read position of the \p buffer. Nested Dictionaries that were stored only
+ * once share their storage in the returned Dictionary.
+ *
+ * \param buffer The Buffer from which the Dictionary is read
+ * \return The deserialized Dictionary
+ *
+ * \throw DictionaryBinaryFormatError If the \p buffer does not contain a valid
+ *        serialized Dictionary at its current read position, if it contains an empty
+ *        key or a key with a '.', or if it is nested deeper than 512 levels
+ */
+Dictionary deserializeDictionary(Buffer& buffer);
+
+/**
+ * A read-only view into an uncompressed Dictionary that was serialized with
+ * serializeDictionary. Lookups are performed directly on the serialized bytes, so only
+ * the values that are actually requested are decoded and there is no need to
+ * materialize the whole tree. The keys of each level are stored sorted by their hash,
+ * which makes each lookup a binary search.
+ *
+ * The view does not own the memory it points to, which has to stay valid and unchanged
+ * for the lifetime of the view and all views and string_views obtained from it. All
+ * offsets are validated when they are accessed, so corrupt data results in an exception
+ * rather than an out-of-bounds access. The memory does not have to be aligned.
+ *
+ * In addition to the types allowed in a Dictionary, strings can be retrieved as a
+ * std::string_view that points into the serialized data. A vector of ints or doubles
+ * and a glm type with the same value_type and number of components can be used
+ * interchangeably, like in the Dictionary.
+ */
+class DictionaryView {
+public:
+    /// Returns true if T can be retrieved from a DictionaryView
+    template <typename T>
+    using IsAllowedType = std::bool_constant<
+        Dictionary::IsAllowedType<T>{} || std::is_same_v<T, std::string_view>
+    >;
+
+    /**
+     * Creates a view into the serialized Dictionary that starts at \p data.
+     *
+     * \param data The beginning of a Dictionary serialized with serializeDictionary
+     * \param size The number of bytes that are available starting at \p data
+     *
+     * \throw DictionaryBinaryFormatError If \p data does not point to a valid serialized
+     *        Dictionary or if the Dictionary was compressed
+     * \pre \p data must not be nullptr
+     */
+    DictionaryView(const void* data, size_t size);
+
+    /**
+     * Retrieves the value stored at the provided \p key, which can contain '.' to access
+     * nested Dictionaries.
+     *
+     * \param key The key for which the value should be retrieved
+     * \return The value stored at the \p key
+     *
+     * \throw Dictionary::KeyError If the \p key does not exist
+     * \throw Dictionary::ValueError If the value stored at \p key has a different type
+     * \throw DictionaryBinaryFormatError If the serialized data is corrupt
+     * \pre \p key must not be empty
+     */
+    template <typename T, std::enable_if_t<IsAllowedType<T>{}, int> = 0>
+    T value(std::string_view key) const;
+
+    /**
+     * Returns whether a value of type T is stored at the provided \p key, which can
+     * contain '.' to access nested Dictionaries.
+     *
+     * \param key The key which should be checked
+     * \return \c true if the value stored at the \p key can be retrieved as a T
+     *
+     * \throw DictionaryBinaryFormatError If the serialized data is corrupt
+     * \pre \p key must not be empty
+     */
+    template <typename T, std::enable_if_t<IsAllowedType<T>{}, int> = 0>
+    bool hasValue(std::string_view key) const;
+
+    /**
+     * Returns whether the view contains a value for the provided \p key, which can
+     * contain '.' to access nested Dictionaries.
+     *
+     * \param key The key which should be checked
+     * \return \c true if there is a value for the \p key
+     *
+     * \throw DictionaryBinaryFormatError If the serialized data is corrupt
+     * \pre \p key must not be empty
+     */
+    bool hasKey(std::string_view key) const;
+
+    /**
+     * Returns a view of the nested Dictionary stored at the provided \p key, which can
+     * contain '.' to access deeper nested Dictionaries.
+     *
+     * \param key The key of the nested Dictionary
+     * \return A view of the nested Dictionary
+     *
+     * \throw Dictionary::KeyError If the \p key does not exist
+     * \throw Dictionary::ValueError If the value stored at \p key is not a Dictionary
+     * \throw DictionaryBinaryFormatError If the serialized data is corrupt
+     * \pre \p key must not be empty
+     */
+    DictionaryView subDictionary(std::string_view key) const;
+
+    /**
+     * Returns the keys on the level of this view, sorted alphabetically. The returned
+     * string_views point into the serialized data.
+     *
+     * \return The keys on the level of this view
+     *
+     * \throw DictionaryBinaryFormatError If the serialized data is corrupt
+     */
+    std::vector<std::string_view> keys() const;
+
+    /// Returns the number of keys on the level of this view
+    size_t size() const;
+
+    /// Returns whether this level of the view is empty
+    bool isEmpty() const;
+
+    /**
+     * Decodes all values of this view, including all nested Dictionaries, into a
+     * Dictionary.
+     *
+     * \return The Dictionary that contains all values of this view
+     *
+     * \throw DictionaryBinaryFormatError If the serialized data is corrupt
+     */
+    Dictionary dictionary() const;
+
+private:
+    friend Dictionary deserializeDictionary(Buffer& buffer);
+    friend class internal::DictionaryBinaryWriter;
+
+    /// The entry that describes a single key-value pair in the serialized data
+    struct Entry {
+        uint32_t hash;
+        uint32_t keyOffset;
+        uint32_t keyLength;
+        uint32_t valueOffset;
+        uint32_t valueSize;
+        uint32_t type;
+    };
+
+    /// Creates a view of the Dictionary node at \p node in the \p size bytes of the
+    /// serialized values that start at \p values
+    DictionaryView(const unsigned char* values, uint32_t size, uint32_t node);
+
+    /// Looks up the single segment \p key on this level and stores its description in
+    /// \p entry. Returns \c false if the \p key does not exist
+    bool findEntry(std::string_view key, Entry& entry) const;
+
+    /// Looks up the dotted \p key through the levels of nested Dictionaries and stores
+    /// its description in \p entry. Returns \c false if any of the segments does not
+    /// exist or if any but the last segment is not a Dictionary
+    bool findNestedEntry(std::string_view key, Entry& entry) const;
+
+    /// Returns the i-th entry on this level
+    Entry entry(uint32_t i) const;
+
+    /// Returns the key of the \p entry
+    std::string_view keyOf(const Entry& entry) const;
+
+    /// Decodes the value described by the \p entry for the \p key as a T
+    template <typename T>
+    T decode(const Entry& entry, std::string_view key) const;
+
+    /// Decodes this view into a Dictionary. Nodes that are referenced multiple times are
+    /// only decoded once and stored in the \p nodes, keyed by their offset. The
+    /// \p ancestors are the offsets of the nodes that are currently being decoded, which
+    /// a valid node can never reference
+    Dictionary dictionary(std::unordered_map<uint32_t, Dictionary>& nodes,
+        std::vector<uint32_t>& ancestors) const;
+
+    /// Returns a view of the nested Dictionary described by the \p entry
+    ///
+    /// \throw DictionaryBinaryFormatError If the node of the \p entry is one of the
+    ///        \p ancestors, which would make the serialized data cyclic, or if there are
+    ///        already 512 \p ancestors
+    DictionaryView childView(const Entry& entry,
+        const std::vector<uint32_t>& ancestors) const;
+
+    /// Returns a pointer to \p size bytes of the serialized values at \p offset
+    ///
+    /// \throw DictionaryBinaryFormatError If the bytes are not part of the values
+    const unsigned char* bytes(uint64_t offset, uint64_t size) const;
+
+    /// The serialized values
+    const unsigned char* _values = nullptr;
+
+    /// The number of bytes of serialized values
+    uint32_t _size = 0;
+
+    /// The offset of the Dictionary node of this view into the serialized values
+    uint32_t _node = 0;
+
+    /// The number of entries on the level of this view
+    uint32_t _nEntries = 0;
+};
+
+} // namespace ghoul
+
+#endif // __GHOUL___DICTIONARYBINARYFORMAT___H__
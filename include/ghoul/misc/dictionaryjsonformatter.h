@@ -27,6 +27,8 @@
 #define __GHOUL___DICTIONARYJSONFORMATTER___H__
 
 #include <ghoul/misc/exception.h>
+#include <iosfwd>
+#include <string>
 
 namespace ghoul {
 
@@ -47,6 +49,32 @@ struct JsonFormattingError : public RuntimeError {
  */
 std::string formatJson(const Dictionary& dictionary);
 
+/**
+ * Appends the JSON representation of the passed \p dictionary to the \p output. The
+ * representation is identical to the one returned by the overload that returns a
+ * string, but reusing the same \p output for multiple Dictionaries avoids repeated
+ * allocations.
+ *
+ * \param dictionary The Dictionary that should be converted
+ * \param output The string to which the JSON representation is appended
+ *
+ * \throw JsonFormattingError If the \p key points to a type that cannot be converted
+ */
+void formatJson(const Dictionary& dictionary, std::string& output);
+
+/**
+ * Writes the JSON representation of the passed \p dictionary into the \p stream. The
+ * representation is written in chunks while the Dictionary is converted, so the whole
+ * representation never has to be kept in memory at once. If an exception is thrown, a
+ * part of the representation might already have been written to the \p stream.
+ *
+ * \param dictionary The Dictionary that should be converted
+ * \param stream The stream into which the JSON representation is written
+ *
+ * \throw JsonFormattingError If the \p key points to a type that cannot be converted
+ */
+void formatJson(const Dictionary& dictionary, std::ostream& stream);
+
 }  // namespace ghoul
 
 #endif // __GHOUL___DICTIONARYJSONFORMATTER___H__
@@ -0,0 +1,123 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___DICTIONARYJSONPARSER___H__
+#define __GHOUL___DICTIONARYJSONPARSER___H__
+
+#include <ghoul/misc/exception.h>
+#include <string>
+#include <string_view>
+
+namespace ghoul {
+
+class Dictionary;
+
+/// This exception is thrown if the JSON that is parsed is malformed
+struct JsonParsingError : public RuntimeError {
+    explicit JsonParsingError(std::string msg, size_t lineNumber, size_t columnNumber);
+
+    /// The 1-based line in which the error occurred
+    const size_t line;
+
+    /// The 1-based column in which the error occurred
+    const size_t column;
+};
+
+/**
+ * The interface that receives the events from the streaming version of parseJson. The
+ * events are raised in the order in which the elements appear in the JSON document. Each
+ * value inside an object is preceded by a call to #key. The string_views passed to #key
+ * and #value either point into the parsed document or, if the string contained escape
+ * sequences, into a temporary buffer; in both cases they are only valid for the duration
+ * of the call.
+ */
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    /// Called when an object is opened
+    virtual void beginObject() = 0;
+
+    /// Called when the last opened object is closed
+    virtual void endObject() = 0;
+
+    /// Called when an array is opened
+    virtual void beginArray() = 0;
+
+    /// Called when the last opened array is closed
+    virtual void endArray() = 0;
+
+    /// Called with the unescaped name of the next member of the currently open object
+    virtual void key(std::string_view key) = 0;
+
+    /// Called for a \c null value
+    virtual void null() = 0;
+
+    /// Called for a \c true or \c false value
+    virtual void value(bool value) = 0;
+
+    /// Called for a number
+    virtual void value(double value) = 0;
+
+    /// Called for a string with all escape sequences resolved
+    virtual void value(std::string_view value) = 0;
+};
+
+/**
+ * Parses the \p json document into a Dictionary in a single pass without building an
+ * intermediate representation. The conversion follows the same rules as the conversion
+ * of Lua tables into Dictionaries: objects become Dictionaries, arrays become
+ * Dictionaries with the keys "1", "2", ..., all numbers are stored as \c double, and
+ * \c null values are omitted. If the top-level value is an array, the returned Dictionary
+ * contains its elements with the keys "1", "2", ...
+ *
+ * \param json The JSON document that should be parsed
+ * \return The Dictionary representing the \p json document
+ *
+ * \throw JsonParsingError If \p json is not a valid JSON document, if its top-level
+ *        value is neither an object nor an array, if an object member name is empty or
+ *        contains a '.', which cannot be represented as a Dictionary key, or if objects
+ *        and arrays are nested more than 512 levels deep
+ */
+Dictionary parseJson(std::string_view json);
+
+/**
+ * Parses the \p json document and reports its contents to the \p handler without
+ * creating a Dictionary, which makes it possible to process documents whose Dictionary
+ * representation would be too large to keep in memory, for example by memory-mapping a
+ * file and passing it as \p json. Any exception thrown by the \p handler is propagated
+ * to the caller.
+ *
+ * \param json The JSON document that should be parsed
+ * \param handler The handler that receives the contents of the document
+ *
+ * \throw JsonParsingError If \p json is not a valid JSON document or if objects and
+ *        arrays are nested more than 512 levels deep
+ */
+void parseJson(std::string_view json, JsonHandler& handler);
+
+} // namespace ghoul
+
+#endif // __GHOUL___DICTIONARYJSONPARSER___H__
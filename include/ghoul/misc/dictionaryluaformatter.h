@@ -28,6 +28,8 @@
 
 #include <ghoul/misc/boolean.h>
 #include <ghoul/misc/exception.h>
+#include <iosfwd>
+#include <string>
 
 namespace ghoul {
 
@@ -51,6 +53,35 @@ BooleanType(PrettyPrint);
 std::string formatLua(const Dictionary& dictionary,
     PrettyPrint prettyPrint = PrettyPrint::No, const std::string& indentation = "    ");
 
+/**
+    * Appends the Lua string representation of the passed \p dictionary to the
+    * \p output. The representation is identical to the one returned by the overload that
+    * returns a string, but reusing the same \p output for multiple Dictionaries avoids
+    * repeated allocations.
+    *
+    * \param dictionary The Dictionary that should be converted
+    * \param output The string to which the Lua representation is appended
+    *
+    * \throw LuaFormattingError If the \p key points to a type that cannot be converted
+    */
+void formatLua(const Dictionary& dictionary, std::string& output,
+    PrettyPrint prettyPrint = PrettyPrint::No, const std::string& indentation = "    ");
+
+/**
+    * Writes the Lua string representation of the passed \p dictionary into the
+    * \p stream. The representation is written in chunks while the Dictionary is
+    * converted, so the whole representation never has to be kept in memory at once. If
+    * an exception is thrown, a part of the representation might already have been
+    * written to the \p stream.
+    *
+    * \param dictionary The Dictionary that should be converted
+    * \param stream The stream into which the Lua representation is written
+    *
+    * \throw LuaFormattingError If the \p key points to a type that cannot be converted
+    */
+void formatLua(const Dictionary& dictionary, std::ostream& stream,
+    PrettyPrint prettyPrint = PrettyPrint::No, const std::string& indentation = "    ");
+
 }  // namespace ghoul
 
 #endif // __GHOUL___DICTIONARYLUAFORMATTER___H__
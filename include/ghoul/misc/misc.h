@@ -27,6 +27,7 @@
 #define __GHOUL___MISC___H__
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ghoul {
@@ -71,6 +72,39 @@ void trimWhitespace(std::string& value);
  */
 void trimSurroundingCharacters(std::string& valueString, const char charToRemove);
 
+/**
+ * Returns the position of the first quotation mark, backslash, or control character in
+ * the \p value, which are the characters that might have to be escaped when the \p value
+ * is written as a JSON or Lua string. The search uses SIMD instructions where they are
+ * available.
+ *
+ * \param value The string that is searched
+ * \return The position of the first character that might have to be escaped or
+ *         std::string_view::npos if there is no such character
+ */
+size_t findCharacterToEscape(std::string_view value);
+
+/// The language whose string syntax is used by appendEscapedString
+enum class EscapeSyntax {
+    Json,
+    Lua
+};
+
+/**
+ * Appends the \p value to the \p output and escapes quotation marks, backslashes, and
+ * control characters, producing the content of a string that is valid in the
+ * \p syntax. Control characters that have a short escape sequence (\\b, \\f, \\n,
+ * \\r, and \\t) use it, all other control characters are written as
+ * <code>\\u00XX</code> in JSON and as <code>\\ddd</code> in Lua. All other characters
+ * are copied unchanged.
+ *
+ * \param output The string to which the escaped \p value is appended
+ * \param value The string that is escaped
+ * \param syntax The language in which the escaped \p value has to be valid
+ */
+void appendEscapedString(std::string& output, std::string_view value,
+    EscapeSyntax syntax);
+
 } // namespace ghoul
 
 #endif // __GHOUL___MISC___H__
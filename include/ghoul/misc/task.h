@@ -0,0 +1,486 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___TASK___H__
+#define __GHOUL___TASK___H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace ghoul {
+
+/**
+ * A move-only type-erased wrapper around a callable object without parameters and
+ * return value. In contrast to <code>std::function</code>, the callable object does not
+ * have to be copyable and small callable objects (up to #InlineSize bytes) are stored
+ * inline in the Task, so creating, moving, and destroying a Task does not allocate any
+ * memory for those. Larger callable objects, or those that are not nothrow move
+ * constructible, are stored on the heap instead.
+ */
+class Task {
+public:
+    /// The maximum size of a callable object that is stored inline
+    static constexpr const size_t InlineSize = 48;
+
+    /**
+     * Returns whether a callable object of type \p F will be stored inline in a Task or
+     * whether it requires a heap allocation.
+     *
+     * \tparam F The type of the callable object
+     * \return <code>true</code> if the callable object is stored inline
+     */
+    template <typename F>
+    static constexpr bool isStoredInline();
+
+    /// Creates an empty Task that must not be called
+    Task() = default;
+
+    /**
+     * Creates a Task that wraps the passed \p function.
+     *
+     * \param function The callable object that is called when the Task is executed
+     */
+    template <typename F,
+        typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& function);
+
+    Task(Task&& other) noexcept;
+    Task& operator=(Task&& other) noexcept;
+    ~Task();
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    /**
+     * Executes the wrapped callable object.
+     *
+     * \pre The Task must not be empty
+     */
+    void operator()();
+
+    /**
+     * Returns <code>true</code> if this Task contains a callable object.
+     */
+    explicit operator bool() const;
+
+private:
+    /// The type-specific functions that operate on the stored callable object
+    struct Operations {
+        void (*invoke)(void* storage);
+        void (*move)(void* to, void* from);
+        void (*destroy)(void* storage);
+    };
+
+    template <typename F>
+    static const Operations* inlineOperations();
+
+    template <typename F>
+    static const Operations* heapOperations();
+
+    void reset();
+
+    /// Contains either the callable object itself or a pointer to it
+    alignas(std::max_align_t) std::byte _storage[InlineSize];
+    /// The functions operating on \c _storage or \c nullptr if the Task is empty
+    const Operations* _operations = nullptr;
+};
+
+class ThreadPool;
+
+/// The identifier of a task that was submitted to a ThreadPool. The value 0 denotes a
+/// task without an identifier
+using TaskId = uint64_t;
+
+template <typename T> class TaskFuture;
+template <typename T> class TaskPromise;
+class TaskDependency;
+
+namespace internal {
+
+/**
+ * Queues the \p task in the \p pool. This function is used to schedule continuations
+ * without having to include the ThreadPool in this file.
+ */
+void scheduleTask(ThreadPool* pool, Task&& task);
+
+/**
+ * A list of unused objects of type \p T that is kept separately for each thread, which
+ * allows objects to be reused without touching the heap or any synchronization. Objects
+ * are only cached up to the \p Capacity and are deleted after that or if they are
+ * released while the thread is shutting down.
+ */
+template <typename T, int Capacity = 256>
+class ThreadLocalFreeList {
+public:
+    /**
+     * Returns a previously released object or \c nullptr if there is none available for
+     * the calling thread.
+     */
+    static T* acquire();
+
+    /**
+     * Returns the \p object to the list of the calling thread or deletes it if that list
+     * is already full. The \p object must have been allocated with <code>new</code>.
+     */
+    static void release(T* object);
+
+private:
+    struct Storage {
+        explicit Storage(bool& isDestroyedFlag);
+        ~Storage();
+
+        std::vector<T*> objects;
+        bool& isDestroyed;
+    };
+
+    static Storage* storage();
+};
+
+/**
+ * The part of the state shared between a TaskPromise and a TaskFuture that does not
+ * depend on the type of the value. In addition to the value, the state holds the
+ * continuations that are executed as soon as the value or an exception is set.
+ */
+class TaskStateBase {
+public:
+    virtual ~TaskStateBase() = default;
+
+    void addRef();
+
+    /// Decreases the reference count and recycles the state if it reaches 0
+    void release();
+
+    /// Returns whether a value or an exception has been set
+    bool isReady() const;
+
+    /// Blocks the calling thread until a value or an exception has been set
+    void wait();
+
+    /// Returns the ThreadPool that produces the value or \c nullptr if there is none
+    ThreadPool* pool() const;
+
+    /// Sets the ThreadPool that produces the value
+    void setPool(ThreadPool* pool);
+
+    /// Returns the identifier of the task that produces the value
+    TaskId taskId() const;
+
+    /// Sets the identifier of the task that produces the value
+    void setTaskId(TaskId id);
+
+    /**
+     * Adds the \p task that is executed as soon as a value or an exception is set. If
+     * the \p pool is not \c nullptr, the \p task is queued in that ThreadPool,
+     * otherwise it is executed directly by the thread that sets the value. If the state
+     * is already ready, the \p task is queued or executed immediately.
+     */
+    void addContinuation(ThreadPool* pool, Task task);
+
+protected:
+    /// Marks the state as ready, wakes up all threads that are waiting for it, and
+    /// executes the continuations
+    void finish();
+
+    /// Resets all members of the base class to a newly constructed state
+    void reset();
+
+    /// Is called when the reference count reaches 0
+    virtual void recycle() = 0;
+
+    std::atomic_int _refCount = 1;
+    std::atomic_bool _isReady = false;
+    std::exception_ptr _exception;
+    ThreadPool* _pool = nullptr;
+    TaskId _taskId = 0;
+
+    // Only used if a thread actually has to wait for the result or if continuations were
+    // added
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _hasWaiters = false;
+
+    struct Continuation {
+        ThreadPool* pool;
+        Task task;
+    };
+    std::vector<Continuation> _continuations;
+};
+
+/**
+ * The reference-counted state that is shared between a TaskPromise and a TaskFuture.
+ * States are recycled through a ThreadLocalFreeList so that creating a new promise does
+ * not allocate memory in the common case.
+ */
+template <typename T>
+class TaskState final : public TaskStateBase {
+public:
+    /// Returns a new state with a reference count of 1
+    static TaskState* create();
+
+    template <typename... Args>
+    void setValue(Args&&... value);
+    void setException(std::exception_ptr exception);
+
+    /// Returns the value or rethrows the exception that was set
+    T takeValue();
+
+private:
+    void recycle() override;
+
+    using Storage = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+    std::optional<Storage> _value;
+};
+
+/// The type of the value that is produced by a continuation \p F of a task that
+/// produces a value of type \p T
+template <typename T, typename F>
+struct ContinuationResult {
+    using type = std::invoke_result_t<std::decay_t<F>&, T>;
+};
+
+template <typename F>
+struct ContinuationResult<void, F> {
+    using type = std::invoke_result_t<std::decay_t<F>&>;
+};
+
+} // namespace internal
+
+/**
+ * A lightweight replacement of <code>std::future</code> that is returned by
+ * ThreadPool::submit. The value can be retrieved exactly once by calling #get, which
+ * blocks until the value is available.
+ *
+ * \tparam T The type of the value, which may be <code>void</code>
+ */
+template <typename T>
+class TaskFuture {
+    static_assert(!std::is_reference_v<T>, "References are not supported");
+
+public:
+    /// Creates an invalid TaskFuture
+    TaskFuture() = default;
+    TaskFuture(TaskFuture&& other) noexcept;
+    TaskFuture& operator=(TaskFuture&& other) noexcept;
+    ~TaskFuture();
+
+    TaskFuture(const TaskFuture&) = delete;
+    TaskFuture& operator=(const TaskFuture&) = delete;
+
+    /**
+     * Returns <code>true</code> if this TaskFuture refers to a shared state, which is the
+     * case until #get has been called.
+     */
+    bool isValid() const;
+
+    /**
+     * Returns <code>true</code> if the value or an exception is available.
+     *
+     * \pre The TaskFuture must be valid
+     */
+    bool isReady() const;
+
+    /**
+     * Blocks until the value or an exception is available.
+     *
+     * \pre The TaskFuture must be valid
+     */
+    void wait() const;
+
+    /**
+     * Blocks until the value is available and returns it. If the task threw an
+     * exception, that exception is rethrown instead. After this call, the TaskFuture is
+     * no longer valid.
+     *
+     * \return The value of the task
+     * \pre The TaskFuture must be valid
+     * \post The TaskFuture is no longer valid
+     */
+    T get();
+
+    /**
+     * Returns the identifier of the task that produces the value of this TaskFuture,
+     * which can be used to ThreadPool::cancel or ThreadPool::reprioritize the task while
+     * it is still queued. Only the TaskFuture%s returned from ThreadPool::submit have an
+     * identifier, all others return 0.
+     *
+     * \return The identifier of the task that produces the value
+     * \pre The TaskFuture must be valid
+     */
+    TaskId taskId() const;
+
+    /**
+     * Attaches the \p function as a continuation that is called with the value of this
+     * TaskFuture as soon as it is available, without blocking any thread. If this
+     * TaskFuture was returned by ThreadPool::submit, the continuation is queued in the
+     * same ThreadPool; otherwise it is executed by the thread that sets the value. If the
+     * value is already available, the continuation is scheduled immediately. If this
+     * TaskFuture receives an exception, the \p function is not called and the exception
+     * is forwarded to the returned TaskFuture instead. After this call, this TaskFuture
+     * is no longer valid.
+     *
+     * \param function The function that is called with the value of this TaskFuture,
+     *        or without arguments if T is <code>void</code>
+     * \return The TaskFuture that receives the return value of the \p function
+     * \pre The TaskFuture must be valid
+     * \post The TaskFuture is no longer valid
+     */
+    template <typename Function>
+    auto then(Function&& function)
+        -> TaskFuture<typename internal::ContinuationResult<T, Function>::type>;
+
+    /**
+     * Attaches the \p function as a continuation that is queued in the \p pool as soon
+     * as the value of this TaskFuture is available. Apart from the ThreadPool that is
+     * used, this function behaves the same as the other overload.
+     *
+     * \param pool The ThreadPool in which the continuation is executed. The ThreadPool
+     *        must stay alive until the continuation has been queued
+     * \param function The function that is called with the value of this TaskFuture,
+     *        or without arguments if T is <code>void</code>
+     * \return The TaskFuture that receives the return value of the \p function
+     * \pre The TaskFuture must be valid
+     * \post The TaskFuture is no longer valid
+     */
+    template <typename Function>
+    auto then(ThreadPool& pool, Function&& function)
+        -> TaskFuture<typename internal::ContinuationResult<T, Function>::type>;
+
+private:
+    friend class TaskPromise<T>;
+    friend class TaskDependency;
+
+    template <typename Function>
+    auto continueWith(ThreadPool* pool, Function&& function)
+        -> TaskFuture<typename internal::ContinuationResult<T, Function>::type>;
+
+    explicit TaskFuture(internal::TaskState<T>* state);
+
+    internal::TaskState<T>* _state = nullptr;
+};
+
+/**
+ * The producer side of a TaskFuture. If the TaskPromise is destroyed without a value or
+ * exception being set, the TaskFuture receives a RuntimeError instead.
+ *
+ * \tparam T The type of the value, which may be <code>void</code>
+ */
+template <typename T>
+class TaskPromise {
+public:
+    /// Creates a new TaskPromise with a fresh shared state
+    TaskPromise();
+    TaskPromise(TaskPromise&& other) noexcept;
+    TaskPromise& operator=(TaskPromise&& other) noexcept;
+    ~TaskPromise();
+
+    TaskPromise(const TaskPromise&) = delete;
+    TaskPromise& operator=(const TaskPromise&) = delete;
+
+    /**
+     * Returns the TaskFuture that is connected to this TaskPromise.
+     *
+     * \return The TaskFuture that is connected to this TaskPromise
+     * \pre This function must only be called once
+     */
+    TaskFuture<T> future();
+
+    /**
+     * Sets the value that is returned by the connected TaskFuture. For
+     * <code>void</code>, this function has to be called without arguments.
+     *
+     * \param value The value that is set
+     * \pre No value or exception must have been set before
+     */
+    template <typename... Args>
+    void setValue(Args&&... value);
+
+    /**
+     * Sets the \p exception that is rethrown by the connected TaskFuture.
+     *
+     * \param exception The exception that is rethrown
+     * \pre No value or exception must have been set before
+     */
+    void setException(std::exception_ptr exception);
+
+private:
+    friend class ThreadPool;
+    template <typename U> friend class TaskFuture;
+
+    /// Releases the state and sets a RuntimeError if no value was set
+    void abandon();
+
+    /// Sets the ThreadPool in which continuations of the TaskFuture are executed
+    void setPool(ThreadPool* pool);
+
+    /// Sets the identifier of the task that will set the value
+    void setTaskId(TaskId id);
+
+    internal::TaskState<T>* _state = nullptr;
+    bool _hasFuture = false;
+};
+
+/**
+ * A non-owning reference to the completion of a TaskFuture that is used to express the
+ * dependencies in ThreadPool::submitAfter. Creating a TaskDependency does not consume
+ * the TaskFuture, so its value can still be retrieved afterwards.
+ */
+class TaskDependency {
+public:
+    /**
+     * Creates a dependency on the completion of the \p future.
+     *
+     * \param future The TaskFuture whose completion is referenced
+     * \pre The \p future must be valid
+     */
+    template <typename T>
+    TaskDependency(const TaskFuture<T>& future);
+
+    TaskDependency(const TaskDependency& other);
+    TaskDependency(TaskDependency&& other) noexcept;
+    TaskDependency& operator=(TaskDependency other) noexcept;
+    ~TaskDependency();
+
+    /// Returns whether the referenced task has finished
+    bool isReady() const;
+
+private:
+    friend class ThreadPool;
+
+    internal::TaskStateBase* _state = nullptr;
+};
+
+} // namespace ghoul
+
+#include "task.inl"
+
+#endif // __GHOUL___TASK___H__
@@ -0,0 +1,428 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <new>
+#include <utility>
+
+namespace ghoul {
+
+template <typename F>
+constexpr bool Task::isStoredInline() {
+    return sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<F>;
+}
+
+template <typename F, typename>
+Task::Task(F&& function) {
+    using Function = std::decay_t<F>;
+    if constexpr (isStoredInline<Function>()) {
+        new (_storage) Function(std::forward<F>(function));
+        _operations = inlineOperations<Function>();
+    }
+    else {
+        new (_storage) Function*(new Function(std::forward<F>(function)));
+        _operations = heapOperations<Function>();
+    }
+}
+
+inline Task::Task(Task&& other) noexcept {
+    if (other._operations) {
+        other._operations->move(_storage, other._storage);
+        _operations = other._operations;
+        other._operations = nullptr;
+    }
+}
+
+inline Task& Task::operator=(Task&& other) noexcept {
+    if (this != &other) {
+        reset();
+        if (other._operations) {
+            other._operations->move(_storage, other._storage);
+            _operations = other._operations;
+            other._operations = nullptr;
+        }
+    }
+    return *this;
+}
+
+inline Task::~Task() {
+    reset();
+}
+
+inline void Task::operator()() {
+    ghoul_assert(_operations, "Task must not be empty");
+    _operations->invoke(_storage);
+}
+
+inline Task::operator bool() const {
+    return _operations != nullptr;
+}
+
+inline void Task::reset() {
+    if (_operations) {
+        _operations->destroy(_storage);
+        _operations = nullptr;
+    }
+}
+
+template <typename F>
+const Task::Operations* Task::inlineOperations() {
+    static constexpr Operations Ops = {
+        [](void* storage) { (*std::launder(reinterpret_cast<F*>(storage)))(); },
+        [](void* to, void* from) {
+            F* f = std::launder(reinterpret_cast<F*>(from));
+            new (to) F(std::move(*f));
+            f->~F();
+        },
+        [](void* storage) { std::launder(reinterpret_cast<F*>(storage))->~F(); }
+    };
+    return &Ops;
+}
+
+template <typename F>
+const Task::Operations* Task::heapOperations() {
+    static constexpr Operations Ops = {
+        [](void* storage) { (**std::launder(reinterpret_cast<F**>(storage)))(); },
+        [](void* to, void* from) {
+            new (to) F*(*std::launder(reinterpret_cast<F**>(from)));
+        },
+        [](void* storage) { delete *std::launder(reinterpret_cast<F**>(storage)); }
+    };
+    return &Ops;
+}
+
+namespace internal {
+
+template <typename T, int Capacity>
+ThreadLocalFreeList<T, Capacity>::Storage::Storage(bool& isDestroyedFlag)
+    : isDestroyed(isDestroyedFlag)
+{
+    objects.reserve(Capacity);
+}
+
+template <typename T, int Capacity>
+ThreadLocalFreeList<T, Capacity>::Storage::~Storage() {
+    // Objects that are released after this point are deleted directly
+    isDestroyed = true;
+    for (T* object : objects) {
+        delete object;
+    }
+}
+
+template <typename T, int Capacity>
+typename ThreadLocalFreeList<T, Capacity>::Storage*
+ThreadLocalFreeList<T, Capacity>::storage()
+{
+    // The flag is trivially destructible and can thus still be accessed while the other
+    // thread_local objects of this thread are destroyed
+    static thread_local bool IsDestroyed = false;
+    static thread_local Storage S(IsDestroyed);
+    return IsDestroyed ? nullptr : &S;
+}
+
+template <typename T, int Capacity>
+T* ThreadLocalFreeList<T, Capacity>::acquire() {
+    Storage* s = storage();
+    if (!s || s->objects.empty()) {
+        return nullptr;
+    }
+
+    T* object = s->objects.back();
+    s->objects.pop_back();
+    return object;
+}
+
+template <typename T, int Capacity>
+void ThreadLocalFreeList<T, Capacity>::release(T* object) {
+    Storage* s = storage();
+    if (s && s->objects.size() < static_cast<size_t>(Capacity)) {
+        s->objects.push_back(object);
+    }
+    else {
+        delete object;
+    }
+}
+
+template <typename T>
+TaskState<T>* TaskState<T>::create() {
+    TaskState* state = ThreadLocalFreeList<TaskState>::acquire();
+    return state ? state : new TaskState;
+}
+
+template <typename T>
+void TaskState<T>::recycle() {
+    // We were the last owner, so we reset the state and make it available for reuse
+    reset();
+    _value.reset();
+    ThreadLocalFreeList<TaskState>::release(this);
+}
+
+template <typename T>
+template <typename... Args>
+void TaskState<T>::setValue(Args&&... value) {
+    ghoul_assert(!isReady(), "Value must only be set once");
+    _value.emplace(std::forward<Args>(value)...);
+    finish();
+}
+
+template <typename T>
+void TaskState<T>::setException(std::exception_ptr exception) {
+    ghoul_assert(!isReady(), "Value must only be set once");
+    _exception = std::move(exception);
+    finish();
+}
+
+template <typename T>
+T TaskState<T>::takeValue() {
+    wait();
+    if (_exception) {
+        std::rethrow_exception(_exception);
+    }
+
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*_value);
+    }
+}
+
+} // namespace internal
+
+template <typename T>
+TaskFuture<T>::TaskFuture(internal::TaskState<T>* state)
+    : _state(state)
+{}
+
+template <typename T>
+TaskFuture<T>::TaskFuture(TaskFuture&& other) noexcept
+    : _state(std::exchange(other._state, nullptr))
+{}
+
+template <typename T>
+TaskFuture<T>& TaskFuture<T>::operator=(TaskFuture&& other) noexcept {
+    if (this != &other) {
+        if (_state) {
+            _state->release();
+        }
+        _state = std::exchange(other._state, nullptr);
+    }
+    return *this;
+}
+
+template <typename T>
+TaskFuture<T>::~TaskFuture() {
+    if (_state) {
+        _state->release();
+    }
+}
+
+template <typename T>
+bool TaskFuture<T>::isValid() const {
+    return _state != nullptr;
+}
+
+template <typename T>
+bool TaskFuture<T>::isReady() const {
+    ghoul_assert(_state, "TaskFuture must be valid");
+    return _state->isReady();
+}
+
+template <typename T>
+void TaskFuture<T>::wait() const {
+    ghoul_assert(_state, "TaskFuture must be valid");
+    _state->wait();
+}
+
+template <typename T>
+T TaskFuture<T>::get() {
+    ghoul_assert(_state, "TaskFuture must be valid");
+
+    // Release the state even if the value is an exception that gets rethrown
+    internal::TaskState<T>* state = std::exchange(_state, nullptr);
+    struct Releaser {
+        ~Releaser() { s->release(); }
+        internal::TaskState<T>* s;
+    } releaser = { state };
+    return state->takeValue();
+}
+
+template <typename T>
+TaskId TaskFuture<T>::taskId() const {
+    ghoul_assert(_state, "TaskFuture must be valid");
+    return _state->taskId();
+}
+
+template <typename T>
+template <typename Function>
+auto TaskFuture<T>::then(Function&& function)
+    -> TaskFuture<typename internal::ContinuationResult<T, Function>::type>
+{
+    ghoul_assert(_state, "TaskFuture must be valid");
+    return continueWith(_state->pool(), std::forward<Function>(function));
+}
+
+template <typename T>
+template <typename Function>
+auto TaskFuture<T>::then(ThreadPool& pool, Function&& function)
+    -> TaskFuture<typename internal::ContinuationResult<T, Function>::type>
+{
+    ghoul_assert(_state, "TaskFuture must be valid");
+    return continueWith(&pool, std::forward<Function>(function));
+}
+
+template <typename T>
+template <typename Function>
+auto TaskFuture<T>::continueWith(ThreadPool* pool, Function&& function)
+    -> TaskFuture<typename internal::ContinuationResult<T, Function>::type>
+{
+    using ResultType = typename internal::ContinuationResult<T, Function>::type;
+
+    internal::TaskState<T>* state = _state;
+
+    TaskPromise<ResultType> promise;
+    promise.setPool(pool);
+    TaskFuture<ResultType> result = promise.future();
+
+    // The continuation takes over this TaskFuture, which keeps the shared state alive
+    // until the continuation has been executed
+    state->addContinuation(pool, Task(
+        [previous = std::move(*this), promise = std::move(promise),
+         f = std::forward<Function>(function)]() mutable
+        {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    previous.get();
+                    if constexpr (std::is_void_v<ResultType>) {
+                        f();
+                        promise.setValue();
+                    }
+                    else {
+                        promise.setValue(f());
+                    }
+                }
+                else {
+                    if constexpr (std::is_void_v<ResultType>) {
+                        f(previous.get());
+                        promise.setValue();
+                    }
+                    else {
+                        promise.setValue(f(previous.get()));
+                    }
+                }
+            }
+            catch (...) {
+                promise.setException(std::current_exception());
+            }
+        }
+    ));
+
+    return result;
+}
+
+template <typename T>
+TaskPromise<T>::TaskPromise()
+    : _state(internal::TaskState<T>::create())
+{}
+
+template <typename T>
+TaskPromise<T>::TaskPromise(TaskPromise&& other) noexcept
+    : _state(std::exchange(other._state, nullptr))
+    , _hasFuture(other._hasFuture)
+{}
+
+template <typename T>
+TaskPromise<T>& TaskPromise<T>::operator=(TaskPromise&& other) noexcept {
+    if (this != &other) {
+        abandon();
+        _state = std::exchange(other._state, nullptr);
+        _hasFuture = other._hasFuture;
+    }
+    return *this;
+}
+
+template <typename T>
+TaskPromise<T>::~TaskPromise() {
+    abandon();
+}
+
+template <typename T>
+void TaskPromise<T>::abandon() {
+    if (!_state) {
+        return;
+    }
+
+    if (!_state->isReady()) {
+        _state->setException(std::make_exception_ptr(
+            RuntimeError("Promise was destroyed without setting a value", "TaskPromise")
+        ));
+    }
+    _state->release();
+    _state = nullptr;
+}
+
+template <typename T>
+TaskFuture<T> TaskPromise<T>::future() {
+    ghoul_assert(_state, "TaskPromise must have a state");
+    ghoul_assert(!_hasFuture, "The future must only be retrieved once");
+
+    _hasFuture = true;
+    _state->addRef();
+    return TaskFuture<T>(_state);
+}
+
+template <typename T>
+template <typename... Args>
+void TaskPromise<T>::setValue(Args&&... value) {
+    ghoul_assert(_state, "TaskPromise must have a state");
+    _state->setValue(std::forward<Args>(value)...);
+}
+
+template <typename T>
+void TaskPromise<T>::setException(std::exception_ptr exception) {
+    ghoul_assert(_state, "TaskPromise must have a state");
+    _state->setException(std::move(exception));
+}
+
+template <typename T>
+void TaskPromise<T>::setPool(ThreadPool* pool) {
+    ghoul_assert(_state, "TaskPromise must have a state");
+    _state->setPool(pool);
+}
+
+template <typename T>
+void TaskPromise<T>::setTaskId(TaskId id) {
+    ghoul_assert(_state, "TaskPromise must have a state");
+    _state->setTaskId(id);
+}
+
+template <typename T>
+TaskDependency::TaskDependency(const TaskFuture<T>& future)
+    : _state(future._state)
+{
+    ghoul_assert(_state, "TaskFuture must be valid");
+    _state->addRef();
+}
+
+} // namespace ghoul
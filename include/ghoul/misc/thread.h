@@ -27,7 +27,9 @@
 #define __GHOUL___THREAD___H__
 
 #include <ghoul/misc/boolean.h>
+#include <filesystem>
 #include <thread>
+#include <vector>
 
 namespace ghoul::thread {
 
@@ -86,6 +88,83 @@ void setPriority(std::thread& t, ThreadPriorityClass priorityClass,
  */
 void setThreadBackground(std::thread& t, Background background);
 
+/**
+ * This method restricts the thread \p t to run only on the logical CPUs whose indices are
+ * passed in \p cpus, which prevents the scheduler from migrating the thread to other
+ * CPUs. This function is supported on Linux and Windows (for the first 64 logical CPUs)
+ * and reverts to a no-op on other platforms.
+ *
+ * \param t The thread whose affinity is changed
+ * \param cpus The indices of the logical CPUs on which \p t is allowed to run, as they
+ *        are reported in the LogicalCpu::id
+ *
+ * \throw ghoul::RuntimeError If the affinity could not be set, for example because none
+ *        of the \p cpus is available to this process
+ * \pre \p cpus must not be empty
+ */
+void setAffinity(std::thread& t, const std::vector<int>& cpus);
+
+/**
+ * Information about a single logical CPU, which is a hardware thread of a physical core.
+ */
+struct LogicalCpu {
+    /// The index of the logical CPU as it is used by the operating system
+    int id = 0;
+    /// The index of the physical core that this logical CPU belongs to. All hardware
+    /// threads of the same core have the same index
+    int core = 0;
+    /// The index of the processor package (socket) that this logical CPU belongs to
+    int package = 0;
+    /// The index of the group of physical cores that share the last-level cache with
+    /// this logical CPU
+    int cacheGroup = 0;
+};
+
+/**
+ * The topology of the logical CPUs that are available to this process.
+ */
+struct CpuTopology {
+    /**
+     * Returns the number of different physical cores.
+     *
+     * \return The number of different physical cores
+     */
+    int nPhysicalCores() const;
+
+    /**
+     * Returns the number of different groups of cores that share the last-level cache.
+     *
+     * \return The number of different groups of cores that share the last-level cache
+     */
+    int nCacheGroups() const;
+
+    /// The logical CPUs sorted by their LogicalCpu::id
+    std::vector<LogicalCpu> cpus;
+};
+
+/**
+ * Detects the topology of the logical CPUs on which this process is allowed to run. On
+ * Linux, the topology is read from <code>/sys/devices/system/cpu</code>, on Windows it
+ * is queried from the operating system. On other platforms or if the detection fails,
+ * each of the <code>std::thread::hardware_concurrency</code> logical CPUs is reported as
+ * a separate physical core and all of them share the same cache.
+ *
+ * \return The topology of the available logical CPUs
+ */
+CpuTopology cpuTopology();
+
+/**
+ * Reads the topology of all online logical CPUs from the \p directory, which must have
+ * the layout of the Linux <code>/sys/devices/system/cpu</code> directory. If the cache
+ * information is missing, the package of a logical CPU is used as its cache group.
+ *
+ * \param directory The directory from which the topology is read
+ * \return The topology of the logical CPUs that are listed in the directory
+ *
+ * \throw ghoul::RuntimeError If the list of online CPUs could not be read
+ */
+CpuTopology cpuTopology(const std::filesystem::path& directory);
+
 } // namespace ghoul::thread
 
 #endif // __GHOUL___THREAD___H__
@@ -44,13 +44,24 @@
 #define __GHOUL___THREADPOOL___H__
 
 #include <ghoul/misc/boolean.h>
+#include <ghoul/misc/task.h>
 #include <ghoul/misc/thread.h>
+#include <ghoul/misc/workstealingqueue.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <future>
+#include <iterator>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
 #include <thread>
 #include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace ghoul {
 
@@ -89,6 +100,44 @@ namespace ghoul {
  *
  * Tasks passed to the ThreadPool as started in order a strict FIFO ordering.
  *
+ * In addition to #queue, tasks can be passed to the #submit function, which returns a
+ * TaskFuture instead of a <code>std::future</code>. This avoids the memory allocations
+ * of <code>std::packaged_task</code> and <code>std::function</code> and is preferable
+ * for large numbers of small tasks. TaskFuture::then and #submitAfter can be used to
+ * express dependencies between tasks without blocking any thread.
+ *
+ * The FIFO ordering can be changed per task by passing TaskOptions to #queue or #submit.
+ * Tasks with a deadline are started first in the order of their deadlines, followed by
+ * the remaining tasks in the order of their Priority. To prevent low priority tasks from
+ * starving, a lower Priority is served after it has been passed over StarvationLimit
+ * times. Tasks that are still waiting can be #cancel%ed or #reprioritize%d using the
+ * identifier that is returned by TaskFuture::taskId.
+ *
+ * Alternatively, a ThreadPool can be created in a work-stealing mode
+ * (WorkStealing::Yes). In this mode, each Worker owns a lock-free WorkStealingQueue in
+ * addition to the shared queue. Tasks that are queued from inside a Worker are pushed to
+ * that Worker's own queue, from which it takes tasks in LIFO order, and idle Worker%s
+ * steal tasks from the other Worker%s' queues. Tasks queued from threads outside of the
+ * ThreadPool are still placed into the shared queue. This mode reduces the contention on
+ * the shared queue for workloads that consist of many small tasks that spawn other tasks,
+ * but the strict FIFO ordering is no longer guaranteed.
+ *
+ * For sizing a ThreadPool and finding stalls, the ThreadPool can collect Statistics about
+ * the time tasks spend waiting in the queues and executing, the busy and idle times of
+ * each Worker, and the number of steals and wake-ups (#setStatisticsEnabled). If Tracy
+ * is enabled, each executed task and each sleeping period of a Worker is marked as a
+ * zone.
+ *
+ * C++20 coroutines can move themselves onto one of the Worker%s with
+ * <code>co_await pool.schedule()</code>, which suspends the coroutine and queues its
+ * resumption as a task. Together with the CoroutineTask (coroutinetask.h), chains of
+ * asynchronous operations can be expressed without blocking any thread.
+ *
+ * On machines with many cores, the Worker%s can be pinned to specific CPUs according to a
+ * Placement that is based on the detected thread::CpuTopology (#setPlacement). This
+ * prevents the operating system from migrating the Worker%s between cores and can be used
+ * to keep a ThreadPool away from the CPUs that are reserved for other threads.
+ *
  * Workers can be initialized with custom functions that are passed to the ThreadPool
  * during construction. These functions are called once for each Worker at the beginning
  * and at the end of its lifetime.
@@ -102,6 +151,165 @@ class ThreadPool {
 public:
     BooleanType(RunRemainingTasks);
     BooleanType(DetachThreads);
+    BooleanType(WorkStealing);
+    BooleanType(PhysicalCoresOnly);
+
+    /// The priority classes of tasks. Tasks of a higher priority are started before tasks
+    /// of a lower priority, unless the lower priority tasks have been passed over too
+    /// often (see StarvationLimit)
+    enum class Priority {
+        High = 0,
+        Normal,
+        Low
+    };
+
+    /// The number of times that tasks of a lower priority can be passed over in favor of
+    /// higher priority tasks before one of them is started regardless
+    static constexpr const int StarvationLimit = 16;
+
+    /// Additional options that control when a task is started
+    struct TaskOptions {
+        TaskOptions(Priority taskPriority = Priority::Normal,
+            std::optional<std::chrono::steady_clock::time_point> taskDeadline =
+                std::nullopt);
+
+        /// The priority class of the task
+        Priority priority;
+        /// If a deadline is provided, the task is started before all tasks without a
+        /// deadline, and tasks with deadlines are started in the order of their
+        /// deadlines (earliest deadline first). The \c priority is ignored for these
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+    };
+
+    /// Determines on which logical CPUs the Worker%s of a ThreadPool are running
+    struct Placement {
+        /// The strategy that determines how the Worker%s are distributed across the
+        /// groups of cores that share the last-level cache
+        enum class Strategy {
+            /// The Worker%s are not pinned and the operating system is free to move them
+            None = 0,
+            /// Consecutive Worker%s are placed in different cache groups, which gives
+            /// each Worker as much cache as possible
+            Spread,
+            /// The Worker%s fill one cache group before the next one is used, which is
+            /// preferable for Worker%s that work on shared data
+            Compact
+        };
+
+        Placement(Strategy placementStrategy = Strategy::None,
+            PhysicalCoresOnly physicalCores = PhysicalCoresOnly::Yes,
+            std::vector<int> excluded = std::vector<int>());
+
+        /**
+         * Returns the logical CPUs for each Worker according to this Placement. The
+         * Worker with index \c i is pinned to the CPUs at index \c i modulo the number
+         * of returned sets.
+         *
+         * \param topology The topology of the available CPUs
+         * \return One set of logical CPUs for each Worker or an empty list if the
+         *         Worker%s should not be pinned
+         */
+        std::vector<std::vector<int>> workerCpus(
+            const thread::CpuTopology& topology) const;
+
+        /// The strategy that determines the order in which CPUs are assigned
+        Strategy strategy;
+        /// If PhysicalCoresOnly::Yes, each Worker is assigned to a separate physical core
+        /// and can run on all hardware threads of that core. A physical core is skipped
+        /// if any of its hardware threads is excluded. If PhysicalCoresOnly::No, each
+        /// Worker is pinned to a single logical CPU, using the first hardware thread of
+        /// every core before the second one
+        PhysicalCoresOnly physicalCoresOnly;
+        /// The indices of logical CPUs that are not used for any Worker, for example the
+        /// CPU that the rendering thread is running on
+        std::vector<int> excludedCpus;
+    };
+
+    /// Statistics about how long it took sleeping Worker%s to wake up after they were
+    /// notified about a new task
+    struct WakeStatistics {
+        /// The number of times a sleeping Worker was woken up
+        uint64_t nWakeups = 0;
+        /// The sum of the latencies of all wake-ups
+        std::chrono::nanoseconds totalLatency = std::chrono::nanoseconds(0);
+        /// The largest latency of a single wake-up
+        std::chrono::nanoseconds maxLatency = std::chrono::nanoseconds(0);
+    };
+
+    /// A histogram of durations whose buckets grow exponentially, which covers the range
+    /// from nanoseconds to seconds with a fixed number of buckets
+    struct Histogram {
+        /// The number of buckets in the histogram
+        static constexpr const int NBuckets = 32;
+
+        /**
+         * Returns the average of all durations in the histogram.
+         *
+         * \return The average of all durations or 0 if the histogram is empty
+         */
+        std::chrono::nanoseconds mean() const;
+
+        /**
+         * Returns an upper bound for the duration below which the \p fraction of all
+         * durations in the histogram lie. The result is exact up to a factor of two.
+         *
+         * \param fraction The fraction of durations, for example 0.99 for the 99th
+         *        percentile
+         * \return The upper bound of the bucket that contains the percentile, but never
+         *         more than the largest duration
+         * \pre \p fraction must be between 0 and 1
+         */
+        std::chrono::nanoseconds percentile(double fraction) const;
+
+        /// The bucket \c i counts the durations that are at least 2^i and less than
+        /// 2^(i+1) nanoseconds. The first bucket also contains durations that are shorter
+        /// than one nanosecond and the last bucket contains all longer durations
+        std::array<uint64_t, NBuckets> buckets = {};
+        /// The total number of durations in the histogram
+        uint64_t count = 0;
+        /// The sum of all durations in the histogram
+        std::chrono::nanoseconds total = std::chrono::nanoseconds(0);
+        /// The largest duration in the histogram
+        std::chrono::nanoseconds max = std::chrono::nanoseconds(0);
+    };
+
+    /// The statistics about a single Worker as part of the Statistics
+    struct WorkerStatistics {
+        /// The time the Worker spent executing tasks
+        std::chrono::nanoseconds busyTime = std::chrono::nanoseconds(0);
+        /// The time the Worker spent looking for or waiting for tasks
+        std::chrono::nanoseconds idleTime = std::chrono::nanoseconds(0);
+        /// The number of tasks that were executed by the Worker
+        uint64_t nTasks = 0;
+        /// The number of tasks that the Worker stole from other Worker%s
+        uint64_t nSteals = 0;
+        /// The number of times the Worker was woken up after sleeping
+        uint64_t nWakeups = 0;
+        /// The largest number of tasks in the Worker's own queue in the work-stealing
+        /// mode
+        int peakQueueDepth = 0;
+    };
+
+    /// A snapshot of the statistics that are collected while #isStatisticsEnabled
+    struct Statistics {
+        /// The time between queueing a task and the start of its execution
+        Histogram queueWait;
+        /// The execution time of the tasks
+        Histogram execution;
+        /// The statistics of each of the current Worker%s in the same order as they were
+        /// created
+        std::vector<WorkerStatistics> workers;
+        /// The number of tasks that were executed by all Worker%s, including the Worker%s
+        /// that have been removed by #resize
+        uint64_t nTasks = 0;
+        /// The number of tasks that were stolen by all Worker%s
+        uint64_t nSteals = 0;
+        /// The number of times any Worker was woken up after sleeping
+        uint64_t nWakeups = 0;
+        /// The largest number of tasks that were waiting in the shared queue at the same
+        /// time
+        int peakQueueDepth = 0;
+    };
 
     /**
      * Constructor that initializes and starts \p nThreads Worker objects.
@@ -118,6 +326,10 @@ public:
      *        the ThreadPool
      * \param bg Whether the worker threads managed by this thread pool are run in a
      *        background mode (depending on the support of the operating system)
+     * \param workStealing If WorkStealing::Yes, each Worker uses its own queue for the
+     *        tasks that are queued from inside that Worker and idle Worker%s steal tasks
+     *        from the others. If WorkStealing::No, all tasks are placed in a single
+     *        shared queue and are started in strict FIFO order
      * \pre \p nThreads must be bigger than 0
      * \pre \p workerInit must not be empty
      * \pre \p workerDeinit must not be empty
@@ -129,7 +341,8 @@ public:
         std::function<void ()> workerDeinit = [](){},
         thread::ThreadPriorityClass tpc = thread::ThreadPriorityClass::Normal,
         thread::ThreadPriorityLevel tpl = thread::ThreadPriorityLevel::Normal,
-        thread::Background bg = thread::Background::No);
+        thread::Background bg = thread::Background::No,
+        WorkStealing workStealing = WorkStealing::No);
 
     /**
      * Destructor that will block and wait for all remaining Tasks to be finished if the
@@ -206,11 +419,109 @@ public:
 
     /**
      * Returns the number of remaining tasks waiting to be processed by this ThreadPool.
+     * In the work-stealing mode, the tasks in the Worker%s' queues are included, which
+     * makes the returned value approximate if the ThreadPool is running.
      *
      * \return The number of remaining tasks waiting to be processed by this ThreadPool
      */
     int remainingTasks() const;
 
+    /**
+     * Returns whether this ThreadPool was created in the work-stealing mode.
+     *
+     * \return Whether this ThreadPool was created in the work-stealing mode
+     */
+    bool isWorkStealing() const;
+
+    /**
+     * Returns the statistics about the time it took sleeping Worker%s to wake up after
+     * they were notified about a new task. Only notifications that actually woke up a
+     * sleeping Worker are counted.
+     *
+     * \return The statistics about the wake-up latency of the Worker%s
+     */
+    WakeStatistics wakeStatistics() const;
+
+    /**
+     * Resets the statistics that are returned by #wakeStatistics.
+     */
+    void resetWakeStatistics();
+
+    /**
+     * Enables or disables the collection of the Statistics. The statistics are disabled
+     * by default, in which case the only overhead is checking the flag once per task.
+     * Tasks that were queued while the collection was disabled are not included in the
+     * queue-wait Histogram.
+     *
+     * \param enabled Whether the Statistics should be collected
+     */
+    void setStatisticsEnabled(bool enabled);
+
+    /**
+     * Returns whether the Statistics are currently being collected.
+     *
+     * \return Whether the Statistics are currently being collected
+     */
+    bool isStatisticsEnabled() const;
+
+    /**
+     * Returns a snapshot of the Statistics that were collected since the last call to
+     * #resetStatistics. As the Worker%s keep updating their values while the snapshot is
+     * taken, the values are only approximately consistent with each other while the
+     * ThreadPool is running. The peak queue depth of the shared queue is tracked even if
+     * the collection is disabled.
+     *
+     * \return A snapshot of the collected Statistics
+     */
+    Statistics statistics() const;
+
+    /**
+     * Resets all values of the Statistics, including the ones of the Worker%s that have
+     * been removed by #resize.
+     */
+    void resetStatistics();
+
+    /**
+     * Pins the Worker%s of this ThreadPool to the logical CPUs according to the
+     * \p placement, using the thread::CpuTopology that is detected at this point. The
+     * running Worker%s are moved immediately and the Worker%s that are created later
+     * (through #resize or #start) are placed in the same way. If a Worker can not be
+     * pinned, a warning is logged and it continues to run unpinned.
+     *
+     * \param placement The placement of the Worker%s
+     */
+    void setPlacement(Placement placement);
+
+    /**
+     * Returns the placement of the Worker%s that was set with #setPlacement.
+     *
+     * \return The placement of the Worker%s
+     */
+    const Placement& placement() const;
+
+    /**
+     * Removes the task with the provided \p id from the waiting list if it has not been
+     * started yet. The TaskFuture of the task receives a RuntimeError. Tasks that were
+     * queued by a Worker in the work-stealing mode can not be cancelled.
+     *
+     * \param id The identifier of the task as returned by TaskFuture::taskId
+     * \return <code>true</code> if the task was removed, <code>false</code> if it was
+     *         not found because it has already been started or finished
+     */
+    bool cancel(TaskId id);
+
+    /**
+     * Changes the Priority of the task with the provided \p id if it has not been started
+     * yet. Tasks with a deadline and tasks that were queued by a Worker in the
+     * work-stealing mode are not affected.
+     *
+     * \param id The identifier of the task as returned by TaskFuture::taskId
+     * \param priority The new priority of the task
+     * \return <code>true</code> if the priority of the task was changed,
+     *         <code>false</code> if the task was not found
+     */
+    bool reprioritize(TaskId id, Priority priority);
+
     /**
      * Removes the remaining tasks from the waiting list, discarding them.
      *
@@ -285,16 +596,261 @@ ghoul::ThreadPool pool(2);
     auto queue(std::packaged_task<T>&& task, Args&&... arguments)
         -> decltype(task.get_future());
 
+    /**
+     * This function behaves like the other #queue function, but the task is started
+     * according to the passed \p options instead of in FIFO order.
+     *
+     * \param options The priority and optional deadline of the task
+     * \param function The function that will be called
+     * \param arguments The potential list of arguments passed to the \p function
+     * \return A future containing the result of the evaluation of \p function with the
+     *         passed \p arguments
+     */
+    template <typename Function, typename... Args>
+    auto queue(TaskOptions options, Function&& function, Args&&... arguments)
+        -> std::future<decltype(function(arguments...))>;
+
+    /**
+     * This function queues a task and returns a TaskFuture that holds the return value of
+     * the \p function. In contrast to #queue, the \p function and its \p arguments are
+     * stored inline in the queued Task if they are small enough and the TaskFuture uses a
+     * recycled shared state, so in the common case, no memory is allocated. Exceptions
+     * that are thrown by the \p function are rethrown by TaskFuture::get.
+     *
+     * \tparam Function The type of the \p function that will be called
+     * \tparam Args A variable list of arguments that can be passed to the \p function
+     * \param function The function that will be called
+     * \param arguments The potential list of arguments passed to the \p function. The
+     *        arguments are copied or moved into the Task
+     * \return A TaskFuture containing the result of the evaluation of \p function with
+     *         the passed \p arguments
+     */
+    template <typename Function, typename... Args>
+    auto submit(Function&& function, Args&&... arguments)
+        -> TaskFuture<
+               std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>
+           >;
+
+    /// The result of #submitBulk
+    template <typename T>
+    struct BulkSubmission {
+        /// One TaskFuture for each of the submitted tasks in the same order
+        std::vector<TaskFuture<T>> futures;
+        /// Becomes ready when all of the submitted tasks have finished, regardless of
+        /// whether they returned a value or threw an exception
+        TaskFuture<void> done;
+    };
+
+    /**
+     * Submits all functions in the range [\p begin, \p end) at once. All tasks are
+     * pushed into the shared queue while it is locked only once, and the number of
+     * sleeping Worker%s that is needed to process the tasks is woken up with a single
+     * notification, which is considerably faster than calling #submit for each of the
+     * functions. The functions are copied from the range; use a
+     * <code>std::move_iterator</code> to move them instead.
+     *
+     * \tparam Iterator The type of the iterator, whose values must be callable without
+     *         arguments
+     * \param begin The iterator pointing to the first function
+     * \param end The iterator pointing past the last function
+     * \param options The priority and optional deadline that are used for all tasks
+     * \return The TaskFuture%s of the individual tasks and a combined TaskFuture that
+     *         becomes ready when all tasks have finished
+     */
+    template <typename Iterator>
+    auto submitBulk(Iterator begin, Iterator end, TaskOptions options = TaskOptions())
+        -> BulkSubmission<std::invoke_result_t<
+               typename std::iterator_traits<Iterator>::value_type&
+           >>;
+
+    /**
+     * This function behaves like the other #submit function, but the task is started
+     * according to the passed \p options instead of in FIFO order.
+     *
+     * \param options The priority and optional deadline of the task
+     * \param function The function that will be called
+     * \param arguments The potential list of arguments passed to the \p function
+     * \return A TaskFuture containing the result of the evaluation of \p function with
+     *         the passed \p arguments
+     */
+    template <typename Function, typename... Args>
+    auto submit(TaskOptions options, Function&& function, Args&&... arguments)
+        -> TaskFuture<
+               std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>
+           >;
+
+    /**
+     * This function behaves like #submit, but the task is only queued after all of the
+     * \p dependencies have finished. No thread is blocked while waiting for the
+     * \p dependencies; instead, the thread that finishes the last dependency queues the
+     * task. The task is queued regardless of whether the dependencies have finished with
+     * a value or with an exception, which can be inspected through their TaskFuture%s.
+     * Together with TaskFuture::then, this allows building graphs of tasks that keep the
+     * Worker%s busy without any of them waiting for a result. The ThreadPool must stay
+     * alive until all dependencies have finished.
+     *
+     * \tparam Function The type of the \p function that will be called
+     * \tparam Args A variable list of arguments that can be passed to the \p function
+     * \param dependencies The tasks that have to finish before the task is queued
+     * \param function The function that will be called
+     * \param arguments The potential list of arguments passed to the \p function
+     * \return A TaskFuture containing the result of the evaluation of \p function with
+     *         the passed \p arguments
+     */
+    template <typename Function, typename... Args>
+    auto submitAfter(std::vector<TaskDependency> dependencies, Function&& function,
+        Args&&... arguments)
+        -> TaskFuture<
+               std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>
+           >;
+
+    /**
+     * Calls the \p function for every index in the range [\p begin, \p end) in
+     * parallel and returns after all calls have finished. The range is split into chunks
+     * that start large and become smaller towards the end of the range, but that never
+     * contain fewer than \p grainSize indices. The calling thread participates in the
+     * work, so this function can also be called from inside a task of this ThreadPool
+     * without deadlocking. The remaining chunks are distributed among the idle Worker%s,
+     * but if none of them becomes available, the calling thread processes all chunks on
+     * its own.
+     *
+     * If any call to the \p function throws an exception, the remaining chunks are
+     * skipped and the first exception is rethrown to the caller after all calls that are
+     * already running have finished.
+     *
+     * \tparam Index The integral type of the indices
+     * \tparam Function The type of the \p function, which must be callable with a single
+     *         Index
+     * \param begin The first index of the range
+     * \param end The index past the last index of the range
+     * \param grainSize The minimum number of indices that are processed in one chunk
+     * \param function The function that is called for each index
+     * \pre \p grainSize must be positive
+     */
+    template <typename Index, typename Function>
+    void parallelFor(Index begin, Index end, Index grainSize, Function&& function);
+
+    /**
+     * The awaitable that is returned by #schedule. The coroutine handle type is a
+     * template parameter, so this class can be declared without requiring C++20.
+     */
+    class ScheduleOperation {
+    public:
+        /// Always returns <code>false</code> as the coroutine always has to be moved
+        bool await_ready() const noexcept;
+
+        /// Queues the resumption of the suspended coroutine as a task
+        template <typename Handle>
+        void await_suspend(Handle handle);
+
+        void await_resume() const noexcept;
+
+    private:
+        friend class ThreadPool;
+        explicit ScheduleOperation(ThreadPool& pool);
+
+        ThreadPool& _pool;
+    };
+
+    /**
+     * Returns an awaitable that continues the awaiting coroutine on one of the Worker%s
+     * of this ThreadPool. The coroutine is suspended and its resumption is queued like
+     * any other task, so the thread that executed <code>co_await pool.schedule()</code>
+     * is free to continue with other work:
+     * \verbatim
+ghoul::CoroutineTask<int> compute(ghoul::ThreadPool& pool) {
+    co_await pool.schedule();
+    // Everything from here on runs on one of the Worker%s
+    co_return 1337;
+}
+\endverbatim
+     *
+     * \return The awaitable that moves the awaiting coroutine to this ThreadPool
+     */
+    ScheduleOperation schedule();
+
+    /**
+     * Computes the values of the \p function for every index in the range
+     * [\p begin, \p end) in parallel and combines them using the \p reduce function.
+     * The work is split and distributed in the same way as in #parallelFor. As the
+     * values are combined in an unspecified order, the \p reduce function has to be
+     * associative and commutative and the \p identity must not change a value it is
+     * combined with.
+     *
+     * \tparam Index The integral type of the indices
+     * \tparam T The type of the values that are reduced
+     * \tparam Function The type of the \p function, which must be callable with a single
+     *         Index and return a value that is convertible to T
+     * \tparam Reduce The type of the \p reduce function, which must be callable with
+     *         two values of type T and return a value of type T
+     * \param begin The first index of the range
+     * \param end The index past the last index of the range
+     * \param grainSize The minimum number of indices that are processed in one chunk
+     * \param identity The identity element of the \p reduce function
+     * \param function The function that is called for each index
+     * \param reduce The function that combines two values
+     * \return The combination of all values returned by the \p function, or
+     *         \p identity if the range is empty
+     * \pre \p grainSize must be positive
+     */
+    template <typename Index, typename T, typename Function, typename Reduce>
+    T parallelReduce(Index begin, Index end, Index grainSize, T identity,
+        Function&& function, Reduce&& reduce);
+
 private:
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool(ThreadPool&&) = delete;
     ThreadPool& operator=(const ThreadPool&) = delete;
     ThreadPool& operator=(ThreadPool&&) = delete;
 
-    /// A single task that is executed. This is a functional wrapper around the function +
-    /// arguments that are passed in the queue method so that we can store all tasks in a
-    /// single list
-    using Task = std::function<void()>;
+    /// A Task in one of the Worker%s' own queues together with the point in time when it
+    /// was queued
+    struct QueuedTask {
+        Task task;
+        std::chrono::steady_clock::time_point enqueueTime;
+    };
+
+    /// The queue that each Worker owns in the work-stealing mode
+    using LocalQueue = WorkStealingQueue<QueuedTask>;
+
+    /// The counters of a Histogram, which are written only by the Worker they belong to
+    /// but can be read by any thread
+    struct HistogramCounters {
+        void add(std::chrono::nanoseconds duration);
+        void addTo(Histogram& histogram) const;
+        void reset();
+
+        std::array<std::atomic<uint64_t>, Histogram::NBuckets> buckets = {};
+        std::atomic<uint64_t> total = 0;
+        std::atomic<uint64_t> max = 0;
+    };
+
+    /// The statistics of a single Worker. Each Worker has its own counters on a separate
+    /// cache line so that the Workers do not compete for them
+    struct alignas(64) WorkerCounters {
+        void addTo(Statistics& statistics) const;
+        WorkerStatistics snapshot() const;
+        void reset();
+
+        HistogramCounters queueWait;
+        HistogramCounters execution;
+        std::atomic<uint64_t> busyTime = 0;
+        std::atomic<uint64_t> idleTime = 0;
+        std::atomic<uint64_t> nTasks = 0;
+        std::atomic<uint64_t> nSteals = 0;
+        std::atomic<uint64_t> nWakeups = 0;
+        std::atomic_int peakQueueDepth = 0;
+    };
+
+    /// The state of the Statistics collection that is shared with the Worker%s
+    struct StatisticsState {
+        std::atomic_bool isEnabled = false;
+        /// Protects the \c retired list
+        std::mutex mutex;
+        /// The counters of Workers that were removed by #resize, which are still
+        /// included in the Statistics until they are reset
+        std::vector<std::shared_ptr<WorkerCounters>> retired;
+    };
 
     /// A worker object that consists of a thread and a boolean flag that determines
     /// whether the worker should terminatate (or rather return out of the infinite loop).
@@ -307,32 +863,194 @@ private:
         // a new task. This is stored as a shared_pointer as this value is used in the
         // ThreadPool as well as the lambda expression that drives the thread.
         std::shared_ptr<std::atomic<bool>> shouldTerminate;
+        // The queue of tasks that were queued by this Worker. This is only used in the
+        // work-stealing mode and is nullptr otherwise
+        std::shared_ptr<LocalQueue> localQueue;
+        // The statistics of this Worker. These are kept when the ThreadPool is stopped so
+        // that they continue when it is started again
+        std::shared_ptr<WorkerCounters> statistics;
+    };
+
+    /// The list of all LocalQueue%s that are owned by running Worker%s and from which
+    /// idle Worker%s can steal tasks. The list is only changed when Workers are started
+    /// or finished and the Workers keep a copy of the list that they update whenever the
+    /// \c version changes
+    struct LocalQueueRegistry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<LocalQueue>> queues;
+        std::atomic_int version = 0;
+    };
+
+    /// Information about the Worker that is running on the current thread
+    struct WorkerContext {
+        /// The shared queue of the ThreadPool that the Worker belongs to
+        const void* pool = nullptr;
+        /// The Worker's own queue, if the ThreadPool is in the work-stealing mode
+        LocalQueue* localQueue = nullptr;
+        /// The Worker's statistics
+        WorkerCounters* statistics = nullptr;
+    };
+
+    /**
+     * This class implements an eventcount that lets Worker%s sleep without missing any
+     * wake-ups and without having to poll regularly. A Worker that wants to sleep first
+     * announces this by calling #prepareWait, then checks all queues for a task one final
+     * time, and only then goes to sleep by calling #commitWait with the key that was
+     * returned from #prepareWait. If any task was queued after the call to #prepareWait,
+     * the corresponding call to #notify has changed the key and #commitWait will return
+     * immediately. If a task was found instead, the Worker has to call #cancelWait.
+     *
+     * In addition, the EventCount measures the time between a notification and the
+     * point at which a sleeping Worker has actually woken up.
+     */
+    class EventCount {
+    public:
+        using Key = uint64_t;
+
+        /**
+         * Registers the calling thread as a waiter and returns the key that has to be
+         * passed to #commitWait.
+         *
+         * \return The key that has to be passed to #commitWait
+         */
+        Key prepareWait();
+
+        /**
+         * Unregisters the calling thread as a waiter after it did not go to sleep.
+         *
+         * \pre #prepareWait must have been called before
+         */
+        void cancelWait();
+
+        /**
+         * Puts the calling thread to sleep until a notification was sent after the
+         * \p key was retrieved. Returns immediately if that has already happened.
+         *
+         * \param key The key that was returned by the previous call to #prepareWait
+         * \pre #prepareWait must have been called before
+         * \return <code>true</code> if the thread actually went to sleep
+         */
+        bool commitWait(Key key);
+
+        /**
+         * Wakes up one waiting thread, if there is any. This function is cheap if no
+         * thread is waiting.
+         */
+        void notify();
+
+        /**
+         * Wakes up to \p count waiting threads. If there are fewer waiting threads, all
+         * of them are woken up.
+         *
+         * \param count The maximum number of threads to wake up
+         */
+        void notifyMany(int count);
+
+        /**
+         * Wakes up all waiting threads.
+         */
+        void notifyAll();
+
+        /**
+         * Returns the statistics about the wake-up latency of the waiting threads.
+         *
+         * \return The statistics about the wake-up latency of the waiting threads
+         */
+        WakeStatistics statistics() const;
+
+        /**
+         * Resets the statistics about the wake-up latency.
+         */
+        void resetStatistics();
+
+    private:
+        void notify(int count);
+
+        // Changed with every notification that happens while there are waiters
+        std::atomic<Key> _epoch = 0;
+        // The number of threads that are between #prepareWait and #commitWait or
+        // #cancelWait
+        std::atomic_int _nWaiters = 0;
+
+        // The mutex and condition variable used for the actual sleeping. The mutex also
+        // protects the values below
+        mutable std::mutex _mutex;
+        std::condition_variable _cv;
+
+        // The point in time at which the last notification was sent
+        std::chrono::steady_clock::time_point _notifyTime;
+        WakeStatistics _statistics;
     };
 
     /**
-     * This class represents a thin wrapper around <code>std::queue</code> that provides
-     * <code>std::mutex</code> protection for the available methods, thus making them
-     * thread-safe to use. As soon as there is a better adapter pattern for the STL
-     * classes that works in a concurrent environment, this class is not needed anymore.
+     * This class represents the shared queue of Task%s, which is protected by a
+     * <code>std::mutex</code>, thus making the available methods thread-safe to use.
+     * Tasks are kept in a separate ring buffer for each Priority plus a heap that orders
+     * the tasks that have a deadline. The buffers grow when they are full but never
+     * shrink, so after a warm-up phase, pushing and popping Task%s does not allocate any
+     * memory.
      */
     class TaskQueue {
     public:
         /**
-         * Returns the top element of the queue and whether this item existed. If the
+         * Returns the next element of the queue and whether this item existed. If the
          * queue was empty, <code>{ Task(), false}</code> is returned, otherwise the
-         * second argument to the <code>tuple</code> is <code>true</code>.
+         * second argument to the <code>tuple</code> is <code>true</code>. Tasks with a
+         * deadline are returned first, followed by the tasks in the order of their
+         * Priority, unless a lower Priority has been passed over StarvationLimit times.
          *
-         * \return A tuple containing either the top element of the queue and
+         * \param enqueueTime If this is not <code>nullptr</code>, it receives the point
+         *        in time at which the returned Task was pushed
+         * \return A tuple containing either the next element of the queue and
          *         <code>true</code>, or a default constructed Task and <code>false</code>
          */
-        std::tuple<Task, bool> pop();
+        std::tuple<Task, bool> pop(
+            std::chrono::steady_clock::time_point* enqueueTime = nullptr);
 
         /**
-         * Pushes the \p task to the bottom of the <code>std::queue</code>.
+         * Pushes the \p task to the bottom of the queue that corresponds to the
+         * \p options.
          *
          * \param task The task to be pushed onto the queue
+         * \param options The priority and deadline of the \p task
+         * \param id The identifier of the \p task
+         * \param enqueueTime The point in time at which the \p task was queued
+         */
+        void push(Task&& task, const TaskOptions& options, TaskId id,
+            std::chrono::steady_clock::time_point enqueueTime);
+
+        /**
+         * Pushes all of the \p tasks to the bottom of the queue that corresponds to the
+         * \p options while locking the queue only once.
+         *
+         * \param tasks The tasks to be pushed onto the queue
+         * \param options The priority and deadline of all \p tasks
+         * \param firstId The identifier of the first of the \p tasks. The following
+         *        tasks have consecutive identifiers
+         * \param enqueueTime The point in time at which the \p tasks were queued
+         */
+        void pushMany(std::vector<Task>&& tasks, const TaskOptions& options,
+            TaskId firstId, std::chrono::steady_clock::time_point enqueueTime);
+
+        /**
+         * Removes the task with the provided \p id from the queue and returns it in
+         * \p task. The task is returned so that it is not destroyed while the queue is
+         * locked.
+         *
+         * \param id The identifier of the task
+         * \param task The removed task
+         * \return <code>true</code> if the task was found
+         */
+        bool extract(TaskId id, Task& task);
+
+        /**
+         * Moves the task with the provided \p id to the queue of the \p priority.
+         *
+         * \param id The identifier of the task
+         * \param priority The new priority of the task
+         * \return <code>true</code> if the task was found
          */
-        void push(Task&& task);
+        bool reprioritize(TaskId id, Priority priority);
 
         /**
          * Returns whether the queue is empty.
@@ -348,14 +1066,138 @@ private:
          */
         int size() const;
 
+        /**
+         * Returns the largest size the queue had since the last call to #resetPeakSize.
+         *
+         * \return The largest size of the queue
+         */
+        int peakSize() const;
+
+        /**
+         * Resets the largest size of the queue to its current size.
+         */
+        void resetPeakSize();
+
     private:
-        // The queue of tasks
-        std::queue<ThreadPool::Task> _queue;
+        struct Entry {
+            Task task;
+            TaskId id = 0;
+            std::chrono::steady_clock::time_point deadline;
+            std::chrono::steady_clock::time_point enqueueTime;
+        };
+
+        /// Updates the largest size of the queue. The mutex must be locked
+        void updatePeakSize();
+
+        /// A FIFO queue of Entry%s whose storage is reused
+        class RingBuffer {
+        public:
+            void push(Entry&& entry);
+            Entry pop();
+            Entry erase(size_t i);
+            Entry& operator[](size_t i);
+            size_t size() const;
+
+        private:
+            // The storage of the ring buffer, whose size is always a power of two
+            std::vector<Entry> _buffer;
+            // The index of the top element in the buffer
+            size_t _head = 0;
+            // The number of Entries in the buffer
+            size_t _size = 0;
+        };
+
+        // One queue for each Priority
+        std::array<RingBuffer, 3> _queues;
+        // The number of times each queue has been passed over while it was not empty
+        std::array<int, 3> _nSkipped = { 0, 0, 0 };
+        // A min-heap of the tasks that have a deadline
+        std::vector<Entry> _deadlines;
+        // The largest number of tasks that were in the queue at the same time
+        size_t _peakSize = 0;
+
         // The mutex protecting the queue. As the mutex is also required by const
         // functions, it is declared 'mutable'
         mutable std::mutex _queueMutex;
     };
 
+    /**
+     * Places the \p task in the queue that is appropriate for the calling thread and
+     * notifies a waiting Worker. If the ThreadPool is in the work-stealing mode and this
+     * function is called from one of its Worker%s, the \p task is pushed to that Worker's
+     * LocalQueue, otherwise it is pushed to the shared TaskQueue. Tasks that do not have
+     * the default \p options are always pushed to the shared TaskQueue.
+     *
+     * \param task The task that is queued
+     * \param options The priority and deadline of the \p task
+     * \param id The identifier of the \p task
+     */
+    void enqueue(Task&& task, const TaskOptions& options, TaskId id);
+
+    /**
+     * Places the \p task with the default TaskOptions and without an identifier in the
+     * queue that is appropriate for the calling thread.
+     *
+     * \param task The task that is queued
+     */
+    void enqueue(Task&& task);
+
+    friend void internal::scheduleTask(ThreadPool* pool, Task&& task);
+
+    /// Returns a new unique identifier for a task
+    TaskId nextTaskId();
+
+    /// Returns the current time if the Statistics are collected and a default
+    /// constructed time point otherwise
+    std::chrono::steady_clock::time_point enqueueTime() const;
+
+    /**
+     * Calls the \p function and passes the result or the exception to the \p promise.
+     */
+    template <typename ReturnType, typename Function>
+    static void fulfill(TaskPromise<ReturnType>& promise, Function&& function);
+
+    /**
+     * Creates the Task that calls the \p function with the \p arguments and passes
+     * the result or the exception to the \p promise.
+     */
+    template <typename ReturnType, typename Function, typename... Args>
+    static Task makeTask(TaskPromise<ReturnType>&& promise, Function&& function,
+        Args&&... arguments);
+
+    /**
+     * Pushes all of the \p tasks into the shared TaskQueue and wakes up as many Worker%s
+     * as there are \p tasks.
+     *
+     * \param tasks The tasks that are queued
+     * \param options The priority and deadline of all \p tasks
+     * \param firstId The identifier of the first of the \p tasks
+     */
+    void enqueueBulk(std::vector<Task>&& tasks, const TaskOptions& options,
+        TaskId firstId);
+
+    /**
+     * Queues the \p task as soon as all of the \p dependencies have finished.
+     *
+     * \param dependencies The tasks that have to finish before \p task is queued
+     * \param task The task that is queued
+     */
+    void enqueueAfter(std::vector<TaskDependency> dependencies, Task&& task);
+
+    /**
+     * Splits the range [\p begin, \p end) into chunks and calls the \p function for
+     * each chunk with the first and the past-the-last index of that chunk. The calling
+     * thread participates and this function returns after all chunks have been
+     * processed. This is the shared implementation of #parallelFor and #parallelReduce.
+     *
+     * \param begin The first index of the range
+     * \param end The index past the last index of the range
+     * \param grainSize The minimum number of indices in a chunk
+     * \param function The function that is called for every chunk
+     */
+    void runChunked(int64_t begin, int64_t end, int64_t grainSize,
+        const std::function<void(int64_t, int64_t)>& function);
+
     /**
      * Activate the \p worker by creating a <code>std::thread</code> with the lambda
      * expression that will do all of the work inside the Worker. This function will
@@ -365,6 +1207,15 @@ private:
      */
     void activateWorker(Worker& worker);
 
+    /**
+     * Pins the \p workerThread of the Worker with the \p index to its CPUs according to
+     * the current Placement, if there is any.
+     *
+     * \param workerThread The thread of the Worker
+     * \param index The index of the Worker in the list of Worker%s
+     */
+    void applyPlacement(std::thread& workerThread, size_t index);
+
     /// The list of all workers managed by this ThreadPool
     std::vector<Worker> _workers;
 
@@ -378,16 +1229,21 @@ private:
     /// The number of Worker%s that are currently waiting for a task
     std::shared_ptr<std::atomic_int> _nWaiting;
 
-    /// This mutex guards pushing to the queue
-    std::mutex _queueMutex;
+    /// The identifier that is given to the next task that is submitted
+    std::atomic<TaskId> _nextTaskId = 1;
 
-    /// The mutex used by the <code>condition_variable</code> <code>_cv</code> used to
-    /// wait for and wake up Worker%s based on incoming Task%s
-    std::shared_ptr<std::mutex> _mutex;
+    /// The Worker%s' own queues that can be stolen from in the work-stealing mode
+    std::shared_ptr<LocalQueueRegistry> _localQueues;
 
-    /// The condition variable that is used to wake up Worker%s when new Task%s are
-    /// incoming. Used in combination with <code>_mutex</code>
-    std::shared_ptr<std::condition_variable> _cv;
+    /// The Worker that is running on the current thread, if any
+    static thread_local WorkerContext _currentWorker;
+
+    /// The EventCount that is used to put idle Worker%s to sleep and to wake them up
+    /// when new Task%s are incoming
+    std::shared_ptr<EventCount> _eventCount;
+
+    /// The state of the Statistics collection that is shared with the Worker%s
+    std::shared_ptr<StatisticsState> _statistics;
 
     /// The user-defined function that is called at initialization for each of the Worker
     /// threads
@@ -404,6 +1260,13 @@ private:
     /// Whether all Worker%s of this ThreadPool are started in the background mode
     /// (if supported by the operating system)
     thread::Background _threadBackground;
+    /// Whether this ThreadPool is running in the work-stealing mode
+    WorkStealing _workStealing;
+
+    /// The placement of the Worker%s
+    Placement _placement;
+    /// The logical CPUs for each Worker as determined by the \c _placement
+    std::vector<std::vector<int>> _workerCpus;
 };
 
 } // namespace ghoul
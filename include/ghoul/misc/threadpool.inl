@@ -23,31 +23,36 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
+#include <ghoul/misc/assert.h>
 #include <functional>
+#include <tuple>
+#include <type_traits>
 
 namespace ghoul {
 
 template <typename F, typename... Arg>
 auto ThreadPool::queue(F&& f, Arg&&... arg) -> std::future<decltype(f(arg...))> {
-    using ReturnType = decltype(f(arg...));
-
-    std::lock_guard guard(_queueMutex);
-    // We wrap the packaged_task into a shared pointer so that we can store it in the
-    // lambda expression below. The capture of the lambda expression will keep this
-    // packaged_task alive
-    auto pck = std::make_shared<std::packaged_task<ReturnType ()>>(
-        std::bind(std::forward<F>(f), std::forward<Arg>(arg)...)
-    );
+    return queue(TaskOptions(), std::forward<F>(f), std::forward<Arg>(arg)...);
+}
 
-    // Push the packaged packaged_task onto the queue of work items
-    _taskQueue->push([pck]() { (*pck)(); });
+template <typename Function, typename... Args>
+auto ThreadPool::queue(TaskOptions options, Function&& function, Args&&... arguments)
+    -> std::future<decltype(function(arguments...))>
+{
+    using ReturnType = decltype(function(arguments...));
+
+    // The packaged_task is move-only, which is fine as the Task will take ownership of it
+    std::packaged_task<ReturnType ()> pck(
+        std::bind(std::forward<Function>(function), std::forward<Args>(arguments)...)
+    );
 
     // Get the future of the result (which might be std::future<void>, but that is not a
     // problem
-    std::future<ReturnType> future = pck->get_future();
+    std::future<ReturnType> future = pck.get_future();
 
-    // Notify a potentially waiting thread that a new task is available
-    _cv->notify_one();
+    // Push the packaged packaged_task onto the queue of work items, which also notifies
+    // a potentially waiting thread that a new task is available
+    enqueue(Task(std::move(pck)), options, 0);
 
     // And return the future back to the caller
     return future;
@@ -59,16 +64,223 @@ template <typename T, typename... Args>
 auto ThreadPool::queue(std::packaged_task<T>&& task, Args&&... arguments)
     -> decltype(task.get_future())
 {
-    std::lock_guard guard(_queueMutex);
+    auto future = task.get_future();
+
+    enqueue(Task(
+        [pck = std::move(task), args = std::make_tuple(std::forward<Args>(arguments)...)]
+        () mutable
+        {
+            std::apply(pck, std::move(args));
+        }
+    ));
+
+    return future;
+}
+
+template <typename Function, typename... Args>
+auto ThreadPool::submit(Function&& function, Args&&... arguments)
+    -> TaskFuture<std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>>
+{
+    return submit(
+        TaskOptions(),
+        std::forward<Function>(function),
+        std::forward<Args>(arguments)...
+    );
+}
+
+template <typename Function, typename... Args>
+auto ThreadPool::submit(TaskOptions options, Function&& function, Args&&... arguments)
+    -> TaskFuture<std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>>
+{
+    using ReturnType = std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>;
+
+    const TaskId id = nextTaskId();
+
+    TaskPromise<ReturnType> promise;
+    promise.setPool(this);
+    promise.setTaskId(id);
+    TaskFuture<ReturnType> future = promise.future();
+
+    enqueue(
+        makeTask(
+            std::move(promise),
+            std::forward<Function>(function),
+            std::forward<Args>(arguments)...
+        ),
+        options,
+        id
+    );
+
+    return future;
+}
 
-    auto pck = std::make_shared<std::packaged_task<T>>(std::move(task));
-    _taskQueue->push([pck]() { (*pck)(); });
+template <typename Function, typename... Args>
+auto ThreadPool::submitAfter(std::vector<TaskDependency> dependencies,
+                             Function&& function, Args&&... arguments)
+    -> TaskFuture<std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>>
+{
+    using ReturnType = std::invoke_result_t<std::decay_t<Function>, std::decay_t<Args>...>;
 
-    std::future<T> future = pck->get_future();
+    TaskPromise<ReturnType> promise;
+    promise.setPool(this);
+    TaskFuture<ReturnType> future = promise.future();
 
-    _cv->notify_one();
+    enqueueAfter(
+        std::move(dependencies),
+        makeTask(
+            std::move(promise),
+            std::forward<Function>(function),
+            std::forward<Args>(arguments)...
+        )
+    );
 
     return future;
 }
 
+template <typename Iterator>
+auto ThreadPool::submitBulk(Iterator begin, Iterator end, TaskOptions options)
+    -> BulkSubmission<std::invoke_result_t<
+           typename std::iterator_traits<Iterator>::value_type&
+       >>
+{
+    using Function = typename std::iterator_traits<Iterator>::value_type;
+    using ReturnType = std::invoke_result_t<Function&>;
+
+    // The last task to finish sets the combined result
+    struct Join {
+        std::atomic_int nRemaining;
+        TaskPromise<void> done;
+    };
+    auto join = std::make_shared<Join>();
+    join->done.setPool(this);
+
+    BulkSubmission<ReturnType> result;
+    result.done = join->done.future();
+
+    const size_t nTasks = static_cast<size_t>(std::distance(begin, end));
+    if (nTasks == 0) {
+        join->done.setValue();
+        return result;
+    }
+    join->nRemaining = static_cast<int>(nTasks);
+
+    const TaskId firstId = _nextTaskId.fetch_add(nTasks, std::memory_order_relaxed);
+
+    std::vector<Task> tasks;
+    tasks.reserve(nTasks);
+    result.futures.reserve(nTasks);
+    for (TaskId id = firstId; begin != end; ++begin, ++id) {
+        TaskPromise<ReturnType> promise;
+        promise.setPool(this);
+        promise.setTaskId(id);
+        result.futures.push_back(promise.future());
+
+        tasks.emplace_back(
+            [promise = std::move(promise), f = Function(*begin), join]() mutable {
+                fulfill(promise, f);
+                if (--join->nRemaining == 0) {
+                    join->done.setValue();
+                }
+            }
+        );
+    }
+
+    enqueueBulk(std::move(tasks), options, firstId);
+    return result;
+}
+
+template <typename ReturnType, typename Function>
+void ThreadPool::fulfill(TaskPromise<ReturnType>& promise, Function&& function) {
+    try {
+        if constexpr (std::is_void_v<ReturnType>) {
+            function();
+            promise.setValue();
+        }
+        else {
+            promise.setValue(function());
+        }
+    }
+    catch (...) {
+        promise.setException(std::current_exception());
+    }
+}
+
+template <typename ReturnType, typename Function, typename... Args>
+Task ThreadPool::makeTask(TaskPromise<ReturnType>&& promise, Function&& function,
+                          Args&&... arguments)
+{
+    // For small callable objects, the whole lambda expression fits into the inline
+    // storage of the Task, so no memory is allocated here
+    return Task(
+        [promise = std::move(promise), f = std::forward<Function>(function),
+         args = std::make_tuple(std::forward<Args>(arguments)...)]() mutable
+        {
+            fulfill(promise, [&f, &args]() { return std::apply(f, std::move(args)); });
+        }
+    );
+}
+
+template <typename Handle>
+void ThreadPool::ScheduleOperation::await_suspend(Handle handle) {
+    // The coroutine handle fits into the Task, so no memory is allocated. The awaiter
+    // lives in the coroutine frame, so we must not touch it after the coroutine might
+    // have been resumed
+    _pool.enqueue(Task([handle]() mutable { handle.resume(); }));
+}
+
+template <typename Index, typename Function>
+void ThreadPool::parallelFor(Index begin, Index end, Index grainSize,
+                             Function&& function)
+{
+    static_assert(std::is_integral_v<Index>, "Index must be an integral type");
+    ghoul_assert(grainSize > 0, "grainSize must be positive");
+
+    if (begin >= end) {
+        return;
+    }
+
+    runChunked(
+        static_cast<int64_t>(begin),
+        static_cast<int64_t>(end),
+        static_cast<int64_t>(grainSize),
+        [&function](int64_t chunkBegin, int64_t chunkEnd) {
+            for (int64_t i = chunkBegin; i < chunkEnd; ++i) {
+                function(static_cast<Index>(i));
+            }
+        }
+    );
+}
+
+template <typename Index, typename T, typename Function, typename Reduce>
+T ThreadPool::parallelReduce(Index begin, Index end, Index grainSize, T identity,
+                             Function&& function, Reduce&& reduce)
+{
+    static_assert(std::is_integral_v<Index>, "Index must be an integral type");
+    ghoul_assert(grainSize > 0, "grainSize must be positive");
+
+    if (begin >= end) {
+        return identity;
+    }
+
+    T result = identity;
+    std::mutex resultMutex;
+    runChunked(
+        static_cast<int64_t>(begin),
+        static_cast<int64_t>(end),
+        static_cast<int64_t>(grainSize),
+        [&](int64_t chunkBegin, int64_t chunkEnd) {
+            // Each chunk is reduced separately so that the lock is only taken once per
+            // chunk rather than once per index
+            T partial = identity;
+            for (int64_t i = chunkBegin; i < chunkEnd; ++i) {
+                partial = reduce(std::move(partial), function(static_cast<Index>(i)));
+            }
+
+            std::lock_guard lock(resultMutex);
+            result = reduce(std::move(result), std::move(partial));
+        }
+    );
+    return result;
+}
+
 } // namespace ghoul
@@ -0,0 +1,149 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___WORKSTEALINGQUEUE___H__
+#define __GHOUL___WORKSTEALINGQUEUE___H__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ghoul {
+
+/**
+ * This class is a lock-free double-ended queue of pointers that follows the
+ * Chase-Lev work-stealing algorithm as described in "Correct and Efficient Work-Stealing
+ * for Weak Memory Models" by Lê, Pop, Cohen, and Zappa Nardelli (2013). A single owner
+ * thread can #push and #pop items at the bottom end of the queue in LIFO order, while any
+ * number of other threads can #steal items from the top end of the queue in FIFO order.
+ * None of the operations acquire a lock.
+ *
+ * The queue grows automatically if the owner pushes more items than the current capacity
+ * allows. Previous storage arrays are retained until the queue is destroyed as other
+ * threads might still be reading from them.
+ *
+ * The queue does not own the pointed-to objects, with the exception of the destructor,
+ * which will <code>delete</code> all items that are remaining in the queue.
+ *
+ * \tparam T The type of the objects that are pointed to by the items in the queue
+ */
+template <typename T>
+class WorkStealingQueue {
+public:
+    /**
+     * Creates an empty queue with the initial \p capacity.
+     *
+     * \param capacity The initial number of items that can be stored in the queue
+     *
+     * \pre \p capacity must be a power of two
+     */
+    explicit WorkStealingQueue(int64_t capacity = 256);
+
+    /// Deletes all of the items that are remaining in the queue
+    ~WorkStealingQueue();
+
+    /**
+     * Pushes the \p item to the bottom of the queue. This function must only be called
+     * by the owner of the queue.
+     *
+     * \param item The item that is pushed to the queue
+     *
+     * \pre \p item must not be nullptr
+     */
+    void push(T* item);
+
+    /**
+     * Removes and returns the item from the bottom of the queue, which is the item that
+     * was pushed last. This function must only be called by the owner of the queue.
+     *
+     * \return The bottom item of the queue or <code>nullptr</code> if the queue was empty
+     */
+    T* pop();
+
+    /**
+     * Removes and returns the item from the top of the queue, which is the item that has
+     * been in the queue the longest. This function can be called from any thread. If
+     * another thread removes the same item concurrently, this function returns
+     * <code>nullptr</code> even if the queue still contains items.
+     *
+     * \return The top item of the queue or <code>nullptr</code> if the queue was empty or
+     *         the item was removed concurrently
+     */
+    T* steal();
+
+    /**
+     * Returns the approximate number of items in the queue. The returned value might be
+     * outdated as soon as it is returned if other threads access the queue concurrently.
+     *
+     * \return The approximate number of items in the queue
+     */
+    int size() const;
+
+    /**
+     * Returns whether the queue is (approximately) empty.
+     *
+     * \return Whether the queue is (approximately) empty
+     */
+    bool isEmpty() const;
+
+private:
+    WorkStealingQueue(const WorkStealingQueue&) = delete;
+    WorkStealingQueue(WorkStealingQueue&&) = delete;
+    WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+    WorkStealingQueue& operator=(WorkStealingQueue&&) = delete;
+
+    /// A circular array of atomic pointers whose capacity is a power of two
+    struct Array {
+        explicit Array(int64_t cap);
+
+        T* get(int64_t i) const;
+        void put(int64_t i, T* item);
+        Array* grow(int64_t bottom, int64_t top) const;
+
+        const int64_t capacity;
+        const int64_t mask;
+        std::unique_ptr<std::atomic<T*>[]> data;
+    };
+
+    /// The index of the top of the queue from which items are stolen
+    alignas(64) std::atomic<int64_t> _top = 0;
+
+    /// The index of the bottom of the queue at which the owner pushes and pops items
+    alignas(64) std::atomic<int64_t> _bottom = 0;
+
+    /// The currently active storage array
+    std::atomic<Array*> _array;
+
+    /// All arrays that were ever used by this queue, including the active one. Only the
+    /// owner is allowed to modify this list when the queue grows
+    std::vector<std::unique_ptr<Array>> _arrays;
+};
+
+} // namespace ghoul
+
+#include "workstealingqueue.inl"
+
+#endif // __GHOUL___WORKSTEALINGQUEUE___H__
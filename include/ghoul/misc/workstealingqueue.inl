@@ -0,0 +1,161 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/assert.h>
+
+namespace ghoul {
+
+template <typename T>
+WorkStealingQueue<T>::Array::Array(int64_t cap)
+    : capacity(cap)
+    , mask(cap - 1)
+    , data(std::make_unique<std::atomic<T*>[]>(static_cast<size_t>(cap)))
+{}
+
+template <typename T>
+T* WorkStealingQueue<T>::Array::get(int64_t i) const {
+    return data[i & mask].load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void WorkStealingQueue<T>::Array::put(int64_t i, T* item) {
+    data[i & mask].store(item, std::memory_order_relaxed);
+}
+
+template <typename T>
+typename WorkStealingQueue<T>::Array*
+WorkStealingQueue<T>::Array::grow(int64_t bottom, int64_t top) const
+{
+    Array* res = new Array(capacity * 2);
+    for (int64_t i = top; i != bottom; ++i) {
+        res->put(i, get(i));
+    }
+    return res;
+}
+
+template <typename T>
+WorkStealingQueue<T>::WorkStealingQueue(int64_t capacity) {
+    ghoul_assert(
+        capacity > 0 && (capacity & (capacity - 1)) == 0,
+        "Capacity must be a power of two"
+    );
+
+    _arrays.push_back(std::make_unique<Array>(capacity));
+    _array.store(_arrays.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+WorkStealingQueue<T>::~WorkStealingQueue() {
+    while (T* item = pop()) {
+        delete item;
+    }
+}
+
+template <typename T>
+void WorkStealingQueue<T>::push(T* item) {
+    ghoul_assert(item, "Item must not be nullptr");
+
+    const int64_t b = _bottom.load(std::memory_order_relaxed);
+    const int64_t t = _top.load(std::memory_order_acquire);
+    Array* a = _array.load(std::memory_order_relaxed);
+
+    if (b - t > a->capacity - 1) {
+        // The queue is full, so we have to move to a bigger storage. The old array is
+        // kept alive as thieves might still be reading from it
+        a = a->grow(b, t);
+        _arrays.emplace_back(a);
+        _array.store(a, std::memory_order_release);
+    }
+
+    a->put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    _bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+T* WorkStealingQueue<T>::pop() {
+    const int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+    Array* a = _array.load(std::memory_order_relaxed);
+    _bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = _top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // The queue was empty, so we restore the bottom index
+        _bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    T* item = a->get(b);
+    if (t == b) {
+        // This was the last item in the queue, so we are racing against the thieves
+        const bool won = _top.compare_exchange_strong(
+            t,
+            t + 1,
+            std::memory_order_seq_cst,
+            std::memory_order_relaxed
+        );
+        if (!won) {
+            item = nullptr;
+        }
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+}
+
+template <typename T>
+T* WorkStealingQueue<T>::steal() {
+    int64_t t = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = _bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+        return nullptr;
+    }
+
+    Array* a = _array.load(std::memory_order_acquire);
+    T* item = a->get(t);
+    const bool won = _top.compare_exchange_strong(
+        t,
+        t + 1,
+        std::memory_order_seq_cst,
+        std::memory_order_relaxed
+    );
+    return won ? item : nullptr;
+}
+
+template <typename T>
+int WorkStealingQueue<T>::size() const {
+    const int64_t b = _bottom.load(std::memory_order_relaxed);
+    const int64_t t = _top.load(std::memory_order_relaxed);
+    return b > t ? static_cast<int>(b - t) : 0;
+}
+
+template <typename T>
+bool WorkStealingQueue<T>::isEmpty() const {
+    return size() == 0;
+}
+
+} // namespace ghoul
@@ -181,6 +181,9 @@ void TcpSocket::closeSocket() {
 
     _isConnected = false;
     _isConnecting = false;
+
+    // Nobody is going to send the input that the waiters are waiting for anymore
+    notifyInputWaiters();
 }
 
 void TcpSocket::disconnect(int) {
@@ -328,6 +331,7 @@ void TcpSocket::streamInput() {
             );
         }
         _inputNotifier.notify_one();
+        notifyInputWaiters();
     }
 }
 
@@ -454,6 +458,100 @@ void TcpSocket::uninterceptInput() {
     _inputInterceptor = nullptr;
 }
 
+bool TcpSocket::tryGetInput(char* buffer, size_t nBytes, bool& success) {
+    std::lock_guard inputLock(_inputQueueMutex);
+    if (_shouldStopThreads || (!_isConnected && !_isConnecting)) {
+        success = false;
+        return true;
+    }
+    // Earlier waiters have to receive their input first
+    if (!_inputWaiters.empty() || _inputQueue.size() < nBytes) {
+        return false;
+    }
+    std::copy_n(_inputQueue.begin(), nBytes, buffer);
+    _inputQueue.erase(_inputQueue.begin(), _inputQueue.begin() + nBytes);
+    success = true;
+    return true;
+}
+
+void TcpSocket::whenInputAvailable(char* buffer, size_t nBytes,
+                                   std::function<void(bool)> callback)
+{
+    bool success = false;
+    {
+        std::lock_guard inputLock(_inputQueueMutex);
+        const bool isDisconnected =
+            _shouldStopThreads || (!_isConnected && !_isConnecting);
+        if (!isDisconnected) {
+            if (!_inputWaiters.empty() || _inputQueue.size() < nBytes) {
+                _inputWaiters.push_back({ buffer, nBytes, std::move(callback) });
+                return;
+            }
+            std::copy_n(_inputQueue.begin(), nBytes, buffer);
+            _inputQueue.erase(_inputQueue.begin(), _inputQueue.begin() + nBytes);
+            success = true;
+        }
+    }
+    callback(success);
+}
+
+void TcpSocket::notifyInputWaiters() {
+    std::vector<std::function<void(bool)>> readyCallbacks;
+    bool success = true;
+    {
+        std::lock_guard inputLock(_inputQueueMutex);
+        if (_inputWaiters.empty()) {
+            return;
+        }
+
+        if (_shouldStopThreads || (!_isConnected && !_isConnecting)) {
+            // Nobody is going to send the input that the waiters are waiting for anymore
+            success = false;
+            for (InputWaiter& waiter : _inputWaiters) {
+                readyCallbacks.push_back(std::move(waiter.callback));
+            }
+            _inputWaiters.clear();
+        }
+        else {
+            // The waiters receive the input strictly in order, so that a later waiter for
+            // fewer bytes cannot take the input that an earlier waiter is waiting for
+            while (!_inputWaiters.empty() &&
+                   _inputQueue.size() >= _inputWaiters.front().nBytes)
+            {
+                InputWaiter& waiter = _inputWaiters.front();
+                std::copy_n(_inputQueue.begin(), waiter.nBytes, waiter.buffer);
+                _inputQueue.erase(
+                    _inputQueue.begin(),
+                    _inputQueue.begin() + waiter.nBytes
+                );
+                readyCallbacks.push_back(std::move(waiter.callback));
+                _inputWaiters.pop_front();
+            }
+        }
+    }
+
+    // The callbacks are called without holding the lock as they might access the socket
+    for (std::function<void(bool)>& callback : readyCallbacks) {
+        callback(success);
+    }
+}
+
+TcpSocket::InputAwaitable::InputAwaitable(TcpSocket& socket, ThreadPool& pool,
+                                          char* buffer, size_t nBytes)
+    : _socket(socket)
+    , _pool(pool)
+    , _buffer(buffer)
+    , _nBytes(nBytes)
+{}
+
+bool TcpSocket::InputAwaitable::await_ready() {
+    return _socket.tryGetInput(_buffer, _nBytes, _success);
+}
+
+bool TcpSocket::InputAwaitable::await_resume() {
+    return _success;
+}
+
 bool TcpSocket::getBytes(char* buffer, size_t nItems) {
     waitForInput(nItems);
     if (_shouldStopThreads || (!_isConnected && !_isConnecting)) {
@@ -25,19 +25,27 @@
 
 #include <ghoul/lua/lua_helper.h>
 
+#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/lua/luaallocator.h>
+#include <ghoul/lua/luastatepool.h>
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/misc/misc.h>
+#include <ghoul/misc/threadpool.h>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <sstream>
 
-static lua_State* _state = nullptr;
-
 namespace {
 
 constexpr const int KeyTableIndex = -2;
@@ -53,11 +61,186 @@ int luaAbsoluteLocation(lua_State* state, int relativeLocation) {
     return nItems + relativeLocation + 1;
 }
 
-lua_State* staticLuaState() {
-    if (!_state) {
-        _state = ghoul::lua::createNewLuaState();
+// Converts the numeric \p key into a string inside the \p buffer, which avoids creating a
+// temporary string for every element of an array-style table
+std::string_view numberKey(lua_Integer key, std::array<char, 24>& buffer) {
+    const std::to_chars_result res =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), key);
+    return std::string_view(buffer.data(), res.ptr - buffer.data());
+}
+
+// Stores the value at the stack \p location in the \p dictionary under the \p key.
+// Tables are converted directly into a Dictionary that uses the same memory resource as
+// the \p dictionary and is then moved into place, so that it never has to be copied
+void setValueFromState(lua_State* state, ghoul::Dictionary& dictionary,
+                       std::string_view key, int location)
+{
+    switch (lua_type(state, location)) {
+        case LUA_TNUMBER:
+            dictionary.setValue(key, static_cast<double>(lua_tonumber(state, location)));
+            break;
+        case LUA_TBOOLEAN:
+            dictionary.setValue(key, lua_toboolean(state, location) == 1);
+            break;
+        case LUA_TSTRING:
+        {
+            size_t length = 0;
+            const char* value = lua_tolstring(state, location, &length);
+            dictionary.setValue(key, std::string(value, length));
+            break;
+        }
+        case LUA_TTABLE:
+        {
+            ghoul::Dictionary d(dictionary.memoryResource());
+            ghoul::lua::luaDictionaryFromState(state, d, location);
+            dictionary.setValue(key, std::move(d));
+            break;
+        }
+        default:
+            throw ghoul::lua::LuaFormatException(
+                fmt::format("Unknown type: {}", lua_type(state, location))
+            );
+    }
+}
+
+// Whether the compiled bytecode of Lua scripts is cached by loadFile
+std::atomic_bool BytecodeCacheEnabled = false;
+
+// Serializes the accesses to the CacheManager and the cached bytecode files, as the
+// CacheManager is not thread-safe and a file must not be read while it is written
+std::mutex BytecodeCacheMutex;
+
+// Collects the bytecode that is produced by lua_dump into a std::string
+int writeBytecode(lua_State*, const void* data, size_t size, void* userData) {
+    std::string* bytecode = reinterpret_cast<std::string*>(userData);
+    bytecode->append(reinterpret_cast<const char*>(data), size);
+    return 0;
+}
+
+// Returns the location of the cached bytecode for the script \p filename, or an empty
+// path if the bytecode cache is disabled or the script cannot be cached. The \p header
+// that identifies the current version of the script is stored at the beginning of the
+// cached file. The caller has to hold the BytecodeCacheMutex
+std::filesystem::path bytecodeCacheFile(const std::filesystem::path& filename,
+                                        std::string& header)
+{
+    using namespace ghoul::filesystem;
+    if (!BytecodeCacheEnabled || !FileSystem::isInitialized() || !FileSys.cacheManager())
+    {
+        return std::filesystem::path();
+    }
+
+    std::error_code ec;
+    const std::filesystem::file_time_type time =
+        std::filesystem::last_write_time(filename, ec);
+    const uintmax_t size = std::filesystem::file_size(filename, ec);
+    if (ec) {
+        return std::filesystem::path();
+    }
+
+    // The CacheManager only distinguishes files by their name, so the full path is used
+    // to tell apart scripts with the same name in different directories. The remaining
+    // information goes into the header instead so that every script has only a single
+    // cached file that is overwritten whenever the script changes. The version is added
+    // as the bytecode format differs between Lua versions
+    const std::string path = std::filesystem::absolute(filename).string();
+    header = fmt::format(
+        "GhoulLuaBytecode|{}|{}|{}|{}\n",
+        path, time.time_since_epoch().count(), size, LUA_VERSION_NUM
+    );
+    try {
+        return FileSys.cacheManager()->cachedFilename(filename, path);
+    }
+    catch (const ghoul::RuntimeError&) {
+        // The file name contains characters that are not supported by the CacheManager
+        return std::filesystem::path();
+    }
+}
+
+// Loads the Lua script \p filename as a function onto the stack of the \p state in the
+// same way as luaL_loadfile. If the bytecode cache is enabled, the compiled bytecode is
+// loaded from the cache instead if the header of the cached file shows that the script
+// has not changed since it was cached, or is stored in the cache otherwise
+int loadFile(lua_State* state, const std::filesystem::path& filename) {
+    const std::string fn = filename.string();
+    if (!BytecodeCacheEnabled) {
+        return luaL_loadfile(state, fn.c_str());
     }
-    return _state;
+
+    std::filesystem::path cacheFile;
+    std::string header;
+    std::string content;
+    {
+        std::lock_guard lock(BytecodeCacheMutex);
+        cacheFile = bytecodeCacheFile(filename, header);
+        if (cacheFile.empty()) {
+            return luaL_loadfile(state, fn.c_str());
+        }
+
+        std::ifstream file(cacheFile, std::ifstream::binary);
+        if (file.good()) {
+            content.assign(
+                std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>()
+            );
+        }
+    }
+
+    // The cached file belongs to a different version of the script, a different script,
+    // or a different Lua version if the header does not match
+    if (content.size() > header.size() &&
+        std::string_view(content).substr(0, header.size()) == header)
+    {
+        // Use the same chunk name as luaL_loadfile so that error messages and debug
+        // information refer to the script file
+        const std::string chunkName = "@" + fn;
+        const int status = luaL_loadbufferx(
+            state,
+            content.data() + header.size(),
+            content.size() - header.size(),
+            chunkName.c_str(),
+            "b"
+        );
+        if (status == LUA_OK) {
+            return LUA_OK;
+        }
+        // The cached bytecode is damaged, so we compile the script again and replace it
+        lua_pop(state, 1);
+    }
+
+    const int status = luaL_loadfile(state, fn.c_str());
+    if (status != LUA_OK) {
+        return status;
+    }
+
+    // Keep the debug information so that errors report the correct lines
+    std::string bytecode = std::move(header);
+    lua_dump(state, writeBytecode, &bytecode, 0);
+    std::lock_guard lock(BytecodeCacheMutex);
+    std::ofstream file(cacheFile, std::ofstream::binary | std::ofstream::trunc);
+    file.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size()));
+    return LUA_OK;
+}
+
+// The states that are used if no state is passed to the loading functions. Using a pool
+// instead of a single state makes these functions safe to call from multiple threads
+ghoul::lua::LuaStatePool& globalStatePool() {
+    static ghoul::lua::LuaStatePool Pool(
+        0,
+        ghoul::lua::LuaState::IncludeStandardLibrary::Yes,
+        ghoul::lua::LuaState::StrictState::No
+    );
+    return Pool;
+}
+
+// Same behavior as the panic function that luaL_newstate installs, which is used for
+// states that are created with lua_newstate instead
+int defaultPanicFunction(lua_State* state) {
+    const char* msg = lua_type(state, -1) == LUA_TSTRING ?
+        lua_tostring(state, -1) :
+        "error object is not a string";
+    LFATALC("Lua", fmt::format("Unprotected error in call to Lua API: {}", msg));
+    return 0;
 }
 
 // Code snippet that causes the Lua State to strict by making it that the lookup in the
@@ -247,11 +430,13 @@ void loadDictionaryFromFile(const std::string& filename, ghoul::Dictionary& dict
         "filename must be an existing file"
     );
 
+    LuaStatePool::Handle handle;
     if (!state) {
-        state = staticLuaState();
+        handle = globalStatePool().checkout();
+        state = handle;
     }
 
-    const int loadStatus = luaL_loadfile(state, filename.c_str());
+    const int loadStatus = loadFile(state, filename);
     if (loadStatus != LUA_OK) {
         throw LuaLoadingException(lua_tostring(state, -1), filename);
     }
@@ -281,13 +466,54 @@ ghoul::Dictionary loadDictionaryFromFile(const std::string& filename, lua_State*
     return result;
 }
 
+std::vector<ghoul::Dictionary> loadDictionariesFromFiles(
+                                      const std::vector<std::filesystem::path>& filenames,
+                                                    ThreadPool& threadPool,
+                                                    LuaStatePool* statePool)
+{
+    LuaStatePool& pool = statePool ? *statePool : globalStatePool();
+
+    struct LoadTask {
+        const std::filesystem::path* filename;
+        LuaStatePool* pool;
+
+        ghoul::Dictionary operator()() const {
+            LuaStatePool::Handle state = pool->checkout();
+            return loadDictionaryFromFile(filename->string(), state);
+        }
+    };
+
+    std::vector<LoadTask> tasks;
+    tasks.reserve(filenames.size());
+    for (const std::filesystem::path& filename : filenames) {
+        tasks.push_back({ &filename, &pool });
+    }
+
+    ThreadPool::BulkSubmission<ghoul::Dictionary> submission = threadPool.submitBulk(
+        tasks.begin(),
+        tasks.end()
+    );
+    // The tasks refer to the filenames and the state pool, so all of them have to be
+    // finished before a potential exception is allowed to leave this function
+    submission.done.wait();
+
+    std::vector<ghoul::Dictionary> result;
+    result.reserve(filenames.size());
+    for (TaskFuture<ghoul::Dictionary>& future : submission.futures) {
+        result.push_back(future.get());
+    }
+    return result;
+}
+
 void loadDictionaryFromString(const std::string& script, Dictionary& dictionary,
                               lua_State* state)
 {
     ghoul_assert(!script.empty(), "Script must not be empty");
 
+    LuaStatePool::Handle handle;
     if (!state) {
-        state = staticLuaState();
+        handle = globalStatePool().checkout();
+        state = handle;
     }
 
     const int loadStatus = luaL_loadstring(state, script.c_str());
@@ -319,8 +545,10 @@ void loadArrayDictionaryFromString(const std::string& script, Dictionary& dictio
 {
     ghoul_assert(!script.empty(), "Script must not be empty");
 
+    LuaStatePool::Handle handle;
     if (!state) {
-        state = staticLuaState();
+        handle = globalStatePool().checkout();
+        state = handle;
     }
 
     // Clear the stack. This should not be necessary, but if the stack was left unclean,
@@ -384,10 +612,11 @@ void luaDictionaryFromState(lua_State* state, Dictionary& dictionary,
         throw LuaFormatException("Tried to load Dictionary from wrong parameter type");
     }
 
+    std::array<char, 24> buffer;
     lua_pushnil(state);
     while (lua_next(state, location) != 0) {
         // get the key
-        std::string key;
+        std::string_view key;
         const int keyType = lua_type(state, KeyTableIndex);
         switch (keyType) {
             case LUA_TNUMBER:
@@ -398,9 +627,10 @@ void luaDictionaryFromState(lua_State* state, Dictionary& dictionary,
                 }
 
                 type = TableType::Array;
-                key = std::to_string(lua_tointeger(state, KeyTableIndex));
+                key = numberKey(lua_tointeger(state, KeyTableIndex), buffer);
                 break;
             case LUA_TSTRING:
+            {
                 if (type == TableType::Array) {
                     throw LuaFormatException(
                         "Dictionary can only contain a pure map or a pure array"
@@ -408,36 +638,17 @@ void luaDictionaryFromState(lua_State* state, Dictionary& dictionary,
                 }
 
                 type = TableType::Map;
-                key = lua_tostring(state, KeyTableIndex);
+                size_t length = 0;
+                const char* k = lua_tolstring(state, KeyTableIndex, &length);
+                key = std::string_view(k, length);
                 break;
+            }
             default:
                 throw LuaFormatException("Table index type is not a number or a string");
         }
 
         // get the value
-        switch (lua_type(state, ValueTableIndex)) {
-            case LUA_TNUMBER: {
-                double value = lua_tonumber(state, ValueTableIndex);
-                dictionary.setValue(key, value);
-            } break;
-            case LUA_TBOOLEAN: {
-                bool value = (lua_toboolean(state, ValueTableIndex) == 1);
-                dictionary.setValue(key, value);
-            } break;
-            case LUA_TSTRING: {
-                std::string value = lua_tostring(state, ValueTableIndex);
-                dictionary.setValue(key, value);
-            } break;
-            case LUA_TTABLE: {
-                Dictionary d;
-                luaDictionaryFromState(state, d);
-                dictionary.setValue(key, d);
-            } break;
-            default:
-                throw LuaFormatException(
-                    "Unknown type: " + std::to_string(lua_type(state, ValueTableIndex))
-                );
-        }
+        setValueFromState(state, dictionary, key, ValueTableIndex);
 
         // get back up one level
         lua_pop(state, 1);
@@ -458,34 +669,9 @@ ghoul::Dictionary luaDictionaryFromState(lua_State* state, int location) {
 void luaArrayDictionaryFromState(lua_State* state, Dictionary& dictionary) {
     const int nValues = lua_gettop(state);
 
+    std::array<char, 24> buffer;
     for (int i = 1; i <= nValues; ++i) {
-        switch (lua_type(state, i)) {
-            case LUA_TNUMBER: {
-                double value = lua_tonumber(state, i);
-                dictionary.setValue(std::to_string(i), value);
-                break;
-            }
-            case LUA_TBOOLEAN: {
-                bool value = (lua_toboolean(state, i) == 1);
-                dictionary.setValue(std::to_string(i), value);
-                break;
-            }
-            case LUA_TSTRING: {
-                std::string value = lua_tostring(state, i);
-                dictionary.setValue(std::to_string(i), value);
-                break;
-            }
-            case LUA_TTABLE: {
-                Dictionary d;
-                luaDictionaryFromState(state, d, i);
-                dictionary.setValue(std::to_string(i), d);
-                break;
-            }
-            default:
-                throw LuaFormatException(
-                    fmt::format("Unknown type: {}", lua_type(state, i))
-                );
-        }
+        setValueFromState(state, dictionary, numberKey(i, buffer), i);
     }
 }
 
@@ -505,9 +691,24 @@ std::string_view luaTypeToString(int type) {
     }
 }
 
-lua_State* createNewLuaState(bool loadStandardLibraries, bool strictState) {
+lua_State* createNewLuaState(bool loadStandardLibraries, bool strictState,
+                             bool pooledAllocator)
+{
     LDEBUGC("Lua", "Creating Lua state");
-    lua_State* s = luaL_newstate();
+    lua_State* s = nullptr;
+    if (pooledAllocator) {
+        auto allocator = std::make_unique<LuaAllocator>();
+        s = lua_newstate(&LuaAllocator::allocate, allocator.get());
+        if (s) {
+            // The allocator is owned by the state from now on and is deleted together
+            // with it in destroyLuaState
+            allocator.release();
+            lua_atpanic(s, &defaultPanicFunction);
+        }
+    }
+    else {
+        s = luaL_newstate();
+    }
     if (!s) {
         throw LuaRuntimeException("Error creating Lua state: Memory allocation");
     }
@@ -534,7 +735,9 @@ lua_State* createNewLuaState(bool loadStandardLibraries, bool strictState) {
 
 void destroyLuaState(lua_State* state) {
     ghoul_assert(state, "State must not be nullptr");
+    LuaAllocator* allocator = LuaAllocator::fromState(state);
     lua_close(state);
+    delete allocator;
 }
 
 void runScriptFile(lua_State* state, const std::filesystem::path& filename) {
@@ -545,8 +748,7 @@ void runScriptFile(lua_State* state, const std::filesystem::path& filename) {
         "Filename must be a file that exists"
     );
 
-    std::string fn = filename.string();
-    int status = luaL_loadfile(state, fn.c_str());
+    int status = loadFile(state, filename);
     if (status != LUA_OK) {
         std::string error = lua_tostring(state, -1);
         throw LuaLoadingException(error);
@@ -559,6 +761,14 @@ void runScriptFile(lua_State* state, const std::filesystem::path& filename) {
     }
 }
 
+void setBytecodeCacheEnabled(bool enabled) {
+    BytecodeCacheEnabled = enabled;
+}
+
+bool isBytecodeCacheEnabled() {
+    return BytecodeCacheEnabled;
+}
+
 void runScript(lua_State* state, const std::string& script) {
     ghoul_assert(state, "State must not be nullptr");
     ghoul_assert(!script.empty(), "Script must not be empty");
@@ -652,10 +862,7 @@ void verifyStackSize(lua_State* L, int expected) {
 namespace internal {
 
 void deinitializeGlobalState() {
-    if (_state) {
-        lua_close(_state);
-    }
-    _state = nullptr;
+    globalStatePool().clear();
 }
 
 } // namespace internal
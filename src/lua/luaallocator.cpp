@@ -0,0 +1,202 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/lua/luaallocator.h>
+
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    using ghoul::lua::LuaAllocator;
+
+    // Each chunk starts with a pointer to the previously reserved chunk. The header is
+    // padded to the granularity so that the blocks keep the alignment of the chunk
+    constexpr size_t ChunkHeaderSize = LuaAllocator::Granularity;
+    static_assert(ChunkHeaderSize >= sizeof(void*));
+    static_assert(LuaAllocator::MaxPooledSize % LuaAllocator::Granularity == 0);
+
+    constexpr size_t sizeClass(size_t size) {
+        return (size - 1) / LuaAllocator::Granularity;
+    }
+
+    constexpr size_t blockSize(size_t size) {
+        return (sizeClass(size) + 1) * LuaAllocator::Granularity;
+    }
+
+    constexpr bool isPooled(size_t size) {
+        return size <= LuaAllocator::MaxPooledSize;
+    }
+} // namespace
+
+namespace ghoul::lua {
+
+LuaAllocator::~LuaAllocator() {
+    void* chunk = _chunks;
+    while (chunk) {
+        void* previous = *static_cast<void**>(chunk);
+        std::free(chunk);
+        chunk = previous;
+    }
+}
+
+void* LuaAllocator::allocate(void* userData, void* ptr, size_t oldSize,
+                             size_t newSize) noexcept
+{
+    LuaAllocator& a = *static_cast<LuaAllocator*>(userData);
+
+    if (!ptr) {
+        // oldSize only encodes the type of the new object in this case
+        if (newSize == 0) {
+            return nullptr;
+        }
+        void* res = a.newBlock(newSize);
+        if (res) {
+            a._statistics.nAllocations++;
+            a._statistics.nLargeAllocations += isPooled(newSize) ? 0 : 1;
+            a.grow(newSize);
+        }
+        return res;
+    }
+
+    if (newSize == 0) {
+        a.deleteBlock(ptr, oldSize);
+        a._statistics.nDeallocations++;
+        a._statistics.liveBytes -= oldSize;
+        return nullptr;
+    }
+
+    void* res = nullptr;
+    if (!isPooled(oldSize) && !isPooled(newSize)) {
+        res = std::realloc(ptr, newSize);
+    }
+    else if (isPooled(oldSize) && isPooled(newSize) &&
+             sizeClass(oldSize) == sizeClass(newSize))
+    {
+        res = ptr;
+    }
+    else {
+        res = a.newBlock(newSize);
+        if (!res && isPooled(oldSize) && newSize < oldSize) {
+            // Shrinking a pooled block must not fail. The old block is large enough, so
+            // it is kept and later returned to the free list of the smaller size class
+            res = ptr;
+        }
+        else if (!res && newSize < oldSize) {
+            // Shrinking a large block must not fail either, so the block is kept and
+            // trimmed to the block size of the smaller size class. When it is
+            // deallocated, it joins the free list of that size class like a pooled
+            // block. It is never released, as the allocator only frees its chunks
+            const size_t size = blockSize(newSize);
+            res = std::realloc(ptr, size);
+            if (!res) {
+                res = ptr;
+            }
+            a._statistics.pooledBytes += size;
+        }
+        else if (res) {
+            std::memcpy(res, ptr, std::min(oldSize, newSize));
+            a.deleteBlock(ptr, oldSize);
+        }
+    }
+
+    if (res) {
+        a._statistics.nReallocations++;
+        a._statistics.nLargeAllocations += isPooled(newSize) ? 0 : 1;
+        a._statistics.liveBytes -= oldSize;
+        a.grow(newSize);
+    }
+    return res;
+}
+
+const LuaAllocator::Statistics& LuaAllocator::statistics() const {
+    return _statistics;
+}
+
+LuaAllocator* LuaAllocator::fromState(lua_State* state) {
+    ghoul_assert(state, "State must not be nullptr");
+
+    void* userData = nullptr;
+    const lua_Alloc function = lua_getallocf(state, &userData);
+    if (function != &LuaAllocator::allocate) {
+        return nullptr;
+    }
+    return static_cast<LuaAllocator*>(userData);
+}
+
+void* LuaAllocator::newBlock(size_t size) noexcept {
+    if (!isPooled(size)) {
+        return std::malloc(size);
+    }
+
+    FreeBlock*& freeList = _freeLists[sizeClass(size)];
+    if (freeList) {
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+    return carve(blockSize(size));
+}
+
+void LuaAllocator::deleteBlock(void* ptr, size_t size) noexcept {
+    if (!isPooled(size)) {
+        std::free(ptr);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    FreeBlock*& freeList = _freeLists[sizeClass(size)];
+    block->next = freeList;
+    freeList = block;
+}
+
+void* LuaAllocator::carve(size_t size) noexcept {
+    if (static_cast<size_t>(_chunkEnd - _chunkPosition) < size) {
+        // The remainder of the current chunk is abandoned. As it is smaller than the
+        // largest block size, this wastes less than 0.5% of each chunk
+        void* chunk = std::malloc(ChunkSize);
+        if (!chunk) {
+            return nullptr;
+        }
+        *static_cast<void**>(chunk) = _chunks;
+        _chunks = chunk;
+        _chunkPosition = static_cast<std::byte*>(chunk) + ChunkHeaderSize;
+        _chunkEnd = static_cast<std::byte*>(chunk) + ChunkSize;
+        _statistics.pooledBytes += ChunkSize;
+    }
+
+    void* res = _chunkPosition;
+    _chunkPosition += size;
+    return res;
+}
+
+void LuaAllocator::grow(size_t size) {
+    _statistics.liveBytes += size;
+    _statistics.peakBytes = std::max(_statistics.peakBytes, _statistics.liveBytes);
+}
+
+} // namespace ghoul::lua
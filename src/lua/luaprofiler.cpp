@@ -0,0 +1,461 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/lua/luaprofiler.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/misc.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#ifdef TRACY_ENABLE
+#include <TracyC.h>
+#endif // TRACY_ENABLE
+
+namespace {
+    // The address of this variable is the key under which the running profiler is stored
+    // in the registry of the Lua state
+    constexpr const char RegistryKey = 0;
+
+    // The address of this variable is the key of the table in the registry that keeps
+    // the profiled coroutines alive, so that their address cannot be reused by another
+    // coroutine while the profiler has information about them
+    constexpr const char ThreadsKey = 0;
+
+    std::string functionName(const lua_Debug& ar) {
+        const bool isMain = std::strcmp(ar.what, "main") == 0;
+        const char* name = ar.name ? ar.name : (isMain ? "main chunk" : "?");
+        if (std::strcmp(ar.what, "C") == 0) {
+            return fmt::format("{} ([C])", name);
+        }
+        return fmt::format("{} ({}:{})", name, ar.short_src, ar.linedefined);
+    }
+
+    template <typename Duration>
+    double toMilliseconds(Duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    template <typename Duration>
+    double toMicroseconds(Duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+} // namespace
+
+namespace ghoul::lua {
+
+bool LuaProfiler::FunctionKey::operator==(const FunctionKey& other) const {
+    return id == other.id && line == other.line;
+}
+
+size_t LuaProfiler::FunctionKeyHash::operator()(const FunctionKey& key) const {
+    return std::hash<const void*>()(key.id) ^ (static_cast<size_t>(key.line) << 1);
+}
+
+LuaProfiler::LuaProfiler(lua_State* state, RecordTrace recordTrace)
+    : _state(state)
+    , _recordTrace(recordTrace)
+    , _epoch(Clock::now())
+{
+    ghoul_assert(_state, "State must not be nullptr");
+}
+
+LuaProfiler::~LuaProfiler() {
+    if (_isRunning) {
+        stop();
+    }
+}
+
+void LuaProfiler::start() {
+    ghoul_assert(!_isRunning, "Profiler must not be running");
+
+    lua_rawgetp(_state, LUA_REGISTRYINDEX, &RegistryKey);
+    ghoul_assert(
+        lua_isnil(_state, -1),
+        "Another profiler is already running for this state"
+    );
+    lua_pop(_state, 1);
+
+    lua_pushlightuserdata(_state, this);
+    lua_rawsetp(_state, LUA_REGISTRYINDEX, &RegistryKey);
+    lua_newtable(_state);
+    lua_rawsetp(_state, LUA_REGISTRYINDEX, &ThreadsKey);
+
+    _previousAllocate = lua_getallocf(_state, &_previousAllocateData);
+    lua_setallocf(_state, &LuaProfiler::allocate, this);
+
+    _previousHook = lua_gethook(_state);
+    _previousHookMask = lua_gethookmask(_state);
+    _previousHookCount = lua_gethookcount(_state);
+    lua_sethook(_state, &LuaProfiler::hook, LUA_MASKCALL | LUA_MASKRET, 0);
+
+    _isRunning = true;
+}
+
+void LuaProfiler::stop() {
+    ghoul_assert(_isRunning, "Profiler must be running");
+
+    const Clock::time_point now = Clock::now();
+
+    // Handle a yield or the end of the coroutine that caused the most recent event
+    switchThread(_state, now);
+
+    lua_sethook(_state, _previousHook, _previousHookMask, _previousHookCount);
+    lua_setallocf(_state, _previousAllocate, _previousAllocateData);
+
+    // Coroutines that were created while the profiler was running still have the hook,
+    // which removes itself from them the next time they are resumed
+    lua_pushnil(_state);
+    lua_rawsetp(_state, LUA_REGISTRYINDEX, &RegistryKey);
+
+    for (std::pair<lua_State* const, Thread>& thread : _threads) {
+        // Suspended coroutines stopped spending time when they yielded
+        Thread& t = thread.second;
+        const Clock::time_point end = t.isSuspended ? t.suspendedAt : now;
+        while (!t.frames.empty()) {
+            popFrame(t, end);
+        }
+    }
+
+    // The coroutines are no longer kept alive, so their addresses might be reused by
+    // coroutines that have nothing to do with the ones that were profiled
+    lua_pushnil(_state);
+    lua_rawsetp(_state, LUA_REGISTRYINDEX, &ThreadsKey);
+    for (auto it = _threads.begin(); it != _threads.end();) {
+        it = it->first == _state ? std::next(it) : _threads.erase(it);
+    }
+    _currentThread = nullptr;
+
+    _isRunning = false;
+}
+
+bool LuaProfiler::isRunning() const {
+    return _isRunning;
+}
+
+void LuaProfiler::reset() {
+    ghoul_assert(!_isRunning, "Profiler must not be running");
+
+    _functionIndices.clear();
+    _functions.clear();
+    _threads.clear();
+    _nThreads = 0;
+    _trace.clear();
+    _epoch = Clock::now();
+}
+
+std::vector<LuaProfiler::FunctionStatistics> LuaProfiler::statistics() const {
+    std::vector<FunctionStatistics> res;
+    res.reserve(_functions.size());
+    for (const Function& function : _functions) {
+        res.push_back(function.statistics);
+    }
+    std::sort(
+        res.begin(), res.end(),
+        [](const FunctionStatistics& lhs, const FunctionStatistics& rhs) {
+            if (lhs.exclusiveTime != rhs.exclusiveTime) {
+                return lhs.exclusiveTime > rhs.exclusiveTime;
+            }
+            return lhs.name < rhs.name;
+        }
+    );
+    return res;
+}
+
+std::string LuaProfiler::report(size_t nFunctions) const {
+    std::vector<FunctionStatistics> stats = statistics();
+    if (nFunctions > 0 && stats.size() > nFunctions) {
+        stats.resize(nFunctions);
+    }
+
+    std::string res = fmt::format(
+        "{:>10} {:>14} {:>14} {:>12} {:>14}  {}\n",
+        "Calls", "Inclusive (ms)", "Exclusive (ms)", "Allocations", "Bytes", "Function"
+    );
+    for (const FunctionStatistics& s : stats) {
+        res += fmt::format(
+            "{:>10} {:>14.3f} {:>14.3f} {:>12} {:>14}  {}\n",
+            s.nCalls, toMilliseconds(s.inclusiveTime), toMilliseconds(s.exclusiveTime),
+            s.nAllocations, s.allocatedBytes, s.name
+        );
+    }
+    return res;
+}
+
+std::string LuaProfiler::chromeTrace() const {
+    ghoul_assert(_recordTrace, "Profiler must record a trace");
+
+    std::string res = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    for (size_t i = 0; i < _trace.size(); ++i) {
+        const TraceEvent& e = _trace[i];
+        if (i > 0) {
+            res += ',';
+        }
+        res += R"({"name":")";
+        appendEscapedString(
+            res,
+            _functions[e.function].statistics.name,
+            EscapeSyntax::Json
+        );
+        res += fmt::format(
+            R"(","cat":"lua","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+            e.thread, toMicroseconds(e.start), toMicroseconds(e.duration)
+        );
+    }
+    res += "]}";
+    return res;
+}
+
+void LuaProfiler::hook(lua_State* state, lua_Debug* ar) {
+    const Clock::time_point now = Clock::now();
+
+    lua_rawgetp(state, LUA_REGISTRYINDEX, &RegistryKey);
+    LuaProfiler* profiler = static_cast<LuaProfiler*>(lua_touserdata(state, -1));
+    lua_pop(state, 1);
+    if (!profiler || !profiler->_isRunning) {
+        // A coroutine that was created while the profiler was running inherited the hook,
+        // which is removed now as there is nothing left to record
+        lua_sethook(state, nullptr, 0, 0);
+        return;
+    }
+    profiler->handleEvent(state, ar, now);
+}
+
+void* LuaProfiler::allocate(void* userData, void* ptr, size_t oldSize,
+                            size_t newSize) noexcept
+{
+    LuaProfiler& profiler = *static_cast<LuaProfiler*>(userData);
+    if (!ptr && newSize > 0) {
+        // oldSize only encodes the type of the new object in this case
+        profiler._nAllocations++;
+        profiler._allocatedBytes += newSize;
+    }
+    else if (ptr && newSize > oldSize) {
+        profiler._allocatedBytes += newSize - oldSize;
+    }
+    return profiler._previousAllocate(
+        profiler._previousAllocateData,
+        ptr,
+        oldSize,
+        newSize
+    );
+}
+
+void LuaProfiler::handleEvent(lua_State* thread, lua_Debug* ar, Clock::time_point now) {
+    if (thread != _currentThread) {
+        switchThread(thread, now);
+    }
+    Thread& t = threadData(thread);
+    const FunctionKey key = functionKey(thread, ar);
+
+    if (ar->event == LUA_HOOKRET) {
+        const auto it = _functionIndices.find(key);
+        if (it == _functionIndices.end()) {
+            return;
+        }
+        const size_t index = it->second;
+        const auto frame = std::find_if(
+            t.frames.rbegin(), t.frames.rend(),
+            [index](const Frame& f) { return f.function == index; }
+        );
+        if (frame == t.frames.rend()) {
+            // The function was called before the profiler started
+            return;
+        }
+
+        // Calls that were left through an error did not generate a return event, so they
+        // are finished together with the first of their callers that returns
+        const size_t nRemaining = static_cast<size_t>(t.frames.rend() - frame) - 1;
+        while (t.frames.size() > nRemaining) {
+            popFrame(t, now);
+        }
+        return;
+    }
+
+    if (ar->event == LUA_HOOKTAILCALL && !t.frames.empty()) {
+        // The function that made the tail call will not generate a return event
+        popFrame(t, now);
+    }
+
+    const size_t index = functionIndex(thread, ar, key);
+    Function& function = _functions[index];
+    function.statistics.nCalls++;
+    function.nActive++;
+
+    Frame frame;
+    frame.function = index;
+    frame.nAllocationsStart = _nAllocations;
+    frame.allocatedBytesStart = _allocatedBytes;
+#ifdef TRACY_ENABLE
+    if (thread == _state) {
+        const std::string& name = function.statistics.name;
+        const uint64_t location = ___tracy_alloc_srcloc_name(
+            ar->linedefined > 0 ? static_cast<uint32_t>(ar->linedefined) : 0,
+            ar->short_src, std::strlen(ar->short_src),
+            name.c_str(), name.size(),
+            name.c_str(), name.size()
+        );
+        const TracyCZoneCtx zone = ___tracy_emit_zone_begin_alloc(location, 1);
+        frame.hasZone = true;
+        frame.zoneId = zone.id;
+        frame.zoneActive = zone.active;
+    }
+#endif // TRACY_ENABLE
+    // Take the start time last so that the time spent in this hook is not attributed to
+    // the called function
+    frame.start = Clock::now();
+    t.frames.push_back(frame);
+}
+
+LuaProfiler::FunctionKey LuaProfiler::functionKey(lua_State* thread, lua_Debug* ar) {
+    lua_getinfo(thread, "S", ar);
+    if (std::strcmp(ar->what, "C") == 0) {
+        // C functions do not have a source, but their address is unique
+        lua_getinfo(thread, "f", ar);
+        const FunctionKey key = { lua_topointer(thread, -1), -1 };
+        lua_pop(thread, 1);
+        return key;
+    }
+    // The source is shared by all closures of the functions in a chunk
+    return { ar->source, ar->linedefined };
+}
+
+size_t LuaProfiler::functionIndex(lua_State* thread, lua_Debug* ar,
+                                  const FunctionKey& key)
+{
+    const auto it = _functionIndices.find(key);
+    if (it != _functionIndices.end()) {
+        return it->second;
+    }
+
+    lua_getinfo(thread, "n", ar);
+    Function function;
+    function.statistics.name = functionName(*ar);
+    _functions.push_back(std::move(function));
+    _functionIndices[key] = _functions.size() - 1;
+    return _functions.size() - 1;
+}
+
+LuaProfiler::Thread& LuaProfiler::threadData(lua_State* thread) {
+    auto it = _threads.find(thread);
+    if (it == _threads.end()) {
+        Thread t;
+        t.id = _nThreads;
+        _nThreads++;
+        it = _threads.emplace(thread, std::move(t)).first;
+
+        if (thread != _state) {
+            lua_rawgetp(thread, LUA_REGISTRYINDEX, &ThreadsKey);
+            lua_pushthread(thread);
+            lua_rawsetp(thread, -2, thread);
+            lua_pop(thread, 1);
+        }
+    }
+    return it->second;
+}
+
+void LuaProfiler::switchThread(lua_State* thread, Clock::time_point now) {
+    // The previous thread is still alive, as all profiled coroutines are kept alive
+    const auto previous = _threads.find(_currentThread);
+    if (previous != _threads.end() && _currentThread != _state) {
+        lua_State* p = _currentThread;
+        lua_Debug ar;
+        const int status = lua_status(p);
+        if (status == LUA_YIELD) {
+            previous->second.isSuspended = true;
+            previous->second.suspendedAt = now;
+        }
+        else if (status != LUA_OK || (lua_getstack(p, 0, &ar) == 0 && lua_gettop(p) == 0))
+        {
+            // The coroutine has finished or failed with an error, in which case the
+            // calls that were active did not generate a return event
+            while (!previous->second.frames.empty()) {
+                popFrame(previous->second, now);
+            }
+            _threads.erase(previous);
+            lua_rawgetp(thread, LUA_REGISTRYINDEX, &ThreadsKey);
+            lua_pushnil(thread);
+            lua_rawsetp(thread, -2, p);
+            lua_pop(thread, 1);
+        }
+        // Otherwise the previous thread resumed this one and its calls continue
+    }
+    _currentThread = thread;
+
+    const auto it = _threads.find(thread);
+    if (it != _threads.end() && it->second.isSuspended) {
+        // The time during which the coroutine was suspended is not part of its calls
+        const Clock::duration suspended = now - it->second.suspendedAt;
+        for (Frame& frame : it->second.frames) {
+            frame.start += suspended;
+        }
+        it->second.isSuspended = false;
+    }
+}
+
+void LuaProfiler::popFrame(Thread& thread, Clock::time_point now) {
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    const Frame frame = thread.frames.back();
+    thread.frames.pop_back();
+
+    const Clock::duration duration = now - frame.start;
+    const uint64_t nAllocations = _nAllocations - frame.nAllocationsStart;
+    const uint64_t allocatedBytes = _allocatedBytes - frame.allocatedBytesStart;
+
+    Function& function = _functions[frame.function];
+    FunctionStatistics& s = function.statistics;
+    s.exclusiveTime += duration_cast<nanoseconds>(duration - frame.childTime);
+    s.nAllocations += nAllocations - frame.childAllocations;
+    s.allocatedBytes += allocatedBytes - frame.childAllocatedBytes;
+    function.nActive--;
+    if (function.nActive == 0) {
+        // Only the outermost of recursive calls contributes to the inclusive time
+        s.inclusiveTime += duration_cast<nanoseconds>(duration);
+    }
+
+    if (!thread.frames.empty()) {
+        Frame& parent = thread.frames.back();
+        parent.childTime += duration;
+        parent.childAllocations += nAllocations;
+        parent.childAllocatedBytes += allocatedBytes;
+    }
+
+#ifdef TRACY_ENABLE
+    if (frame.hasZone) {
+        ___tracy_emit_zone_end(TracyCZoneCtx{ frame.zoneId, frame.zoneActive });
+    }
+#endif // TRACY_ENABLE
+
+    if (_recordTrace) {
+        _trace.push_back({ frame.function, thread.id, frame.start - _epoch, duration });
+    }
+}
+
+} // namespace ghoul::lua
@@ -0,0 +1,109 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/lua/luastatepool.h>
+
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/misc/assert.h>
+
+namespace ghoul::lua {
+
+LuaStatePool::Handle::Handle(LuaStatePool* pool, std::unique_ptr<LuaState> state)
+    : _pool(pool)
+    , _state(std::move(state))
+{}
+
+LuaStatePool::Handle& LuaStatePool::Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        release();
+        _pool = other._pool;
+        _state = std::move(other._state);
+    }
+    return *this;
+}
+
+LuaStatePool::Handle::~Handle() {
+    release();
+}
+
+LuaStatePool::Handle::operator lua_State*() const {
+    return _state ? static_cast<lua_State*>(*_state) : nullptr;
+}
+
+void LuaStatePool::Handle::release() {
+    if (_state) {
+        _pool->giveBack(std::move(_state));
+    }
+}
+
+LuaStatePool::LuaStatePool(int nStates, LuaState::IncludeStandardLibrary include,
+                           LuaState::StrictState strict)
+    : _include(include)
+    , _strict(strict)
+{
+    ghoul_assert(nStates >= 0, "nStates must not be negative");
+
+    _idleStates.reserve(nStates);
+    for (int i = 0; i < nStates; ++i) {
+        _idleStates.push_back(std::make_unique<LuaState>(_include, _strict));
+    }
+}
+
+LuaStatePool::Handle LuaStatePool::checkout() {
+    {
+        std::lock_guard lock(_mutex);
+        if (!_idleStates.empty()) {
+            std::unique_ptr<LuaState> state = std::move(_idleStates.back());
+            _idleStates.pop_back();
+            return Handle(this, std::move(state));
+        }
+    }
+
+    // Creating the state is the expensive part, so it happens outside of the lock
+    return Handle(this, std::make_unique<LuaState>(_include, _strict));
+}
+
+int LuaStatePool::nIdleStates() const {
+    std::lock_guard lock(_mutex);
+    return static_cast<int>(_idleStates.size());
+}
+
+void LuaStatePool::clear() {
+    std::vector<std::unique_ptr<LuaState>> states;
+    {
+        std::lock_guard lock(_mutex);
+        states.swap(_idleStates);
+    }
+}
+
+void LuaStatePool::giveBack(std::unique_ptr<LuaState> state) {
+    // Remove whatever the previous user left on the stack, for example after an error
+    lua_settop(*state, 0);
+
+    std::lock_guard lock(_mutex);
+    _idleStates.push_back(std::move(state));
+}
+
+} // namespace ghoul::lua
@@ -102,6 +102,10 @@ Buffer::size_type Buffer::size() const {
     return _offsetWrite;
 }
 
+Buffer::size_type Buffer::remainingSize() const {
+    return _offsetWrite > _offsetRead ? _offsetWrite - _offsetRead : 0;
+}
+
 void Buffer::write(const std::string& filename, Compress compress) const {
     std::ofstream file;
     file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
@@ -110,7 +114,9 @@ void Buffer::write(const std::string& filename, Compress compress) const {
     const bool c = compress == Compress::Yes;
     file.write(reinterpret_cast<const char*>(&c), sizeof(bool));
     if (compress == Compress::Yes) {
-        std::vector<value_type> buffer(size());
+        std::vector<value_type> buffer(
+            LZ4_compressBound(static_cast<int>(_offsetWrite))
+        );
         const int compressedSize = LZ4_compress(
             reinterpret_cast<const char*>(_data.data()),
             reinterpret_cast<char*>(buffer.data()),
@@ -186,14 +192,15 @@ void Buffer::serialize(const value_type* data, size_t size) {
     ghoul_assert(data, "Data must not be nullptr");
 
     _data.resize(_data.capacity() + size);
-    std::memcpy(_data.data() + _offsetWrite, &data, size);
+    std::memcpy(_data.data() + _offsetWrite, data, size);
     _offsetWrite += size;
 }
 
 void Buffer::deserialize(value_type* data, size_t size) {
     ghoul_assert(data, "Data must not be nullptr");
+    ghoul_assert(_offsetRead + size <= _data.size(), "Insufficient buffer size");
 
-    std::memcpy(data, &_data + _offsetRead, size);
+    std::memcpy(data, _data.data() + _offsetRead, size);
     _offsetRead += size;
 }
 
@@ -26,22 +26,287 @@
 #include <ghoul/misc/dictionary.h>
 
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/crc32.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <optional>
 
 namespace ghoul {
 
 namespace {
-    // List of types that are stored as-is in the Dictionary
+    using internal::PmrString;
+    using internal::PmrVector;
+    using Allocator = pmr::polymorphic_allocator<std::byte>;
+
+    // List of non-glm types that can be stored in the Dictionary
     using DirectTypes = std::variant<bool, double, int, std::string, Dictionary,
         std::vector<int>, std::vector<double>, std::vector<std::string>>;
     template <typename T> using isDirectType = internal::is_one_of<T, DirectTypes>;
 
-    // Vector types that are converted into std::vector for storage purposes
+    // The std::vector types that are interchangeable with the glm types
+    using NumberVectorTypes = std::variant<std::vector<int>, std::vector<double>>;
+    template <typename T> using isNumberVector =
+        internal::is_one_of<T, NumberVectorTypes>;
+
+    // Vector and matrix types that are stored natively, but that can also be retrieved
+    // from and as std::vectors of the same value type and number of components
     using GLMTypes = std::variant<glm::ivec2, glm::ivec3, glm::ivec4, glm::dvec2,
     glm::dvec3, glm::dvec4, glm::dmat2x2, glm::dmat2x3, glm::dmat2x4, glm::dmat3x2,
         glm::dmat3x3, glm::dmat3x4, glm::dmat4x2, glm::dmat4x3, glm::dmat4x4>;
     template <typename T> using isGLMType = internal::is_one_of<T, GLMTypes>;
+
+    // Maps the types that can be stored in the Dictionary to the types that are used to
+    // store them, which allocate their memory from the Dictionary's memory resource
+    template <typename T> struct StoredType { using type = T; };
+    template <> struct StoredType<std::string> { using type = PmrString; };
+    template <> struct StoredType<std::vector<int>> { using type = PmrVector<int>; };
+    template <> struct StoredType<std::vector<double>> {
+        using type = PmrVector<double>;
+    };
+    template <> struct StoredType<std::vector<std::string>> {
+        using type = PmrVector<PmrString>;
+    };
+    template <typename T> using StoredType_t = typename StoredType<T>::type;
+
+    // Converts the \p value into the type that is used to store it, allocating any
+    // memory from \p alloc
+    template <typename T>
+    StoredType_t<T> toStored(T value, const Allocator& alloc) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return PmrString(value.data(), value.size(), alloc);
+        }
+        else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+            PmrVector<PmrString> res(alloc);
+            res.reserve(value.size());
+            for (const std::string& v : value) {
+                res.emplace_back(v.data(), v.size());
+            }
+            return res;
+        }
+        else if constexpr (std::is_same_v<StoredType_t<T>, T>) {
+            return value;
+        }
+        else {
+            return StoredType_t<T>(value.begin(), value.end(), alloc);
+        }
+    }
+
+    // Converts the stored \p value back into the type T
+    template <typename T>
+    T fromStored(const StoredType_t<T>& value) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(value.data(), value.size());
+        }
+        else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+            std::vector<std::string> res;
+            res.reserve(value.size());
+            for (const PmrString& v : value) {
+                res.emplace_back(v.data(), v.size());
+            }
+            return res;
+        }
+        else if constexpr (std::is_same_v<StoredType_t<T>, T>) {
+            return value;
+        }
+        else {
+            return T(value.begin(), value.end());
+        }
+    }
+
+    // A view of contiguous numbers of type T
+    template <typename T>
+    struct NumberSpan {
+        const T* data = nullptr;
+        size_t size = 0;
+    };
+
+    // Returns the numbers stored in the \p value if it contains a vector of T or a glm
+    // type whose value_type is T, or std::nullopt otherwise
+    template <typename T, typename Variant>
+    std::optional<NumberSpan<T>> numberSpan(const Variant& value) {
+        return std::visit(
+            [](const auto& v) -> std::optional<NumberSpan<T>> {
+                using U = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<U, PmrVector<T>>) {
+                    return NumberSpan<T>{ v.data(), v.size() };
+                }
+                else if constexpr (isGLMType<U>::value) {
+                    if constexpr (std::is_same_v<typename U::value_type, T>) {
+                        return NumberSpan<T>{
+                            glm::value_ptr(v),
+                            static_cast<size_t>(ghoul::glm_components<U>::value)
+                        };
+                    }
+                    else {
+                        return std::nullopt;
+                    }
+                }
+                else {
+                    return std::nullopt;
+                }
+            },
+            value
+        );
+    }
+
+    // Compares two stored values. glm types compare equal to other glm types or
+    // std::vectors that contain the same numbers, as those are interchangeable
+    template <typename Variant>
+    bool isEqual(const Variant& lhs, const Variant& rhs) {
+        if (lhs.index() == rhs.index()) {
+            return lhs == rhs;
+        }
+
+        auto compare = [](const auto& l, const auto& r) {
+            return l && r && l->size == r->size &&
+                std::equal(l->data, l->data + l->size, r->data);
+        };
+        return compare(numberSpan<double>(lhs), numberSpan<double>(rhs)) ||
+            compare(numberSpan<int>(lhs), numberSpan<int>(rhs));
+    }
+
+    // Finalizer of the SplitMix64 generator, which spreads every bit of x over the whole
+    // result
+    constexpr uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Adds the \p value to the hash \p seed such that the result depends on the order
+    // in which the values are added
+    constexpr uint64_t combine(uint64_t seed, uint64_t value) {
+        return mix(seed + 0x9e3779b97f4a7c15ULL + value);
+    }
+
+    // Tags that distinguish the kinds of values in the hash. glm types and std::vectors
+    // share a tag as they compare equal if they contain the same numbers
+    enum class HashTag : uint64_t {
+        Bool = 1, Int, Double, String, Dictionary, Ints, Doubles, Strings
+    };
+
+    uint64_t hashNumber(int value) {
+        return static_cast<uint64_t>(static_cast<int64_t>(value));
+    }
+
+    uint64_t hashNumber(double value) {
+        // -0.0 and 0.0 compare equal and thus need the same hash
+        const double v = (value == 0.0) ? 0.0 : value;
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return bits;
+    }
+
+    uint64_t hashString(std::string_view value) {
+        return static_cast<uint64_t>(std::hash<std::string_view>()(value));
+    }
+
+    template <typename T>
+    uint64_t hashNumbers(HashTag tag, const NumberSpan<T>& span) {
+        uint64_t h = combine(static_cast<uint64_t>(tag), span.size);
+        for (size_t i = 0; i < span.size; ++i) {
+            h = combine(h, hashNumber(span.data[i]));
+        }
+        return h;
+    }
+
+    // The number of entries up to which the entries are kept sorted by key and a lookup
+    // scans the packed hashes linearly. Above this threshold, new entries are appended
+    // and an open-addressing hash table is maintained instead
+    constexpr size_t HashIndexThreshold = 16;
 } // namespace
 
+struct Dictionary::Storage {
+    struct Entry {
+        PmrString key;
+        StorageTypes value;
+    };
+
+    /// Creates an empty storage that allocates its memory from \p alloc
+    explicit Storage(const Allocator& alloc);
+
+    /// Creates a copy of \p other that allocates its memory from \p alloc. Nested
+    /// Dictionaries that use the same memory resource are shared rather than copied
+    Storage(const Storage& other, const Allocator& alloc);
+
+    // Copies have to specify their memory resource explicitly, as the copy constructors
+    // of the pmr containers would fall back to the default memory resource
+    Storage(const Storage&) = delete;
+    Storage& operator=(const Storage&) = delete;
+
+    /// Creates an empty storage whose memory, including that for the storage itself, is
+    /// allocated from the \p resource
+    static std::shared_ptr<Storage> create(pmr::memory_resource* resource);
+
+    /// Creates a copy of \p other whose memory, including that for the storage itself, is
+    /// allocated from the \p resource
+    static std::shared_ptr<Storage> create(const Storage& other,
+        pmr::memory_resource* resource);
+
+    /// Returns the storage of \p dictionary or an empty storage if it has none
+    static const Storage& of(const Dictionary& dictionary);
+
+    /// Returns the \p dictionary if it uses \p resource or is empty, or a copy of it that
+    /// allocates all of its memory from \p resource otherwise
+    static Dictionary withResource(const Dictionary& dictionary,
+        pmr::memory_resource* resource);
+
+    /// Copies the \p value, allocating any memory it requires from \p alloc
+    static StorageTypes copyValue(const StorageTypes& value, const Allocator& alloc);
+
+    /// Returns the memory resource from which this storage allocates its memory
+    pmr::memory_resource* resource() const;
+
+    /**
+     * Returns the position of the single segment \p key with the CRC32 \p hash in the
+     * list of entries, or \c -1 if it does not exist.
+     */
+    int findIndex(std::string_view key, unsigned int hash) const;
+
+    /// Returns the slot in the hash table that refers to the entry at position \p i
+    size_t findSlot(int i) const;
+
+    /// Stores the \p value for the single segment \p key, overwriting existing values.
+    /// Any memory owned by \p value has to be allocated from this storage's resource
+    void insertOrAssign(std::string_view key, StorageTypes value);
+
+    /// Removes the entry at position \p i
+    void erase(int i);
+
+    /// Recreates the hash table for the current entries or, if the number of entries has
+    /// fallen to or below the HashIndexThreshold, removes it and sorts the entries
+    void rebuildIndex();
+
+    /// Returns the structural hash of the entries, which is computed on the first call
+    uint64_t structuralHash() const;
+
+    /// Returns the structural hash of a single stored \p value
+    static uint64_t hashValue(const StorageTypes& value);
+
+    /// All stored values. They are sorted by key while the hash table is unused and in
+    /// insertion order otherwise
+    PmrVector<Entry> entries;
+
+    /// The CRC32 hash of each key in entries. They are stored separately so that
+    /// scanning small Dictionaries only touches a single contiguous array
+    PmrVector<unsigned int> hashes;
+
+    /// Open-addressing hash table with linear probing that contains the position of an
+    /// entry plus one, so that 0 marks an empty slot. This table is empty as long as the
+    /// Dictionary contains at most HashIndexThreshold entries
+    PmrVector<unsigned int> index;
+
+    /// The cached result of structuralHash or 0 if it has not been computed yet. The
+    /// storage might be shared between threads, which all compute the same value
+    mutable std::atomic<uint64_t> cachedHash = 0;
+};
+
 Dictionary::KeyError::KeyError(std::string msg)
     : RuntimeError(std::move(msg), "Dictionary")
 {}
@@ -50,82 +315,157 @@ Dictionary::ValueError::ValueError(std::string k, std::string m)
     : RuntimeError(fmt::format("Key '{}': {}", std::move(k), std::move(m)), "Dictionary")
 {}
 
+Dictionary::Dictionary(pmr::memory_resource* resource)
+    : _storage(Storage::create(resource))
+{
+    ghoul_assert(resource, "Memory resource must not be nullptr");
+}
+
+pmr::memory_resource* Dictionary::memoryResource() const {
+    return _storage ? _storage->resource() : pmr::get_default_resource();
+}
+
 bool Dictionary::operator==(const Dictionary& rhs) const noexcept {
-    return _storage == rhs._storage;
+    if (_storage == rhs._storage) {
+        return true;
+    }
+
+    const Storage& lhsStorage = Storage::of(*this);
+    const Storage& rhsStorage = Storage::of(rhs);
+    if (lhsStorage.entries.size() != rhsStorage.entries.size()) {
+        return false;
+    }
+
+    // Different hashes prove that the Dictionaries differ, but they are only used if they
+    // have already been computed as computing them requires visiting all values anyway
+    const uint64_t lhsHash = lhsStorage.cachedHash.load(std::memory_order_relaxed);
+    const uint64_t rhsHash = rhsStorage.cachedHash.load(std::memory_order_relaxed);
+    if (lhsHash != 0 && rhsHash != 0 && lhsHash != rhsHash) {
+        return false;
+    }
+
+    for (size_t i = 0; i < lhsStorage.entries.size(); ++i) {
+        const Storage::Entry& e = lhsStorage.entries[i];
+        const int j = rhsStorage.findIndex(e.key, lhsStorage.hashes[i]);
+        if (j == -1 || !isEqual(e.value, rhsStorage.entries[j].value)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool Dictionary::operator!=(const Dictionary& rhs) const noexcept {
-    return _storage != rhs._storage;
+    return !(*this == rhs);
 }
 
 template <typename T, std::enable_if_t<Dictionary::IsAllowedType<T>{}, int>>
-void Dictionary::setValue(std::string key, T value) {
+void Dictionary::setValue(std::string_view key, T value) {
     ghoul_assert(!key.empty(), "Key must not be empty");
-    if constexpr (isDirectType<T>::value) {
-        _storage.insert_or_assign(std::move(key), std::move(value));
-    }
-    else if constexpr (isGLMType<T>::value) {
-        typename T::value_type* p = glm::value_ptr(value);
-        std::vector<typename T::value_type> vec(p, p + ghoul::glm_components<T>::value);
-        _storage.insert_or_assign(std::move(key), std::move(vec));
+    Storage& storage = mutableStorage();
+    if constexpr (std::is_same_v<T, Dictionary>) {
+        storage.insertOrAssign(
+            key,
+            StorageTypes(
+                std::in_place_type<Dictionary>,
+                Storage::withResource(value, storage.resource())
+            )
+        );
     }
     else {
-        static_assert(sizeof(T) == 0, "Unsupported type");
+        storage.insertOrAssign(
+            key,
+            StorageTypes(
+                std::in_place_type<StoredType_t<T>>,
+                toStored(std::move(value), storage.entries.get_allocator())
+            )
+        );
     }
 }
 
 template <typename T, std::enable_if_t<Dictionary::IsAllowedType<T>{}, int>>
 T Dictionary::value(std::string_view key) const {
     ghoul_assert(!key.empty(), "Key must not be empty");
-    const size_t dotPos = key.find('.');
-    if (dotPos != std::string_view::npos) {
-        std::string_view before = key.substr(0, dotPos);
-        std::string_view after = key.substr(dotPos + 1);
+    const Dictionary* parent = this;
+    for (size_t dotPos = key.find('.');
+         dotPos != std::string_view::npos;
+         dotPos = key.find('.'))
+    {
+        const std::string_view segment = key.substr(0, dotPos);
+        parent = &parent->childDictionary(segment, hashCRC32(segment));
+        key = key.substr(dotPos + 1);
+    }
+    return parent->valueInternal<T>(key, hashCRC32(key));
+}
 
-        ghoul::Dictionary d = value<ghoul::Dictionary>(before);
-        return d.value<T>(after);
+template <typename T, std::enable_if_t<Dictionary::IsAllowedType<T>{}, int>>
+T Dictionary::value(const Key& key) const {
+    const Dictionary* parent = this;
+    for (int i = 0; i < key._nSegments - 1; ++i) {
+        const Key::Segment& segment = key._segments[i];
+        parent = &parent->childDictionary(segment.name, segment.hash);
     }
+    const Key::Segment& last = key._segments[key._nSegments - 1];
+    return parent->valueInternal<T>(last.name, last.hash);
+}
 
-    auto it = _storage.find(key);
-    if (it == _storage.end()) {
+template <typename T>
+T Dictionary::valueInternal(std::string_view key, unsigned int hash) const {
+    const StorageTypes* stored = find(key, hash);
+    if (!stored) {
         throw KeyError(fmt::format("Could not find key '{}'", key));
     }
 
+    if (const StoredType_t<T>* v = std::get_if<StoredType_t<T>>(stored)) {
+        return fromStored<T>(*v);
+    }
+
     if constexpr (isDirectType<T>::value) {
-        if (std::holds_alternative<T>(it->second)) {
-            return std::get<T>(it->second);
-        }
-        else {
-            throw ValueError(
-                std::string(key),
-                fmt::format(
-                    "Error accessing value, wanted type '{}' has '{}'",
-                    typeid(T).name(), it->second.index()
-                )
-            );
+        if constexpr (isNumberVector<T>::value) {
+            // glm vectors and matrices can be retrieved as a std::vector
+            using VT = typename T::value_type;
+            if (std::optional<NumberSpan<VT>> span = numberSpan<VT>(*stored)) {
+                return T(span->data, span->data + span->size);
+            }
         }
+
+        throw ValueError(
+            std::string(key),
+            fmt::format(
+                "Error accessing value, wanted type '{}' has '{}'",
+                typeid(T).name(), stored->index()
+            )
+        );
     }
     else if constexpr (isGLMType<T>::value) {
-        using VT = std::vector<typename T::value_type>;
-        VT vec;
-        if (std::holds_alternative<VT>(it->second)) {
-            vec = std::get<VT>(it->second);
-        }
-        else if (std::holds_alternative<ghoul::Dictionary>(it->second)) {
-            ghoul::Dictionary d = std::get<ghoul::Dictionary>(it->second);
-            vec.resize(d._storage.size());
-            for (const auto& kv : d._storage) {
+        using VT = typename T::value_type;
+        constexpr size_t NValues = ghoul::glm_components<T>::value;
+
+        T res;
+        VT* values = glm::value_ptr(res);
+        size_t nValues = 0;
+        if (std::optional<NumberSpan<VT>> span = numberSpan<VT>(*stored)) {
+            nValues = span->size;
+            if (nValues == NValues) {
+                std::memcpy(values, span->data, sizeof(T));
+            }
+        }
+        else if (const Dictionary* d = std::get_if<Dictionary>(stored)) {
+            const PmrVector<Storage::Entry>& entries = Storage::of(*d).entries;
+            nValues = entries.size();
+            for (const Storage::Entry& e : entries) {
                 // Lua is 1-based index, the rest of the world is 0-based
-                int k = std::stoi(kv.first) - 1;
-                if (k < 0 || k >= static_cast<int>(d._storage.size())) {
+                int k = std::stoi(std::string(e.key)) - 1;
+                if (k < 0 || k >= static_cast<int>(entries.size())) {
                     throw ValueError(
                         std::string(key),
                         fmt::format(
-                            "Invalid key {} outside range [0,{}]", k, d._storage.size()
+                            "Invalid key {} outside range [0,{}]", k, entries.size()
                         )
                     );
                 }
-                vec[k] = std::get<typename T::value_type>(kv.second);
+                if (nValues == NValues) {
+                    values[k] = std::get<VT>(e.value);
+                }
             }
         }
         else {
@@ -134,23 +474,20 @@ T Dictionary::value(std::string_view key) const {
                 fmt::format(
                     "Requested {} but did not contain {} or {}",
                     typeid(T).name(), typeid(T).name(),
-                    typeid(std::vector<typename T::value_type>).name()
+                    typeid(std::vector<VT>).name()
                 )
             );
         }
 
-        if (vec.size() != ghoul::glm_components<T>::value) {
+        if (nValues != NValues) {
             throw ValueError(
                 std::string(key),
                 fmt::format(
                     "Contained wrong number of values. Expected {} got {}",
-                    ghoul::glm_components<T>::value, vec.size()
+                    NValues, nValues
                 )
             );
         }
-
-        T res;
-        std::memcpy(glm::value_ptr(res), vec.data(), sizeof(T));
         return res;
     }
     else {
@@ -161,38 +498,48 @@ T Dictionary::value(std::string_view key) const {
 template <typename T, std::enable_if_t<Dictionary::IsAllowedType<T>{}, int>>
 bool Dictionary::hasValue(std::string_view key) const {
     ghoul_assert(!key.empty(), "Key must not be empty");
-    const size_t dotPos = key.find('.');
-    if (dotPos != std::string_view::npos) {
-        std::string_view before = key.substr(0, dotPos);
-        std::string_view after = key.substr(dotPos + 1);
+    const Dictionary* parent = findParent(key);
+    return parent && parent->hasValueInternal<T>(key, hashCRC32(key));
+}
 
-        if (hasValue<ghoul::Dictionary>(before)) {
-            ghoul::Dictionary d = value<ghoul::Dictionary>(before);
-            return d.hasValue<T>(after);
-        }
-        else {
-            return false;
-        }
-    }
+template <typename T, std::enable_if_t<Dictionary::IsAllowedType<T>{}, int>>
+bool Dictionary::hasValue(const Key& key) const {
+    const Dictionary* parent = findParent(key);
+    const Key::Segment& last = key._segments[key._nSegments - 1];
+    return parent && parent->hasValueInternal<T>(last.name, last.hash);
+}
 
-    auto it = _storage.find(key);
-    if (it == _storage.end()) {
+template <typename T>
+bool Dictionary::hasValueInternal(std::string_view key, unsigned int hash) const {
+    const StorageTypes* stored = find(key, hash);
+    if (!stored) {
         return false;
     }
+    if (std::holds_alternative<StoredType_t<T>>(*stored)) {
+        return true;
+    }
+
     if constexpr (isDirectType<T>::value) {
-        return std::holds_alternative<T>(it->second);
+        if constexpr (isNumberVector<T>::value) {
+            return numberSpan<typename T::value_type>(*stored).has_value();
+        }
+        else {
+            return false;
+        }
     }
     else if constexpr (isGLMType<T>::value) {
-        if (std::holds_alternative<ghoul::Dictionary>(it->second)) {
-            ghoul::Dictionary d = std::get<ghoul::Dictionary>(it->second);
-
-            if (d.size() != ghoul::glm_components<T>::value) {
+        using VT = typename T::value_type;
+        if (std::optional<NumberSpan<VT>> span = numberSpan<VT>(*stored)) {
+            return span->size == ghoul::glm_components<T>::value;
+        }
+        else if (const Dictionary* d = std::get_if<Dictionary>(stored)) {
+            if (d->size() != ghoul::glm_components<T>::value) {
                 return false;
             }
 
             // Check whether we have all keys and they are of the correct type
             for (int i = 1; i <= ghoul::glm_components<T>::value; ++i) {
-                if (!d.hasValue<typename T::value_type>(std::to_string(i))) {
+                if (!d->hasValue<VT>(std::to_string(i))) {
                     return false;
                 }
             }
@@ -201,9 +548,7 @@ bool Dictionary::hasValue(std::string_view key) const {
             return true;
         }
         else {
-            using VT = std::vector<typename T::value_type>;
-            return std::holds_alternative<VT>(it->second) &&
-                std::get<VT>(it->second).size() == ghoul::glm_components<T>::value;
+            return false;
         }
     }
     else {
@@ -213,52 +558,159 @@ bool Dictionary::hasValue(std::string_view key) const {
 
 bool Dictionary::hasKey(std::string_view key) const {
     ghoul_assert(!key.empty(), "Key must not be empty");
-    const size_t dotPos = key.find('.');
-    if (dotPos != std::string_view::npos) {
-        std::string_view before = key.substr(0, dotPos);
-        std::string_view after = key.substr(dotPos + 1);
+    const Dictionary* parent = findParent(key);
+    return parent && parent->find(key, hashCRC32(key));
+}
+
+bool Dictionary::hasKey(const Key& key) const {
+    const Dictionary* parent = findParent(key);
+    const Key::Segment& last = key._segments[key._nSegments - 1];
+    return parent && parent->find(last.name, last.hash);
+}
+
+const Dictionary* Dictionary::subDictionary(std::string_view key) const {
+    ghoul_assert(!key.empty(), "Key must not be empty");
+    const Dictionary* parent = findParent(key);
+    if (!parent) {
+        return nullptr;
+    }
 
-        if (hasKey(before)) {
-            ghoul::Dictionary d = value<ghoul::Dictionary>(before);
-            return d.hasKey(after);
+    const StorageTypes* stored = parent->find(key, hashCRC32(key));
+    return stored ? std::get_if<Dictionary>(stored) : nullptr;
+}
+
+const Dictionary* Dictionary::subDictionary(const Key& key) const {
+    const Dictionary* parent = findParent(key);
+    if (!parent) {
+        return nullptr;
+    }
+
+    const Key::Segment& last = key._segments[key._nSegments - 1];
+    const StorageTypes* stored = parent->find(last.name, last.hash);
+    return stored ? std::get_if<Dictionary>(stored) : nullptr;
+}
+
+const Dictionary* Dictionary::findParent(std::string_view& key) const {
+    const Dictionary* parent = this;
+    for (size_t dotPos = key.find('.');
+         dotPos != std::string_view::npos;
+         dotPos = key.find('.'))
+    {
+        const std::string_view segment = key.substr(0, dotPos);
+        const StorageTypes* stored = parent->find(segment, hashCRC32(segment));
+        if (!stored) {
+            return nullptr;
         }
-        else {
-            return false;
+        parent = std::get_if<Dictionary>(stored);
+        if (!parent) {
+            return nullptr;
         }
+        key = key.substr(dotPos + 1);
     }
-    else {
-        auto it = _storage.find(key);
-        return it != _storage.end();
+    return parent;
+}
+
+const Dictionary* Dictionary::findParent(const Key& key) const {
+    const Dictionary* parent = this;
+    for (int i = 0; i < key._nSegments - 1; ++i) {
+        const Key::Segment& segment = key._segments[i];
+        const StorageTypes* stored = parent->find(segment.name, segment.hash);
+        if (!stored) {
+            return nullptr;
+        }
+        parent = std::get_if<Dictionary>(stored);
+        if (!parent) {
+            return nullptr;
+        }
+    }
+    return parent;
+}
+
+const Dictionary& Dictionary::childDictionary(std::string_view key,
+                                              unsigned int hash) const
+{
+    const StorageTypes* stored = find(key, hash);
+    if (!stored) {
+        throw KeyError(fmt::format("Could not find key '{}'", key));
     }
+
+    const Dictionary* d = std::get_if<Dictionary>(stored);
+    if (!d) {
+        throw ValueError(
+            std::string(key),
+            fmt::format(
+                "Error accessing value, wanted type '{}' has '{}'",
+                typeid(Dictionary).name(), stored->index()
+            )
+        );
+    }
+    return *d;
 }
 
 std::vector<std::string_view> Dictionary::keys() const {
+    const Storage& storage = Storage::of(*this);
     std::vector<std::string_view> keys;
-    keys.reserve(_storage.size());
-    for (const std::pair<const std::string, StorageTypes>& kv : _storage) {
-        keys.push_back(kv.first);
+    keys.reserve(storage.entries.size());
+    for (const Storage::Entry& e : storage.entries) {
+        keys.push_back(e.key);
+    }
+    if (!storage.index.empty()) {
+        // Large Dictionaries store their entries in insertion order, but the keys are
+        // always reported sorted so that it does not depend on the construction order
+        std::sort(keys.begin(), keys.end());
     }
     return keys;
 }
 
+std::vector<std::pair<std::string_view, const Dictionary::StorageTypes*>>
+Dictionary::sortedEntries() const
+{
+    const Storage& storage = Storage::of(*this);
+    std::vector<std::pair<std::string_view, const StorageTypes*>> res;
+    res.reserve(storage.entries.size());
+    for (const Storage::Entry& e : storage.entries) {
+        res.emplace_back(e.key, &e.value);
+    }
+    if (!storage.index.empty()) {
+        std::sort(
+            res.begin(), res.end(),
+            [](const std::pair<std::string_view, const StorageTypes*>& lhs,
+               const std::pair<std::string_view, const StorageTypes*>& rhs)
+            {
+                return lhs.first < rhs.first;
+            }
+        );
+    }
+    return res;
+}
+
 void Dictionary::removeValue(std::string_view key) {
-    if (const auto it = _storage.find(key);  it != _storage.end()) {
-        _storage.erase(it);
+    // Look the key up first to not clone a shared storage if there is nothing to remove
+    const int i = Storage::of(*this).findIndex(key, hashCRC32(key));
+    if (i != -1) {
+        mutableStorage().erase(i);
     }
 }
 
 bool Dictionary::isEmpty() const {
-    return _storage.empty();
+    return Storage::of(*this).entries.empty();
 }
 
 size_t Dictionary::size() const {
-    return _storage.size();
+    return Storage::of(*this).entries.size();
 }
 
 bool Dictionary::isSubset(const ghoul::Dictionary& dict) const {
-    for (const std::pair<const std::string, StorageTypes>& kv : dict._storage) {
-        auto it = _storage.find(kv.first);
-        if (it == _storage.end() || it->second != kv.second) {
+    if (_storage == dict._storage) {
+        return true;
+    }
+
+    const Storage& storage = Storage::of(*this);
+    const Storage& subset = Storage::of(dict);
+    for (size_t i = 0; i < subset.entries.size(); ++i) {
+        const Storage::Entry& e = subset.entries[i];
+        const int j = storage.findIndex(e.key, subset.hashes[i]);
+        if (j == -1 || !isEqual(storage.entries[j].value, e.value)) {
             return false;
         }
     }
@@ -267,29 +719,461 @@ bool Dictionary::isSubset(const ghoul::Dictionary& dict) const {
     return true;
 }
 
-template void Dictionary::setValue(std::string, Dictionary value);
-template void Dictionary::setValue(std::string, bool value);
-template void Dictionary::setValue(std::string, double);
-template void Dictionary::setValue(std::string, int);
-template void Dictionary::setValue(std::string, std::string);
-template void Dictionary::setValue(std::string, std::vector<int>);
-template void Dictionary::setValue(std::string, std::vector<double>);
-template void Dictionary::setValue(std::string, std::vector<std::string>);
-template void Dictionary::setValue(std::string, glm::ivec2);
-template void Dictionary::setValue(std::string, glm::ivec3);
-template void Dictionary::setValue(std::string, glm::ivec4);
-template void Dictionary::setValue(std::string, glm::dvec2);
-template void Dictionary::setValue(std::string, glm::dvec3);
-template void Dictionary::setValue(std::string, glm::dvec4);
-template void Dictionary::setValue(std::string, glm::dmat2x2);
-template void Dictionary::setValue(std::string, glm::dmat2x3);
-template void Dictionary::setValue(std::string, glm::dmat2x4);
-template void Dictionary::setValue(std::string, glm::dmat3x2);
-template void Dictionary::setValue(std::string, glm::dmat3x3);
-template void Dictionary::setValue(std::string, glm::dmat3x4);
-template void Dictionary::setValue(std::string, glm::dmat4x2);
-template void Dictionary::setValue(std::string, glm::dmat4x3);
-template void Dictionary::setValue(std::string, glm::dmat4x4);
+uint64_t Dictionary::hash() const {
+    return Storage::of(*this).structuralHash();
+}
+
+Dictionary::Patch Dictionary::diff(const Dictionary& from, const Dictionary& to) {
+    Patch patch;
+    diffEntries(from, to, patch);
+    return patch;
+}
+
+void Dictionary::diffEntries(const Dictionary& from, const Dictionary& to, Patch& patch) {
+    // Different hashes prove that the Dictionaries differ. Equal hashes are confirmed by
+    // comparing the values, as a hash collision would otherwise drop changes
+    if (from._storage == to._storage || (from.hash() == to.hash() && from == to)) {
+        return;
+    }
+
+    pmr::memory_resource* resource = to.memoryResource();
+    auto set = [&patch, resource](std::string_view key, const StorageTypes& value) {
+        Change change;
+        change.type = Change::Type::Set;
+        change.key = std::string(key);
+        change.value = Storage::copyValue(value, Allocator(resource));
+        patch.push_back(std::move(change));
+    };
+
+    // Both lists of entries are sorted by key, so they can be merged in a single pass
+    const auto fromEntries = from.sortedEntries();
+    const auto toEntries = to.sortedEntries();
+    auto f = fromEntries.begin();
+    auto t = toEntries.begin();
+    while (f != fromEntries.end() || t != toEntries.end()) {
+        if (t == toEntries.end() || (f != fromEntries.end() && f->first < t->first)) {
+            Change change;
+            change.type = Change::Type::Remove;
+            change.key = std::string(f->first);
+            patch.push_back(std::move(change));
+            ++f;
+        }
+        else if (f == fromEntries.end() || t->first < f->first) {
+            set(t->first, *t->second);
+            ++t;
+        }
+        else {
+            const Dictionary* fromDict = std::get_if<Dictionary>(f->second);
+            const Dictionary* toDict = std::get_if<Dictionary>(t->second);
+            if (fromDict && toDict) {
+                Change change;
+                change.type = Change::Type::Modify;
+                diffEntries(*fromDict, *toDict, change.changes);
+                if (!change.changes.empty()) {
+                    change.key = std::string(t->first);
+                    patch.push_back(std::move(change));
+                }
+            }
+            else if (!isEqual(*f->second, *t->second)) {
+                set(t->first, *t->second);
+            }
+            ++f;
+            ++t;
+        }
+    }
+}
+
+void Dictionary::apply(const Patch& patch) {
+    // Applying the changes to a copy, which only clones the modified parts of the tree,
+    // leaves this Dictionary unchanged if one of the changes fails
+    Dictionary res = *this;
+    res.applyInPlace(patch);
+    *this = std::move(res);
+}
+
+void Dictionary::applyInPlace(const Patch& patch) {
+    for (const Change& change : patch) {
+        const unsigned int hash = hashCRC32(change.key);
+        switch (change.type) {
+            case Change::Type::Set:
+            {
+                Storage& storage = mutableStorage();
+                storage.insertOrAssign(
+                    change.key,
+                    Storage::copyValue(change.value, storage.entries.get_allocator())
+                );
+                break;
+            }
+            case Change::Type::Remove:
+                if (const int i = Storage::of(*this).findIndex(change.key, hash);
+                    i != -1)
+                {
+                    mutableStorage().erase(i);
+                }
+                break;
+            case Change::Type::Modify:
+            {
+                // The copy shares the values with the stored Dictionary, so only the
+                // modified parts are cloned
+                Dictionary child = childDictionary(change.key, hash);
+                child.applyInPlace(change.changes);
+                mutableStorage().insertOrAssign(
+                    change.key,
+                    StorageTypes(std::in_place_type<Dictionary>, std::move(child))
+                );
+                break;
+            }
+        }
+    }
+}
+
+const Dictionary::StorageTypes* Dictionary::find(std::string_view key,
+                                                 unsigned int hash) const
+{
+    const Storage& storage = Storage::of(*this);
+    const int i = storage.findIndex(key, hash);
+    return i != -1 ? &storage.entries[i].value : nullptr;
+}
+
+Dictionary::Storage& Dictionary::mutableStorage() {
+    if (!_storage) {
+        _storage = Storage::create(pmr::get_default_resource());
+    }
+    else if (_storage.use_count() > 1) {
+        // The storage is shared with other Dictionaries, so we have to create our own
+        // copy. Nested Dictionaries in the copy still share their storage
+        _storage = Storage::create(*_storage, _storage->resource());
+    }
+    else {
+        // We are the only owner, but other threads might have released their reference
+        // just now. Their reads of the storage have to happen before our modification
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    // The storage is returned for modification, which invalidates the hash
+    _storage->cachedHash.store(0, std::memory_order_relaxed);
+    return *_storage;
+}
+
+Dictionary::Storage::Storage(const Allocator& alloc)
+    : entries(alloc)
+    , hashes(alloc)
+    , index(alloc)
+{}
+
+Dictionary::Storage::Storage(const Storage& other, const Allocator& alloc)
+    : entries(alloc)
+    , hashes(other.hashes, alloc)
+    , index(other.index, alloc)
+    , cachedHash(other.cachedHash.load(std::memory_order_relaxed))
+{
+    entries.reserve(other.entries.size());
+    for (const Entry& e : other.entries) {
+        entries.push_back({ PmrString(e.key, alloc), copyValue(e.value, alloc) });
+    }
+}
+
+std::shared_ptr<Dictionary::Storage> Dictionary::Storage::create(
+                                                         pmr::memory_resource* resource)
+{
+    return std::allocate_shared<Storage>(
+        pmr::polymorphic_allocator<Storage>(resource),
+        Allocator(resource)
+    );
+}
+
+std::shared_ptr<Dictionary::Storage> Dictionary::Storage::create(const Storage& other,
+                                                         pmr::memory_resource* resource)
+{
+    return std::allocate_shared<Storage>(
+        pmr::polymorphic_allocator<Storage>(resource),
+        other,
+        Allocator(resource)
+    );
+}
+
+const Dictionary::Storage& Dictionary::Storage::of(const Dictionary& dictionary) {
+    static const Storage Empty = Storage(Allocator(pmr::new_delete_resource()));
+    return dictionary._storage ? *dictionary._storage : Empty;
+}
+
+Dictionary Dictionary::Storage::withResource(const Dictionary& dictionary,
+                                             pmr::memory_resource* resource)
+{
+    if (!dictionary._storage || *dictionary._storage->resource() == *resource) {
+        return dictionary;
+    }
+
+    Dictionary res;
+    res._storage = create(*dictionary._storage, resource);
+    return res;
+}
+
+Dictionary::StorageTypes Dictionary::Storage::copyValue(const StorageTypes& value,
+                                                        const Allocator& alloc)
+{
+    return std::visit(
+        [&alloc](const auto& v) {
+            using U = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<U, Dictionary>) {
+                return StorageTypes(
+                    std::in_place_type<Dictionary>,
+                    withResource(v, alloc.resource())
+                );
+            }
+            else if constexpr (std::is_same_v<U, PmrString> ||
+                               std::is_same_v<U, PmrVector<int>> ||
+                               std::is_same_v<U, PmrVector<double>> ||
+                               std::is_same_v<U, PmrVector<PmrString>>)
+            {
+                return StorageTypes(std::in_place_type<U>, v, alloc);
+            }
+            else {
+                return StorageTypes(std::in_place_type<U>, v);
+            }
+        },
+        value
+    );
+}
+
+pmr::memory_resource* Dictionary::Storage::resource() const {
+    return entries.get_allocator().resource();
+}
+
+int Dictionary::Storage::findIndex(std::string_view key, unsigned int hash) const {
+    if (index.empty()) {
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            if (hashes[i] == hash && entries[i].key == key) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    const size_t mask = index.size() - 1;
+    for (size_t slot = hash & mask; index[slot] != 0; slot = (slot + 1) & mask) {
+        const unsigned int i = index[slot] - 1;
+        if (hashes[i] == hash && entries[i].key == key) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+size_t Dictionary::Storage::findSlot(int i) const {
+    ghoul_assert(!index.empty(), "No hash table present");
+    const size_t mask = index.size() - 1;
+    size_t slot = hashes[i] & mask;
+    while (index[slot] != static_cast<unsigned int>(i + 1)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void Dictionary::Storage::insertOrAssign(std::string_view key, StorageTypes value) {
+    const unsigned int hash = hashCRC32(key);
+    if (const int i = findIndex(key, hash);  i != -1) {
+        entries[i].value = std::move(value);
+        return;
+    }
+
+    if (entries.size() < HashIndexThreshold) {
+        auto it = std::lower_bound(
+            entries.begin(), entries.end(),
+            key,
+            [](const Entry& e, std::string_view k) { return e.key < k; }
+        );
+        hashes.insert(hashes.begin() + std::distance(entries.begin(), it), hash);
+        entries.insert(
+            it,
+            { PmrString(key, entries.get_allocator()), std::move(value) }
+        );
+        return;
+    }
+
+    entries.push_back({ PmrString(key, entries.get_allocator()), std::move(value) });
+    hashes.push_back(hash);
+
+    // Keep the load factor of the hash table at or below one half
+    if (entries.size() * 2 > index.size()) {
+        rebuildIndex();
+    }
+    else {
+        const size_t mask = index.size() - 1;
+        size_t slot = hash & mask;
+        while (index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = static_cast<unsigned int>(entries.size());
+    }
+}
+
+void Dictionary::Storage::erase(int i) {
+    if (index.empty()) {
+        // Small Dictionaries have to stay sorted
+        entries.erase(entries.begin() + i);
+        hashes.erase(hashes.begin() + i);
+        return;
+    }
+
+    // Remove the slot of the entry using backward shift deletion, which moves every
+    // following entry of the same probe sequence up by one so no tombstones are needed
+    const size_t mask = index.size() - 1;
+    size_t hole = findSlot(i);
+    for (size_t j = (hole + 1) & mask; index[j] != 0; j = (j + 1) & mask) {
+        const size_t home = hashes[index[j] - 1] & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            index[hole] = index[j];
+            hole = j;
+        }
+    }
+    index[hole] = 0;
+
+    // The last entry is moved into the position of the removed entry
+    const int last = static_cast<int>(entries.size()) - 1;
+    if (i != last) {
+        index[findSlot(last)] = static_cast<unsigned int>(i + 1);
+        entries[i] = std::move(entries.back());
+        hashes[i] = hashes.back();
+    }
+    entries.pop_back();
+    hashes.pop_back();
+
+    if (entries.size() <= HashIndexThreshold) {
+        rebuildIndex();
+    }
+}
+
+void Dictionary::Storage::rebuildIndex() {
+    index.clear();
+    if (entries.size() <= HashIndexThreshold) {
+        index.shrink_to_fit();
+
+        std::vector<size_t> order(entries.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(
+            order.begin(), order.end(),
+            [this](size_t lhs, size_t rhs) { return entries[lhs].key < entries[rhs].key; }
+        );
+        PmrVector<Entry> sortedEntries(entries.get_allocator());
+        sortedEntries.reserve(entries.size());
+        PmrVector<unsigned int> sortedHashes(hashes.get_allocator());
+        sortedHashes.reserve(hashes.size());
+        for (size_t i : order) {
+            sortedEntries.push_back(std::move(entries[i]));
+            sortedHashes.push_back(hashes[i]);
+        }
+        entries = std::move(sortedEntries);
+        hashes = std::move(sortedHashes);
+        return;
+    }
+
+    size_t capacity = 4 * HashIndexThreshold;
+    while (capacity < 4 * entries.size()) {
+        capacity *= 2;
+    }
+    index.resize(capacity, 0);
+
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        size_t slot = hashes[i] & mask;
+        while (index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = static_cast<unsigned int>(i + 1);
+    }
+}
+
+uint64_t Dictionary::Storage::structuralHash() const {
+    if (const uint64_t h = cachedHash.load(std::memory_order_relaxed);  h != 0) {
+        return h;
+    }
+
+    // The entries are combined with a commutative sum so that the hash does not depend
+    // on the order of the entries, which differs between Dictionaries with a hash table
+    // The 32 bit hashes of the keys collide too easily to identify the keys, so the key
+    // itself is hashed as well
+    uint64_t sum = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const uint64_t key = combine(hashes[i], hashString(entries[i].key));
+        sum += mix(combine(key, hashValue(entries[i].value)));
+    }
+    uint64_t h = combine(
+        combine(static_cast<uint64_t>(HashTag::Dictionary), entries.size()),
+        sum
+    );
+    // 0 marks a hash that has not been computed yet
+    if (h == 0) {
+        h = 1;
+    }
+    cachedHash.store(h, std::memory_order_relaxed);
+    return h;
+}
+
+uint64_t Dictionary::Storage::hashValue(const StorageTypes& value) {
+    if (std::optional<NumberSpan<int>> span = numberSpan<int>(value)) {
+        return hashNumbers(HashTag::Ints, *span);
+    }
+    if (std::optional<NumberSpan<double>> span = numberSpan<double>(value)) {
+        return hashNumbers(HashTag::Doubles, *span);
+    }
+
+    return std::visit(
+        [](const auto& v) -> uint64_t {
+            using U = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<U, bool>) {
+                return combine(static_cast<uint64_t>(HashTag::Bool), v ? 1 : 0);
+            }
+            else if constexpr (std::is_same_v<U, int>) {
+                return combine(static_cast<uint64_t>(HashTag::Int), hashNumber(v));
+            }
+            else if constexpr (std::is_same_v<U, double>) {
+                return combine(static_cast<uint64_t>(HashTag::Double), hashNumber(v));
+            }
+            else if constexpr (std::is_same_v<U, PmrString>) {
+                return combine(static_cast<uint64_t>(HashTag::String), hashString(v));
+            }
+            else if constexpr (std::is_same_v<U, Dictionary>) {
+                return v.hash();
+            }
+            else if constexpr (std::is_same_v<U, PmrVector<PmrString>>) {
+                uint64_t h = combine(static_cast<uint64_t>(HashTag::Strings), v.size());
+                for (const PmrString& str : v) {
+                    h = combine(h, hashString(str));
+                }
+                return h;
+            }
+            else {
+                // All number vectors and glm types have been handled above
+                throw MissingCaseException();
+            }
+        },
+        value
+    );
+}
+
+template void Dictionary::setValue(std::string_view, Dictionary value);
+template void Dictionary::setValue(std::string_view, bool value);
+template void Dictionary::setValue(std::string_view, double);
+template void Dictionary::setValue(std::string_view, int);
+template void Dictionary::setValue(std::string_view, std::string);
+template void Dictionary::setValue(std::string_view, std::vector<int>);
+template void Dictionary::setValue(std::string_view, std::vector<double>);
+template void Dictionary::setValue(std::string_view, std::vector<std::string>);
+template void Dictionary::setValue(std::string_view, glm::ivec2);
+template void Dictionary::setValue(std::string_view, glm::ivec3);
+template void Dictionary::setValue(std::string_view, glm::ivec4);
+template void Dictionary::setValue(std::string_view, glm::dvec2);
+template void Dictionary::setValue(std::string_view, glm::dvec3);
+template void Dictionary::setValue(std::string_view, glm::dvec4);
+template void Dictionary::setValue(std::string_view, glm::dmat2x2);
+template void Dictionary::setValue(std::string_view, glm::dmat2x3);
+template void Dictionary::setValue(std::string_view, glm::dmat2x4);
+template void Dictionary::setValue(std::string_view, glm::dmat3x2);
+template void Dictionary::setValue(std::string_view, glm::dmat3x3);
+template void Dictionary::setValue(std::string_view, glm::dmat3x4);
+template void Dictionary::setValue(std::string_view, glm::dmat4x2);
+template void Dictionary::setValue(std::string_view, glm::dmat4x3);
+template void Dictionary::setValue(std::string_view, glm::dmat4x4);
 
 
 template Dictionary Dictionary::value(std::string_view) const;
@@ -316,6 +1200,30 @@ template glm::dmat4x2 Dictionary::value(std::string_view) const;
 template glm::dmat4x3 Dictionary::value(std::string_view) const;
 template glm::dmat4x4 Dictionary::value(std::string_view) const;
 
+template Dictionary Dictionary::value(const Key&) const;
+template bool Dictionary::value(const Key&) const;
+template double Dictionary::value(const Key&) const;
+template int Dictionary::value(const Key&) const;
+template std::string Dictionary::value(const Key&) const;
+template std::vector<int> Dictionary::value(const Key&) const;
+template std::vector<double> Dictionary::value(const Key&) const;
+template std::vector<std::string> Dictionary::value(const Key&) const;
+template glm::ivec2 Dictionary::value(const Key&) const;
+template glm::ivec3 Dictionary::value(const Key&) const;
+template glm::ivec4 Dictionary::value(const Key&) const;
+template glm::dvec2 Dictionary::value(const Key&) const;
+template glm::dvec3 Dictionary::value(const Key&) const;
+template glm::dvec4 Dictionary::value(const Key&) const;
+template glm::dmat2x2 Dictionary::value(const Key&) const;
+template glm::dmat2x3 Dictionary::value(const Key&) const;
+template glm::dmat2x4 Dictionary::value(const Key&) const;
+template glm::dmat3x2 Dictionary::value(const Key&) const;
+template glm::dmat3x3 Dictionary::value(const Key&) const;
+template glm::dmat3x4 Dictionary::value(const Key&) const;
+template glm::dmat4x2 Dictionary::value(const Key&) const;
+template glm::dmat4x3 Dictionary::value(const Key&) const;
+template glm::dmat4x4 Dictionary::value(const Key&) const;
+
 
 template bool Dictionary::hasValue<Dictionary>(std::string_view) const;
 template bool Dictionary::hasValue<bool>(std::string_view) const;
@@ -341,4 +1249,28 @@ template bool Dictionary::hasValue<glm::dmat4x2>(std::string_view) const;
 template bool Dictionary::hasValue<glm::dmat4x3>(std::string_view) const;
 template bool Dictionary::hasValue<glm::dmat4x4>(std::string_view) const;
 
+template bool Dictionary::hasValue<Dictionary>(const Key&) const;
+template bool Dictionary::hasValue<bool>(const Key&) const;
+template bool Dictionary::hasValue<double>(const Key&) const;
+template bool Dictionary::hasValue<int>(const Key&) const;
+template bool Dictionary::hasValue<std::string>(const Key&) const;
+template bool Dictionary::hasValue<std::vector<int>>(const Key&) const;
+template bool Dictionary::hasValue<std::vector<double>>(const Key&) const;
+template bool Dictionary::hasValue<std::vector<std::string>>(const Key&) const;
+template bool Dictionary::hasValue<glm::ivec2>(const Key&) const;
+template bool Dictionary::hasValue<glm::ivec3>(const Key&) const;
+template bool Dictionary::hasValue<glm::ivec4>(const Key&) const;
+template bool Dictionary::hasValue<glm::dvec2>(const Key&) const;
+template bool Dictionary::hasValue<glm::dvec3>(const Key&) const;
+template bool Dictionary::hasValue<glm::dvec4>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat2x2>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat2x3>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat2x4>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat3x2>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat3x3>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat3x4>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat4x2>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat4x3>(const Key&) const;
+template bool Dictionary::hasValue<glm::dmat4x4>(const Key&) const;
+
 } // namespace ghoul
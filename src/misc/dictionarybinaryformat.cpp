@@ -0,0 +1,800 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/dictionarybinaryformat.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/glm.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/crc32.h>
+#include <lz4/lz4.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace ghoul {
+
+namespace {
+    // The serialized Dictionary consists of a Header followed by the serialized values.
+    // The serialized values start with the root Dictionary node. Each node consists of
+    // the number of entries followed by a table of DictionaryView::Entry that is sorted
+    // by the hash of the keys, and then by the keys themselves. All offsets in the table
+    // are relative to the beginning of the serialized values. The type of each entry is
+    // the index of its type in Dictionary::Types. The values are stored as:
+    //   bool:       1 byte
+    //   int:        4 bytes
+    //   double:     8 bytes
+    //   string:     The characters without a null terminator
+    //   Dictionary: A node, which might be shared between multiple entries
+    //   vectors of int and double and glm types:  The components in the order of
+    //               glm::value_ptr
+    //   vector of strings:  The number of strings followed by the offset and length of
+    //               each string and the characters of all strings
+    struct Header {
+        std::array<char, 4> magic;
+        uint8_t version;
+        uint8_t flags;
+        uint16_t reserved;
+        uint32_t valuesSize;
+        uint32_t storedSize;
+    };
+
+    constexpr std::array<char, 4> Magic = { 'G', 'D', 'I', 'C' };
+    constexpr uint8_t Version = 1;
+    constexpr uint8_t FlagCompressed = 1;
+
+    // The deepest nesting of nodes that is accepted, which matches the limit of
+    // parseJson. Deeper data is rejected, as decoding it recursively would exhaust the
+    // stack
+    constexpr size_t MaxDepth = 512;
+
+    static_assert(sizeof(int) == 4, "The binary format requires 32 bit integers");
+    static_assert(sizeof(double) == 8, "The binary format requires 64 bit doubles");
+
+    // Returns the index of T in the variant V
+    template <typename T, typename V> struct IndexOf;
+    template <typename T, typename... Ts>
+    struct IndexOf<T, std::variant<T, Ts...>> : std::integral_constant<uint32_t, 0> {};
+    template <typename T, typename U, typename... Ts>
+    struct IndexOf<T, std::variant<U, Ts...>> :
+        std::integral_constant<uint32_t, 1 + IndexOf<T, std::variant<Ts...>>::value>
+    {};
+
+    template <typename T>
+    constexpr uint32_t TypeIndex = IndexOf<T, Dictionary::Types>::value;
+
+    template <typename T> struct isGLMType : std::false_type {};
+    template <glm::length_t L, typename T, glm::qualifier Q>
+    struct isGLMType<glm::vec<L, T, Q>> : std::true_type {};
+    template <glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+    struct isGLMType<glm::mat<C, R, T, Q>> : std::true_type {};
+
+    template <typename T> struct TypeTag { using type = T; };
+
+    // Calls \p f with a TypeTag of the type with the index \p type in Dictionary::Types
+    template <typename F, size_t... Is>
+    void dispatchType(uint32_t type, F&& f, std::index_sequence<Is...>) {
+        const bool found = (
+            (type == Is ?
+                (f(TypeTag<std::variant_alternative_t<Is, Dictionary::Types>>()), true) :
+                false
+            ) || ...
+        );
+        if (!found) {
+            throw DictionaryBinaryFormatError(fmt::format("Unknown type {}", type));
+        }
+    }
+
+    template <typename F>
+    void dispatchType(uint32_t type, F&& f) {
+        dispatchType(
+            type,
+            std::forward<F>(f),
+            std::make_index_sequence<std::variant_size_v<Dictionary::Types>>()
+        );
+    }
+
+    // Returns the number of components of type VT stored in a value of \p type or 0 if
+    // the type does not store components of type VT
+    template <typename VT>
+    size_t nComponents(uint32_t type, uint32_t size) {
+        size_t res = 0;
+        dispatchType(type, [&res, size](auto t) {
+            using U = typename decltype(t)::type;
+            if constexpr (std::is_same_v<U, std::vector<VT>>) {
+                res = size / sizeof(VT);
+            }
+            else if constexpr (isGLMType<U>::value) {
+                if constexpr (std::is_same_v<typename U::value_type, VT>) {
+                    res = ghoul::glm_components<U>::value;
+                }
+            }
+        });
+        return res;
+    }
+} // namespace
+
+namespace internal {
+
+/// Writes the nodes of a Dictionary into the serialized values
+class DictionaryBinaryWriter {
+public:
+    explicit DictionaryBinaryWriter(std::vector<unsigned char>& values)
+        : _values(values)
+    {}
+
+    /// Writes the node for \p dictionary, unless it was written before, and returns its
+    /// offset and size
+    std::pair<uint32_t, uint32_t> writeNode(const Dictionary& dictionary) {
+        const Dictionary::Storage* storage = dictionary._storage.get();
+        if (storage) {
+            auto it = _nodes.find(storage);
+            if (it != _nodes.end()) {
+                return it->second;
+            }
+        }
+
+        struct Item {
+            std::string_view key;
+            uint32_t hash;
+            const Dictionary::StorageTypes* value;
+        };
+        std::vector<Item> items;
+        items.reserve(dictionary.size());
+        dictionary.visit(
+            [&items](std::string_view key, const Dictionary::StorageTypes& value) {
+                items.push_back({ key, hashCRC32(key), &value });
+            }
+        );
+        std::sort(
+            items.begin(), items.end(),
+            [](const Item& lhs, const Item& rhs) {
+                return std::tie(lhs.hash, lhs.key) < std::tie(rhs.hash, rhs.key);
+            }
+        );
+
+        const size_t node = _values.size();
+        const uint32_t nEntries = static_cast<uint32_t>(items.size());
+        append(&nEntries, sizeof(uint32_t));
+        const size_t table = _values.size();
+        _values.resize(table + items.size() * sizeof(DictionaryView::Entry));
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            DictionaryView::Entry e;
+            e.hash = items[i].hash;
+            e.keyOffset = append(items[i].key.data(), items[i].key.size());
+            e.keyLength = static_cast<uint32_t>(items[i].key.size());
+            e.type = static_cast<uint32_t>(items[i].value->index());
+            std::tie(e.valueOffset, e.valueSize) = writeValue(*items[i].value);
+
+            // The values might have been reallocated while writing the value
+            std::memcpy(
+                _values.data() + table + i * sizeof(DictionaryView::Entry),
+                &e,
+                sizeof(DictionaryView::Entry)
+            );
+        }
+
+        const std::pair<uint32_t, uint32_t> res = {
+            offset(node),
+            static_cast<uint32_t>(_values.size() - node)
+        };
+        if (storage) {
+            _nodes[storage] = res;
+        }
+        return res;
+    }
+
+private:
+    /// Writes the \p value and returns its offset and size
+    std::pair<uint32_t, uint32_t> writeValue(const Dictionary::StorageTypes& value) {
+        return std::visit(
+            [this](const auto& v) -> std::pair<uint32_t, uint32_t> {
+                using U = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<U, bool>) {
+                    const uint8_t b = v ? 1 : 0;
+                    return { append(&b, sizeof(uint8_t)), 1 };
+                }
+                else if constexpr (std::is_same_v<U, int> || std::is_same_v<U, double>) {
+                    return { append(&v, sizeof(U)), sizeof(U) };
+                }
+                else if constexpr (std::is_same_v<U, Dictionary>) {
+                    return writeNode(v);
+                }
+                else if constexpr (std::is_same_v<U, PmrString>) {
+                    return { append(v.data(), v.size()), offset(v.size()) };
+                }
+                else if constexpr (std::is_same_v<U, PmrVector<PmrString>>) {
+                    const size_t begin = _values.size();
+                    const uint32_t n = static_cast<uint32_t>(v.size());
+                    append(&n, sizeof(uint32_t));
+                    const size_t table = _values.size();
+                    _values.resize(table + v.size() * 2 * sizeof(uint32_t));
+                    for (size_t i = 0; i < v.size(); ++i) {
+                        const std::array<uint32_t, 2> s = {
+                            append(v[i].data(), v[i].size()),
+                            offset(v[i].size())
+                        };
+                        std::memcpy(
+                            _values.data() + table + i * sizeof(s),
+                            s.data(),
+                            sizeof(s)
+                        );
+                    }
+                    return { offset(begin), offset(_values.size() - begin) };
+                }
+                else if constexpr (std::is_same_v<U, PmrVector<int>> ||
+                                   std::is_same_v<U, PmrVector<double>>)
+                {
+                    const size_t size = v.size() * sizeof(typename U::value_type);
+                    return { append(v.data(), size), offset(size) };
+                }
+                else {
+                    static_assert(isGLMType<U>::value, "Unsupported type");
+                    const size_t size =
+                        ghoul::glm_components<U>::value * sizeof(typename U::value_type);
+                    return { append(glm::value_ptr(v), size), offset(size) };
+                }
+            },
+            value
+        );
+    }
+
+    /// Appends \p size bytes of \p data to the values and returns their offset
+    uint32_t append(const void* data, size_t size) {
+        const size_t res = _values.size();
+        _values.resize(res + size);
+        if (size > 0) {
+            std::memcpy(_values.data() + res, data, size);
+        }
+        return offset(res);
+    }
+
+    /// Converts the \p value into an offset, ensuring that it fits into 32 bits
+    static uint32_t offset(size_t value) {
+        if (value > std::numeric_limits<uint32_t>::max()) {
+            throw DictionaryBinaryFormatError(
+                "Serialized Dictionary exceeds the maximum size of 4 GB"
+            );
+        }
+        return static_cast<uint32_t>(value);
+    }
+
+    std::vector<unsigned char>& _values;
+
+    /// The nodes that have already been written, keyed by their storage
+    std::unordered_map<const Dictionary::Storage*, std::pair<uint32_t, uint32_t>> _nodes;
+};
+
+} // namespace internal
+
+DictionaryBinaryFormatError::DictionaryBinaryFormatError(std::string msg)
+    : RuntimeError(std::move(msg), "Dictionary")
+{}
+
+void serializeDictionary(const Dictionary& dictionary, Buffer& buffer,
+                         Buffer::Compress compress)
+{
+    std::vector<unsigned char> values;
+    internal::DictionaryBinaryWriter(values).writeNode(dictionary);
+
+    Header header;
+    header.magic = Magic;
+    header.version = Version;
+    header.flags = 0;
+    header.reserved = 0;
+    header.valuesSize = static_cast<uint32_t>(values.size());
+    header.storedSize = static_cast<uint32_t>(values.size());
+
+    if (compress && values.size() <= static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+        std::vector<unsigned char> compressed(
+            LZ4_compressBound(static_cast<int>(values.size()))
+        );
+        const int size = LZ4_compress(
+            reinterpret_cast<const char*>(values.data()),
+            reinterpret_cast<char*>(compressed.data()),
+            static_cast<int>(values.size())
+        );
+        if (size <= 0) {
+            throw RuntimeError("Error compressing Dictionary using LZ4", "Dictionary");
+        }
+
+        header.flags = FlagCompressed;
+        header.storedSize = static_cast<uint32_t>(size);
+        buffer.serialize(header);
+        buffer.serialize(compressed.data(), header.storedSize);
+    }
+    else {
+        buffer.serialize(header);
+        buffer.serialize(values.data(), values.size());
+    }
+}
+
+Dictionary deserializeDictionary(Buffer& buffer) {
+    // Buffer::deserialize only asserts that there are enough bytes, so all sizes have to
+    // be validated before reading or allocating anything
+    if (buffer.remainingSize() < sizeof(Header)) {
+        throw DictionaryBinaryFormatError("Buffer does not contain a Dictionary");
+    }
+    Header header;
+    buffer.deserialize(header);
+    if (header.magic != Magic || header.version != Version) {
+        throw DictionaryBinaryFormatError("Buffer does not contain a Dictionary");
+    }
+    if (header.storedSize > buffer.remainingSize()) {
+        throw DictionaryBinaryFormatError(
+            fmt::format(
+                "Serialized Dictionary is truncated. Expected {} bytes, {} are left",
+                header.storedSize, buffer.remainingSize()
+            )
+        );
+    }
+    const bool isCompressed = header.flags & FlagCompressed;
+    // LZ4 cannot expand data by more than a factor of 255, so any larger size is corrupt
+    constexpr uint64_t MaxCompressionRatio = 255;
+    if ((!isCompressed && header.valuesSize != header.storedSize) ||
+        (isCompressed &&
+         (header.valuesSize > uint64_t(header.storedSize) * MaxCompressionRatio ||
+          header.valuesSize > static_cast<uint32_t>(LZ4_MAX_INPUT_SIZE))))
+    {
+        throw DictionaryBinaryFormatError("Inconsistent size of serialized Dictionary");
+    }
+
+    std::vector<unsigned char> stored(header.storedSize);
+    if (!stored.empty()) {
+        buffer.deserialize(stored.data(), stored.size());
+    }
+
+    if (isCompressed) {
+        std::vector<unsigned char> values(header.valuesSize);
+        const int size = LZ4_decompress_safe(
+            reinterpret_cast<const char*>(stored.data()),
+            reinterpret_cast<char*>(values.data()),
+            static_cast<int>(stored.size()),
+            static_cast<int>(values.size())
+        );
+        if (size < 0 || static_cast<uint32_t>(size) != header.valuesSize) {
+            throw DictionaryBinaryFormatError("Error decompressing Dictionary");
+        }
+        stored = std::move(values);
+    }
+
+    return DictionaryView(stored.data(), header.valuesSize, 0).dictionary();
+}
+
+DictionaryView::DictionaryView(const void* data, size_t size) {
+    ghoul_assert(data, "Data must not be nullptr");
+
+    if (size < sizeof(Header)) {
+        throw DictionaryBinaryFormatError("Data does not contain a Dictionary");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (header.magic != Magic || header.version != Version) {
+        throw DictionaryBinaryFormatError("Data does not contain a Dictionary");
+    }
+    if (header.flags & FlagCompressed) {
+        throw DictionaryBinaryFormatError(
+            "Compressed Dictionaries cannot be viewed and have to be deserialized"
+        );
+    }
+    if (header.valuesSize != header.storedSize ||
+        header.valuesSize > size - sizeof(Header))
+    {
+        throw DictionaryBinaryFormatError("Inconsistent size of serialized Dictionary");
+    }
+
+    *this = DictionaryView(
+        reinterpret_cast<const unsigned char*>(data) + sizeof(Header),
+        header.valuesSize,
+        0
+    );
+}
+
+DictionaryView::DictionaryView(const unsigned char* values, uint32_t size, uint32_t node)
+    : _values(values)
+    , _size(size)
+    , _node(node)
+{
+    std::memcpy(&_nEntries, bytes(_node, sizeof(uint32_t)), sizeof(uint32_t));
+    // Validate the size of the table up front so that entry() does not have to
+    bytes(_node, sizeof(uint32_t) + uint64_t(_nEntries) * sizeof(Entry));
+}
+
+template <typename T, std::enable_if_t<DictionaryView::IsAllowedType<T>{}, int>>
+T DictionaryView::value(std::string_view key) const {
+    ghoul_assert(!key.empty(), "Key must not be empty");
+
+    Entry e;
+    if (!findNestedEntry(key, e)) {
+        throw Dictionary::KeyError(fmt::format("Could not find key '{}'", key));
+    }
+    return decode<T>(e, key);
+}
+
+template <typename T, std::enable_if_t<DictionaryView::IsAllowedType<T>{}, int>>
+bool DictionaryView::hasValue(std::string_view key) const {
+    ghoul_assert(!key.empty(), "Key must not be empty");
+
+    Entry e;
+    if (!findNestedEntry(key, e)) {
+        return false;
+    }
+
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        return e.type == TypeIndex<std::string>;
+    }
+    else if constexpr (std::is_same_v<T, std::vector<int>> ||
+                       std::is_same_v<T, std::vector<double>>)
+    {
+        return e.type == TypeIndex<T> ||
+            nComponents<typename T::value_type>(e.type, e.valueSize) > 0;
+    }
+    else if constexpr (isGLMType<T>::value) {
+        return e.type == TypeIndex<T> ||
+            nComponents<typename T::value_type>(e.type, e.valueSize) ==
+                ghoul::glm_components<T>::value;
+    }
+    else {
+        return e.type == TypeIndex<T>;
+    }
+}
+
+bool DictionaryView::hasKey(std::string_view key) const {
+    ghoul_assert(!key.empty(), "Key must not be empty");
+
+    Entry e;
+    return findNestedEntry(key, e);
+}
+
+DictionaryView DictionaryView::subDictionary(std::string_view key) const {
+    ghoul_assert(!key.empty(), "Key must not be empty");
+
+    Entry e;
+    if (!findNestedEntry(key, e)) {
+        throw Dictionary::KeyError(fmt::format("Could not find key '{}'", key));
+    }
+    if (e.type != TypeIndex<Dictionary>) {
+        throw Dictionary::ValueError(
+            std::string(key),
+            fmt::format("Error accessing value, wanted a Dictionary has '{}'", e.type)
+        );
+    }
+    return DictionaryView(_values, _size, e.valueOffset);
+}
+
+std::vector<std::string_view> DictionaryView::keys() const {
+    std::vector<std::string_view> res;
+    res.reserve(_nEntries);
+    for (uint32_t i = 0; i < _nEntries; ++i) {
+        res.push_back(keyOf(entry(i)));
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+size_t DictionaryView::size() const {
+    return _nEntries;
+}
+
+bool DictionaryView::isEmpty() const {
+    return _nEntries == 0;
+}
+
+Dictionary DictionaryView::dictionary() const {
+    std::unordered_map<uint32_t, Dictionary> nodes;
+    std::vector<uint32_t> ancestors;
+    return dictionary(nodes, ancestors);
+}
+
+Dictionary DictionaryView::dictionary(std::unordered_map<uint32_t, Dictionary>& nodes,
+                                      std::vector<uint32_t>& ancestors) const
+{
+    auto it = nodes.find(_node);
+    if (it != nodes.end()) {
+        return it->second;
+    }
+
+    ancestors.push_back(_node);
+    Dictionary res;
+    for (uint32_t i = 0; i < _nEntries; ++i) {
+        const Entry e = entry(i);
+        const std::string_view key = keyOf(e);
+        if (key.empty() || key.find('.') != std::string_view::npos) {
+            // A Dictionary never contains such keys and they could not be looked up
+            throw DictionaryBinaryFormatError(
+                fmt::format("Serialized Dictionary is corrupt. Invalid key '{}'", key)
+            );
+        }
+        if (e.type == TypeIndex<Dictionary>) {
+            res.setValue(key, childView(e, ancestors).dictionary(nodes, ancestors));
+        }
+        else {
+            dispatchType(e.type, [&](auto t) {
+                using U = typename decltype(t)::type;
+                if constexpr (!std::is_same_v<U, Dictionary>) {
+                    res.setValue(key, decode<U>(e, key));
+                }
+            });
+        }
+    }
+    ancestors.pop_back();
+    nodes[_node] = res;
+    return res;
+}
+
+DictionaryView DictionaryView::childView(const Entry& entry,
+                                         const std::vector<uint32_t>& ancestors) const
+{
+    if (ancestors.size() >= MaxDepth) {
+        throw DictionaryBinaryFormatError(
+            fmt::format(
+                "Serialized Dictionary is corrupt. Exceeded the maximum nesting depth "
+                "of {}", MaxDepth
+            )
+        );
+    }
+    if (std::find(ancestors.begin(), ancestors.end(), entry.valueOffset) !=
+        ancestors.end())
+    {
+        throw DictionaryBinaryFormatError(
+            fmt::format(
+                "Serialized Dictionary is corrupt. Node {} contains itself",
+                entry.valueOffset
+            )
+        );
+    }
+    return DictionaryView(_values, _size, entry.valueOffset);
+}
+
+const unsigned char* DictionaryView::bytes(uint64_t offset, uint64_t size) const {
+    if (offset + size > _size) {
+        throw DictionaryBinaryFormatError(
+            fmt::format(
+                "Serialized Dictionary is corrupt. Accessing [{}, {}) of {} bytes",
+                offset, offset + size, _size
+            )
+        );
+    }
+    return _values + offset;
+}
+
+DictionaryView::Entry DictionaryView::entry(uint32_t i) const {
+    ghoul_assert(i < _nEntries, "Entry out of range");
+
+    Entry res;
+    std::memcpy(
+        &res,
+        _values + _node + sizeof(uint32_t) + uint64_t(i) * sizeof(Entry),
+        sizeof(Entry)
+    );
+    return res;
+}
+
+std::string_view DictionaryView::keyOf(const Entry& entry) const {
+    return std::string_view(
+        reinterpret_cast<const char*>(bytes(entry.keyOffset, entry.keyLength)),
+        entry.keyLength
+    );
+}
+
+bool DictionaryView::findEntry(std::string_view key, Entry& e) const {
+    const unsigned int hash = hashCRC32(key);
+
+    // Binary search for the first entry with the hash, followed by a linear search
+    // through all entries whose hash collides
+    uint32_t first = 0;
+    uint32_t count = _nEntries;
+    while (count > 0) {
+        const uint32_t step = count / 2;
+        if (entry(first + step).hash < hash) {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
+    }
+    for (uint32_t i = first; i < _nEntries; ++i) {
+        e = entry(i);
+        if (e.hash != hash) {
+            return false;
+        }
+        if (keyOf(e) == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DictionaryView::findNestedEntry(std::string_view key, Entry& e) const {
+    DictionaryView view = *this;
+    std::vector<uint32_t> ancestors;
+    for (size_t dotPos = key.find('.');
+         dotPos != std::string_view::npos;
+         dotPos = key.find('.'))
+    {
+        if (!view.findEntry(key.substr(0, dotPos), e) ||
+            e.type != TypeIndex<Dictionary>)
+        {
+            return false;
+        }
+        ancestors.push_back(view._node);
+        view = view.childView(e, ancestors);
+        key = key.substr(dotPos + 1);
+    }
+    return view.findEntry(key, e);
+}
+
+template <typename T>
+T DictionaryView::decode(const Entry& e, std::string_view key) const {
+    auto typeError = [&]() {
+        return Dictionary::ValueError(
+            std::string(key),
+            fmt::format(
+                "Error accessing value, wanted type '{}' has '{}'",
+                typeid(T).name(), e.type
+            )
+        );
+    };
+
+    if constexpr (std::is_same_v<T, std::string_view> ||
+                  std::is_same_v<T, std::string>)
+    {
+        if (e.type != TypeIndex<std::string>) {
+            throw typeError();
+        }
+        return T(
+            reinterpret_cast<const char*>(bytes(e.valueOffset, e.valueSize)),
+            e.valueSize
+        );
+    }
+    else if constexpr (std::is_same_v<T, bool>) {
+        if (e.type != TypeIndex<T>) {
+            throw typeError();
+        }
+        return *bytes(e.valueOffset, sizeof(uint8_t)) != 0;
+    }
+    else if constexpr (std::is_same_v<T, int> || std::is_same_v<T, double>) {
+        if (e.type != TypeIndex<T>) {
+            throw typeError();
+        }
+        T res;
+        std::memcpy(&res, bytes(e.valueOffset, sizeof(T)), sizeof(T));
+        return res;
+    }
+    else if constexpr (std::is_same_v<T, Dictionary>) {
+        if (e.type != TypeIndex<T>) {
+            throw typeError();
+        }
+        return DictionaryView(_values, _size, e.valueOffset).dictionary();
+    }
+    else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+        if (e.type != TypeIndex<T>) {
+            throw typeError();
+        }
+        uint32_t n;
+        std::memcpy(&n, bytes(e.valueOffset, sizeof(uint32_t)), sizeof(uint32_t));
+        const unsigned char* table = bytes(
+            uint64_t(e.valueOffset) + sizeof(uint32_t),
+            uint64_t(n) * 2 * sizeof(uint32_t)
+        );
+        T res;
+        res.reserve(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            std::array<uint32_t, 2> s;
+            std::memcpy(s.data(), table + i * sizeof(s), sizeof(s));
+            res.emplace_back(reinterpret_cast<const char*>(bytes(s[0], s[1])), s[1]);
+        }
+        return res;
+    }
+    else {
+        // Vectors of numbers and glm types can be used interchangeably
+        using VT = typename T::value_type;
+        const size_t n = nComponents<VT>(e.type, e.valueSize);
+        if (n == 0 && e.type != TypeIndex<std::vector<VT>>) {
+            throw typeError();
+        }
+        const unsigned char* data = bytes(e.valueOffset, uint64_t(n) * sizeof(VT));
+
+        if constexpr (isGLMType<T>::value) {
+            constexpr size_t NValues = ghoul::glm_components<T>::value;
+            if (n != NValues) {
+                throw Dictionary::ValueError(
+                    std::string(key),
+                    fmt::format(
+                        "Contained wrong number of values. Expected {} got {}",
+                        NValues, n
+                    )
+                );
+            }
+            T res;
+            std::memcpy(glm::value_ptr(res), data, NValues * sizeof(VT));
+            return res;
+        }
+        else {
+            T res(n);
+            if (n > 0) {
+                std::memcpy(res.data(), data, n * sizeof(VT));
+            }
+            return res;
+        }
+    }
+}
+
+template bool DictionaryView::value(std::string_view) const;
+template int DictionaryView::value(std::string_view) const;
+template double DictionaryView::value(std::string_view) const;
+template std::string DictionaryView::value(std::string_view) const;
+template std::string_view DictionaryView::value(std::string_view) const;
+template Dictionary DictionaryView::value(std::string_view) const;
+template std::vector<int> DictionaryView::value(std::string_view) const;
+template std::vector<double> DictionaryView::value(std::string_view) const;
+template std::vector<std::string> DictionaryView::value(std::string_view) const;
+template glm::ivec2 DictionaryView::value(std::string_view) const;
+template glm::ivec3 DictionaryView::value(std::string_view) const;
+template glm::ivec4 DictionaryView::value(std::string_view) const;
+template glm::dvec2 DictionaryView::value(std::string_view) const;
+template glm::dvec3 DictionaryView::value(std::string_view) const;
+template glm::dvec4 DictionaryView::value(std::string_view) const;
+template glm::dmat2x2 DictionaryView::value(std::string_view) const;
+template glm::dmat2x3 DictionaryView::value(std::string_view) const;
+template glm::dmat2x4 DictionaryView::value(std::string_view) const;
+template glm::dmat3x2 DictionaryView::value(std::string_view) const;
+template glm::dmat3x3 DictionaryView::value(std::string_view) const;
+template glm::dmat3x4 DictionaryView::value(std::string_view) const;
+template glm::dmat4x2 DictionaryView::value(std::string_view) const;
+template glm::dmat4x3 DictionaryView::value(std::string_view) const;
+template glm::dmat4x4 DictionaryView::value(std::string_view) const;
+
+template bool DictionaryView::hasValue<bool>(std::string_view) const;
+template bool DictionaryView::hasValue<int>(std::string_view) const;
+template bool DictionaryView::hasValue<double>(std::string_view) const;
+template bool DictionaryView::hasValue<std::string>(std::string_view) const;
+template bool DictionaryView::hasValue<std::string_view>(std::string_view) const;
+template bool DictionaryView::hasValue<Dictionary>(std::string_view) const;
+template bool DictionaryView::hasValue<std::vector<int>>(std::string_view) const;
+template bool DictionaryView::hasValue<std::vector<double>>(std::string_view) const;
+template bool DictionaryView::hasValue<std::vector<std::string>>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::ivec2>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::ivec3>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::ivec4>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dvec2>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dvec3>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dvec4>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat2x2>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat2x3>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat2x4>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat3x2>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat3x3>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat3x4>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat4x2>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat4x3>(std::string_view) const;
+template bool DictionaryView::hasValue<glm::dmat4x4>(std::string_view) const;
+
+} // namespace ghoul
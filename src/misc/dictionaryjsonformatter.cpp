@@ -25,124 +25,138 @@
 
 #include <ghoul/misc/dictionaryjsonformatter.h>
 
+#include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/misc/dictionary.h>
-#include <numeric>
+#include <ghoul/misc/misc.h>
+#include <cmath>
+#include <iterator>
+#include <ostream>
 #include <string>
-#include <sstream>
 
 namespace ghoul {
 
 namespace {
-    std::string formatNumber(double d) {
+    using internal::PmrString;
+    using internal::PmrVector;
+
+    // The number of bytes that are collected before they are written to the stream
+    constexpr size_t StreamChunkSize = 64 * 1024;
+
+    // The output of the formatting, which is either collected in a string or
+    // periodically flushed into a stream
+    struct Output {
+        std::string& buffer;
+        std::ostream* stream = nullptr;
+
+        void flushIfNeeded() {
+            if (stream && buffer.size() >= StreamChunkSize) {
+                stream->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+    };
+
+    void formatNumber(std::string& out, double d) {
         // fmt::format will represent infinite values with 'inf' and NaNs with 'nan'.
         // These are not valid in JSON, so use 'null' instead
         if (!std::isfinite(d)) {
-            return "null";
+            out += "null";
+            return;
         }
 
-        return fmt::format("{}", d);
+        fmt::format_to(std::back_inserter(out), "{}", d);
     }
 
     template <typename T>
-    std::string formatVector(const std::vector<T>& vec) {
+    void formatNumbers(std::string& out, const T* values, size_t nValues) {
         static_assert(
             std::is_same_v<T, double> || std::is_same_v<T, int>,
             "Only double or ints allowed"
         );
 
-        if (vec.empty()) {
-            return "[]";
-        }
-
-        std::stringstream values;
-        for (size_t i = 0; i < vec.size() - 1; i++) {
-            double v = static_cast<double>(vec[i]);
-            values << formatNumber(v) << ",";
+        out += '[';
+        for (size_t i = 0; i < nValues; i++) {
+            if (i > 0) {
+                out += ',';
+            }
+            formatNumber(out, static_cast<double>(values[i]));
         }
-        values << vec.back();
-
-        return fmt::format("[{}]", values.str());
+        out += ']';
     }
 
-    /**
-    * Converts a single value \p key out of the \p dictionary by manually iterating all
-    * the types and trying to access them.
-    * \param dictionary The Dictionary from which the \p key should be extracted and
-    * converted
-    * \param key The key in the Dictionary that should be converted
-    * \return A JSON representation of the \p key's value
-    * \throw JsonFormattingError If the \p key points to a type that cannot be converted
-    */
-    std::string formatValue(const Dictionary& dictionary, const std::string& key) {
-        if (dictionary.hasValue<Dictionary>(key)) {
-            Dictionary subDictionary = dictionary.value<Dictionary>(key);
-            return formatJson(subDictionary);
-        }
+    void format(Output& out, const Dictionary& dictionary);
 
-        if (dictionary.hasValue<double>(key)) {
-            double value = dictionary.value<double>(key);
-            return formatNumber(value);
-        }
-
-        if (dictionary.hasValue<int>(key)) {
-            int value = dictionary.value<int>(key);
-            return formatNumber(static_cast<double>(value));
-        }
-
-        if (dictionary.hasValue<bool>(key)) {
-            bool value = dictionary.value<bool>(key);
-            return value ? "true" : "false";
-        }
-
-        if (dictionary.hasValue<std::vector<int>>(key)) {
-            std::vector<int> vec = dictionary.value<std::vector<int>>(key);
-            return formatVector(vec);
-        }
-
-        if (dictionary.hasValue<std::vector<double>>(key)) {
-            std::vector<double> vec = dictionary.value<std::vector<double>>(key);
-            return formatVector(vec);
-        }
-
-        if (dictionary.hasValue<std::string>(key)) {
-            std::string value = dictionary.value<std::string>(key);
-
-            std::string jsonString;
-            for (const char& c : value) {
-                switch (c) {
-                    case '"':
-                        jsonString += "\\\"";
-                        break;
-                    case '\\':
-                        jsonString += "\\\\";
-                        break;
-                    case '\b':
-                        jsonString += "\\b";
-                        break;
-                    case '\f':
-                        jsonString += "\\f";
-                        break;
-                    case '\n':
-                        jsonString += "\\n";
-                        break;
-                    case '\r':
-                        jsonString += "\\r";
-                        break;
-                    case '\t':
-                        jsonString += "\\t";
-                        break;
-                    default:
-                        jsonString += c;
+    /**
+     * Converts a single \p value with the name \p key by visiting the stored type.
+     * \param out The output to which the JSON representation of the \p value is appended
+     * \param key The key of the \p value, which is used for error messages
+     * \param value The value that should be converted
+     * \throw JsonFormattingError If the \p value has a type that cannot be converted
+     */
+    void formatValue(Output& out, std::string_view key,
+                     const Dictionary::StorageTypes& value)
+    {
+        std::visit(
+            [&out, key](const auto& v) {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, Dictionary>) {
+                    format(out, v);
                 }
-            }
+                else if constexpr (std::is_same_v<T, double> || std::is_same_v<T, int>) {
+                    formatNumber(out.buffer, static_cast<double>(v));
+                }
+                else if constexpr (std::is_same_v<T, bool>) {
+                    out.buffer += v ? "true" : "false";
+                }
+                else if constexpr (std::is_same_v<T, PmrVector<int>> ||
+                                   std::is_same_v<T, PmrVector<double>>)
+                {
+                    formatNumbers(out.buffer, v.data(), v.size());
+                }
+                else if constexpr (std::is_same_v<T, PmrString>) {
+                    out.buffer += '"';
+                    appendEscapedString(out.buffer, v, EscapeSyntax::Json);
+                    out.buffer += '"';
+                }
+                else if constexpr (std::is_same_v<T, PmrVector<PmrString>>) {
+                    throw JsonFormattingError(fmt::format(
+                        "Key '{}' has invalid type for formatting dictionary as JSON", key
+                    ));
+                }
+                else {
+                    // glm vectors and matrices are stored as a flat list of numbers
+                    formatNumbers(
+                        out.buffer,
+                        glm::value_ptr(v),
+                        ghoul::glm_components<T>::value
+                    );
+                }
+            },
+            value
+        );
+    }
 
-            return "\"" + jsonString + "\"";
-        }
+    void format(Output& out, const Dictionary& dictionary) {
+        out.buffer += '{';
+        bool isFirst = true;
+        dictionary.visit(
+            [&out, &isFirst](std::string_view key,
+                             const Dictionary::StorageTypes& value)
+            {
+                if (!isFirst) {
+                    out.buffer += ',';
+                }
+                isFirst = false;
 
-        throw JsonFormattingError(fmt::format(
-            "Key '{}' has invalid type for formatting dictionary as JSON", key
-        ));
+                out.buffer += '"';
+                out.buffer += key;
+                out.buffer += "\":";
+                formatValue(out, key, value);
+                out.flushIfNeeded();
+            }
+        );
+        out.buffer += '}';
     }
 } // namespace
 
@@ -152,29 +166,22 @@ JsonFormattingError::JsonFormattingError(std::string msg)
 {}
 
 std::string formatJson(const Dictionary& dictionary) {
-    if (dictionary.isEmpty()) {
-        return "{}";
-    }
-
-    auto convert = [](const std::string& key, const ghoul::Dictionary& d) -> std::string {
-        return "\"" + key + "\":" + formatValue(d, key);
-    };
-
-    std::vector<std::string> keys;
-    for (std::string_view k : dictionary.keys()) {
-        keys.push_back(std::string(k));
-    }
+    std::string json;
+    formatJson(dictionary, json);
+    return json;
+}
 
-    std::string json = std::accumulate(
-        std::next(keys.begin()),
-        keys.end(),
-        convert(*keys.begin(), dictionary),
-        [convert, dictionary](std::string a, std::string key) {
-            return std::move(a) + "," + convert(std::move(key), dictionary);
-        }
-    );
+void formatJson(const Dictionary& dictionary, std::string& output) {
+    Output out = { output };
+    format(out, dictionary);
+}
 
-    return "{" + json + "}";
+void formatJson(const Dictionary& dictionary, std::ostream& stream) {
+    std::string buffer;
+    buffer.reserve(StreamChunkSize);
+    Output out = { buffer, &stream };
+    format(out, dictionary);
+    stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 }
 
 }  // namespace ghoul
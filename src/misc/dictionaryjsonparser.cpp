@@ -0,0 +1,602 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/dictionaryjsonparser.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/misc.h>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GHOUL_JSON_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2
+
+namespace ghoul {
+
+namespace {
+    // The deepest nesting of objects and arrays that is accepted. Deeper documents are
+    // rejected, as destroying the resulting Dictionary would exhaust the stack
+    constexpr size_t MaxDepth = 512;
+
+    constexpr bool isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    constexpr bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+#ifdef GHOUL_JSON_USE_SSE2
+    // Returns the index of the lowest set bit in the non-zero \p mask
+    int lowestSetBit(unsigned int mask) {
+#ifdef _MSC_VER
+        unsigned long res;
+        _BitScanForward(&res, mask);
+        return static_cast<int>(res);
+#else // ^^^^ _MSC_VER // !_MSC_VER vvvv
+        return __builtin_ctz(mask);
+#endif // _MSC_VER
+    }
+#endif // GHOUL_JSON_USE_SSE2
+
+    // Returns the first character in [p, end) that is not whitespace or end
+    const char* skipWhitespace(const char* p, const char* end) {
+        // Most tokens are separated by at most a single whitespace, which is not worth
+        // the setup of the vectorized search
+        if (p == end || !isWhitespace(*p)) {
+            return p;
+        }
+        ++p;
+
+#ifdef GHOUL_JSON_USE_SSE2
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i carriageReturn = _mm_set1_epi8('\r');
+        const __m128i tab = _mm_set1_epi8('\t');
+        while (end - p >= 16) {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i ws = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(c, space), _mm_cmpeq_epi8(c, newline)),
+                _mm_or_si128(_mm_cmpeq_epi8(c, carriageReturn), _mm_cmpeq_epi8(c, tab))
+            );
+            const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(ws));
+            if (mask != 0xFFFF) {
+                return p + lowestSetBit(~mask & 0xFFFF);
+            }
+            p += 16;
+        }
+#endif // GHOUL_JSON_USE_SSE2
+
+        while (p != end && isWhitespace(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    // Returns the first character in [p, end) that is either a quotation mark, a
+    // backslash, or a control character, or end if there is no such character
+    const char* scanString(const char* p, const char* end) {
+        const size_t pos = findCharacterToEscape(std::string_view(p, end - p));
+        return pos == std::string_view::npos ? end : p + pos;
+    }
+
+    // Converts the characters [begin, end), which have already been validated to be a
+    // JSON number, into a double
+    double toDouble(const char* begin, const char* end) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        double res;
+        const std::from_chars_result r = std::from_chars(begin, end, res);
+        if (r.ec == std::errc()) {
+            return res;
+        }
+        // Values that are out of range are handled by strtod below, which returns the
+        // infinity or 0 that a JSON number that is too large or too small represents
+#endif // __cpp_lib_to_chars >= 201611L
+
+        // std::strtod requires a null-terminated string
+        const std::string number(begin, end);
+        return std::strtod(number.c_str(), nullptr);
+    }
+
+    void appendUtf8(std::string& str, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            str += static_cast<char>(codepoint);
+        }
+        else if (codepoint < 0x800) {
+            str += static_cast<char>(0xC0 | (codepoint >> 6));
+            str += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else if (codepoint < 0x10000) {
+            str += static_cast<char>(0xE0 | (codepoint >> 12));
+            str += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else {
+            str += static_cast<char>(0xF0 | (codepoint >> 18));
+            str += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            str += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    /// The single-pass parser that reports the contents of a JSON document to a handler
+    class Parser {
+    public:
+        /// If \p dictionaryKeys is \c true, member names that cannot be used as keys in
+        /// a Dictionary, which are empty names and names containing a '.', are rejected
+        Parser(std::string_view json, JsonHandler& handler, bool dictionaryKeys = false)
+            : _begin(json.data())
+            , _p(json.data())
+            , _end(json.data() + json.size())
+            , _handler(handler)
+            , _dictionaryKeys(dictionaryKeys)
+        {
+            // Skip the UTF-8 byte order mark
+            if (json.substr(0, 3) == "\xEF\xBB\xBF") {
+                _p += 3;
+            }
+        }
+
+        /// Returns the first character of the document that is not whitespace
+        char peek() {
+            _p = skipWhitespace(_p, _end);
+            if (_p == _end) {
+                error("Unexpected end of document");
+            }
+            return *_p;
+        }
+
+        void parse() {
+            enum class Container { Object, Array };
+            std::vector<Container> stack;
+
+            // Each iteration parses a single value, including all of the structural
+            // characters that separate it from the next value
+            while (true) {
+                const char first = peek();
+                if ((first == '{' || first == '[') && stack.size() >= MaxDepth) {
+                    error(
+                        fmt::format("Exceeded the maximum nesting depth of {}", MaxDepth)
+                    );
+                }
+                switch (first) {
+                    case '{':
+                        ++_p;
+                        _handler.beginObject();
+                        if (peek() == '}') {
+                            ++_p;
+                            _handler.endObject();
+                        }
+                        else {
+                            stack.push_back(Container::Object);
+                            parseKey();
+                            continue;
+                        }
+                        break;
+                    case '[':
+                        ++_p;
+                        _handler.beginArray();
+                        if (peek() == ']') {
+                            ++_p;
+                            _handler.endArray();
+                        }
+                        else {
+                            stack.push_back(Container::Array);
+                            continue;
+                        }
+                        break;
+                    case '"':
+                        _handler.value(parseString());
+                        break;
+                    case 't':
+                        parseLiteral("true");
+                        _handler.value(true);
+                        break;
+                    case 'f':
+                        parseLiteral("false");
+                        _handler.value(false);
+                        break;
+                    case 'n':
+                        parseLiteral("null");
+                        _handler.null();
+                        break;
+                    default:
+                        if (*_p == '-' || isDigit(*_p)) {
+                            _handler.value(parseNumber());
+                            break;
+                        }
+                        error(fmt::format("Unexpected character '{}'", *_p));
+                }
+
+                // Close all containers that end after this value and advance to the
+                // beginning of the next value
+                while (true) {
+                    if (stack.empty()) {
+                        _p = skipWhitespace(_p, _end);
+                        if (_p != _end) {
+                            error("Unexpected content after the end of the document");
+                        }
+                        return;
+                    }
+
+                    const char c = peek();
+                    ++_p;
+                    if (stack.back() == Container::Object) {
+                        if (c == ',') {
+                            parseKey();
+                            break;
+                        }
+                        if (c != '}') {
+                            --_p;
+                            error("Expected ',' or '}' after a member of an object");
+                        }
+                        stack.pop_back();
+                        _handler.endObject();
+                    }
+                    else {
+                        if (c == ',') {
+                            break;
+                        }
+                        if (c != ']') {
+                            --_p;
+                            error("Expected ',' or ']' after an element of an array");
+                        }
+                        stack.pop_back();
+                        _handler.endArray();
+                    }
+                }
+            }
+        }
+
+        [[noreturn]] void error(std::string msg) const {
+            error(std::move(msg), _p);
+        }
+
+    private:
+        /// Throws a JsonParsingError with the line and column of the \p position
+        [[noreturn]] void error(std::string msg, const char* position) const {
+            size_t line = 1;
+            const char* lineBegin = _begin;
+            for (const char* c = _begin; c != position; ++c) {
+                if (*c == '\n') {
+                    ++line;
+                    lineBegin = c + 1;
+                }
+            }
+            const size_t column = static_cast<size_t>(position - lineBegin) + 1;
+            throw JsonParsingError(std::move(msg), line, column);
+        }
+
+        /// Parses the key of an object member and the following colon
+        void parseKey() {
+            if (peek() != '"') {
+                error("Expected a string as the name of an object member");
+            }
+            const char* begin = _p;
+            const std::string_view key = parseString();
+            if (_dictionaryKeys) {
+                if (key.empty()) {
+                    error("Empty object member names are not supported", begin);
+                }
+                if (key.find('.') != std::string_view::npos) {
+                    error(
+                        fmt::format(
+                            "Object member name '{}' must not contain '.', which "
+                            "separates the levels of Dictionary keys", key
+                        ),
+                        begin
+                    );
+                }
+            }
+            _handler.key(key);
+            if (peek() != ':') {
+                error("Expected ':' after the name of an object member");
+            }
+            ++_p;
+        }
+
+        /// Parses the string starting at the current quotation mark
+        std::string_view parseString() {
+            ++_p;
+            const char* begin = _p;
+            _p = scanString(_p, _end);
+            if (_p != _end && *_p == '"') {
+                // Fast path for strings without escape sequences
+                ++_p;
+                return std::string_view(begin, _p - begin - 1);
+            }
+
+            _scratch.assign(begin, _p);
+            while (true) {
+                if (_p == _end) {
+                    error("Unterminated string");
+                }
+                if (*_p == '"') {
+                    ++_p;
+                    return _scratch;
+                }
+                if (*_p != '\\') {
+                    error("Invalid control character in string");
+                }
+
+                ++_p;
+                if (_p == _end) {
+                    error("Unterminated string");
+                }
+                switch (*_p) {
+                    case '"':  _scratch += '"';  break;
+                    case '\\': _scratch += '\\'; break;
+                    case '/':  _scratch += '/';  break;
+                    case 'b':  _scratch += '\b'; break;
+                    case 'f':  _scratch += '\f'; break;
+                    case 'n':  _scratch += '\n'; break;
+                    case 'r':  _scratch += '\r'; break;
+                    case 't':  _scratch += '\t'; break;
+                    case 'u':
+                        appendUtf8(_scratch, parseCodepoint());
+                        // parseCodepoint already advanced past the escape sequence
+                        --_p;
+                        break;
+                    default:
+                        error(fmt::format("Invalid escape sequence '\\{}'", *_p));
+                }
+                ++_p;
+
+                const char* chunk = _p;
+                _p = scanString(_p, _end);
+                _scratch.append(chunk, _p);
+            }
+        }
+
+        /// Parses the \\uXXXX escape sequence, and a following low surrogate if required,
+        /// starting at the 'u'
+        uint32_t parseCodepoint() {
+            const uint32_t high = parseHex();
+            if (high >= 0xDC00 && high <= 0xDFFF) {
+                error("Unpaired low surrogate in string");
+            }
+            if (high < 0xD800 || high > 0xDBFF) {
+                return high;
+            }
+
+            if (_end - _p < 2 || _p[0] != '\\' || _p[1] != 'u') {
+                error("Unpaired high surrogate in string");
+            }
+            ++_p;
+            const uint32_t low = parseHex();
+            if (low < 0xDC00 || low > 0xDFFF) {
+                error("Unpaired high surrogate in string");
+            }
+            return 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        /// Parses the four hexadecimal digits following the 'u' at the current position
+        uint32_t parseHex() {
+            ++_p;
+            if (_end - _p < 4) {
+                error("Unterminated unicode escape sequence");
+            }
+            uint32_t res = 0;
+            for (int i = 0; i < 4; ++i, ++_p) {
+                const char c = *_p;
+                res <<= 4;
+                if (c >= '0' && c <= '9') {
+                    res |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f') {
+                    res |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F') {
+                    res |= c - 'A' + 10;
+                }
+                else {
+                    error("Invalid unicode escape sequence");
+                }
+            }
+            return res;
+        }
+
+        /// Validates the number at the current position against the JSON grammar, which
+        /// is stricter than std::from_chars, and converts it
+        double parseNumber() {
+            const char* begin = _p;
+            if (*_p == '-') {
+                ++_p;
+            }
+            if (_p == _end || !isDigit(*_p)) {
+                error("Invalid number");
+            }
+            if (*_p == '0') {
+                ++_p;
+            }
+            else {
+                while (_p != _end && isDigit(*_p)) {
+                    ++_p;
+                }
+            }
+            if (_p != _end && *_p == '.') {
+                ++_p;
+                if (_p == _end || !isDigit(*_p)) {
+                    error("Invalid number");
+                }
+                while (_p != _end && isDigit(*_p)) {
+                    ++_p;
+                }
+            }
+            if (_p != _end && (*_p == 'e' || *_p == 'E')) {
+                ++_p;
+                if (_p != _end && (*_p == '+' || *_p == '-')) {
+                    ++_p;
+                }
+                if (_p == _end || !isDigit(*_p)) {
+                    error("Invalid number");
+                }
+                while (_p != _end && isDigit(*_p)) {
+                    ++_p;
+                }
+            }
+            return toDouble(begin, _p);
+        }
+
+        void parseLiteral(std::string_view literal) {
+            if (std::string_view(_p, std::min<size_t>(_end - _p, literal.size())) !=
+                literal)
+            {
+                error("Invalid literal");
+            }
+            _p += literal.size();
+        }
+
+        const char* _begin;
+        const char* _p;
+        const char* _end;
+        JsonHandler& _handler;
+        const bool _dictionaryKeys;
+
+        /// Storage for strings that contain escape sequences
+        std::string _scratch;
+    };
+
+    /// Handler that builds the Dictionary following the rules of the Lua conversion
+    class DictionaryBuilder final : public JsonHandler {
+    public:
+        void beginObject() override {
+            _stack.push_back({ Dictionary(), false, 0, std::string() });
+        }
+
+        void endObject() override {
+            finishContainer();
+        }
+
+        void beginArray() override {
+            _stack.push_back({ Dictionary(), true, 0, std::string() });
+        }
+
+        void endArray() override {
+            finishContainer();
+        }
+
+        void key(std::string_view key) override {
+            _stack.back().key.assign(key);
+        }
+
+        void null() override {
+            // Null values are omitted, but still occupy their index in an array
+            Level& level = _stack.back();
+            if (level.isArray) {
+                level.nValues++;
+            }
+        }
+
+        void value(bool value) override {
+            insert(value);
+        }
+
+        void value(double value) override {
+            insert(value);
+        }
+
+        void value(std::string_view value) override {
+            insert(std::string(value));
+        }
+
+        Dictionary result;
+
+    private:
+        struct Level {
+            Dictionary dictionary;
+            bool isArray;
+            int nValues;
+
+            /// The key of the next member if this level is an object
+            std::string key;
+        };
+
+        template <typename T>
+        void insert(T value) {
+            Level& level = _stack.back();
+            if (level.isArray) {
+                // Lua arrays are 1-based, so we follow the same convention here
+                level.nValues++;
+                level.dictionary.setValue(
+                    std::to_string(level.nValues),
+                    std::move(value)
+                );
+            }
+            else {
+                level.dictionary.setValue(std::move(level.key), std::move(value));
+            }
+        }
+
+        void finishContainer() {
+            Dictionary d = std::move(_stack.back().dictionary);
+            _stack.pop_back();
+            if (_stack.empty()) {
+                result = std::move(d);
+            }
+            else {
+                insert(std::move(d));
+            }
+        }
+
+        std::vector<Level> _stack;
+    };
+} // namespace
+
+JsonParsingError::JsonParsingError(std::string msg, size_t lineNumber,
+                                   size_t columnNumber)
+    : RuntimeError(
+        fmt::format("{} at line {}, column {}", msg, lineNumber, columnNumber),
+        "Dictionary"
+    )
+    , line(lineNumber)
+    , column(columnNumber)
+{}
+
+Dictionary parseJson(std::string_view json) {
+    DictionaryBuilder builder;
+    Parser parser(json, builder, true);
+    const char c = parser.peek();
+    if (c != '{' && c != '[') {
+        parser.error("Expected an object or an array as the top-level value");
+    }
+    parser.parse();
+    return std::move(builder.result);
+}
+
+void parseJson(std::string_view json, JsonHandler& handler) {
+    Parser(json, handler).parse();
+}
+
+} // namespace ghoul
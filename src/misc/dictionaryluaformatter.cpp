@@ -25,151 +25,138 @@
 
 #include <ghoul/misc/dictionaryluaformatter.h>
 
+#include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/misc/dictionary.h>
-#include <cmath>
-#include <functional>
-#include <numeric>
+#include <ghoul/misc/misc.h>
+#include <iterator>
+#include <ostream>
 #include <string>
 
 namespace ghoul {
 
 namespace {
-    std::string formatValue(const Dictionary& dictionary, const std::string& key,
-                            PrettyPrint prettyPrint, const std::string& indentation,
-                            int indentationSteps);
-
-    std::string format(const Dictionary& d, PrettyPrint prettyPrint,
-                       const std::string& indentation, int indentationSteps)
-    {
-        if (d.isEmpty()) {
-            return "{}";
-        }
-
-        std::string indent;
-        if (prettyPrint) {
-            for (int i = 0; i < indentationSteps; i++) {
-                indent += indentation;
+    using internal::PmrString;
+    using internal::PmrVector;
+
+    // The number of bytes that are collected before they are written to the stream
+    constexpr size_t StreamChunkSize = 64 * 1024;
+
+    // The output of the formatting, which is either collected in a string or
+    // periodically flushed into a stream
+    struct Output {
+        std::string& buffer;
+        std::ostream* stream;
+        PrettyPrint prettyPrint;
+        std::string_view indentation;
+
+        void flushIfNeeded() {
+            if (stream && buffer.size() >= StreamChunkSize) {
+                stream->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
             }
         }
-
-        auto convert = [&](const std::string& key) {
-            return
-                (prettyPrint ? indentation : "") + key +
-                (prettyPrint ? " " : "") + "=" + (prettyPrint ? " " : "") +
-                formatValue(d, key, prettyPrint, indentation, indentationSteps + 1);
-        };
-
-        std::vector<std::string> keys;
-        for (std::string_view k : d.keys()) {
-            keys.push_back(std::string(k));
-        }
-
-        std::string lua = std::accumulate(
-            std::next(keys.begin()),
-            keys.end(),
-            convert(*keys.begin()),
-            [&](const std::string& a, const std::string& key) {
-                return a + "," + (prettyPrint ? "\n" : "") + indent + convert(key);
-            }
-        );
-
-        return std::string("{") + (prettyPrint ? "\n" : "") + indent + lua +
-            (prettyPrint ? "\n" : "") + indent + "}";
-    }
+    };
 
     template <typename T>
-    std::string formatVector(const std::vector<T>& vec) {
+    void formatNumbers(std::string& out, const T* values, size_t nValues) {
         static_assert(
             std::is_same_v<T, double> || std::is_same_v<T, int>,
             "Only double or ints allowed"
         );
 
-        if (vec.empty()) {
-            return "{}";
-        }
-
-        std::string values;
-        for (size_t i = 0; i < vec.size() - 1; i++) {
-            values += fmt::format("{},", vec[i]);
+        out += '{';
+        for (size_t i = 0; i < nValues; i++) {
+            if (i > 0) {
+                out += ',';
+            }
+            fmt::format_to(std::back_inserter(out), "{}", values[i]);
         }
-        values += fmt::format("{}", vec.back());
-
-        return fmt::format("{{{}}}", values);
+        out += '}';
     }
 
-    std::string formatValue(const Dictionary& dictionary, const std::string& key,
-                            PrettyPrint prettyPrint, const std::string& indentation,
-                            int indentationSteps)
-    {
-        if (dictionary.hasValue<Dictionary>(key)) {
-            Dictionary subDictionary = dictionary.value<Dictionary>(key);
-            return format(subDictionary, prettyPrint, indentation, indentationSteps);
-        }
-
-        if (dictionary.hasValue<double>(key)) {
-            const double value = dictionary.value<double>(key);
-            return fmt::format("{}", value);
-        }
+    void format(Output& out, const Dictionary& d, int indentationSteps);
 
-        if (dictionary.hasValue<int>(key)) {
-            int value = dictionary.value<int>(key);
-            return std::to_string(value);
-        }
+    void formatValue(Output& out, std::string_view key,
+                     const Dictionary::StorageTypes& value, int indentationSteps)
+    {
+        std::visit(
+            [&out, key, indentationSteps](const auto& v) {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, Dictionary>) {
+                    format(out, v, indentationSteps);
+                }
+                else if constexpr (std::is_same_v<T, double> || std::is_same_v<T, int>) {
+                    fmt::format_to(std::back_inserter(out.buffer), "{}", v);
+                }
+                else if constexpr (std::is_same_v<T, bool>) {
+                    out.buffer += v ? "true" : "false";
+                }
+                else if constexpr (std::is_same_v<T, PmrVector<int>> ||
+                                   std::is_same_v<T, PmrVector<double>>)
+                {
+                    formatNumbers(out.buffer, v.data(), v.size());
+                }
+                else if constexpr (std::is_same_v<T, PmrString>) {
+                    out.buffer += '"';
+                    appendEscapedString(out.buffer, v, EscapeSyntax::Lua);
+                    out.buffer += '"';
+                }
+                else if constexpr (std::is_same_v<T, PmrVector<PmrString>>) {
+                    throw LuaFormattingError(fmt::format(
+                        "Key '{}' has invalid type for formatting dictionary as Lua", key
+                    ));
+                }
+                else {
+                    // glm vectors and matrices are stored as a flat list of numbers
+                    formatNumbers(
+                        out.buffer,
+                        glm::value_ptr(v),
+                        ghoul::glm_components<T>::value
+                    );
+                }
+            },
+            value
+        );
+    }
 
-        if (dictionary.hasValue<bool>(key)) {
-            bool value = dictionary.value<bool>(key);
-            return value ? "true" : "false";
+    void appendIndentation(Output& out, int indentationSteps) {
+        for (int i = 0; i < indentationSteps; i++) {
+            out.buffer += out.indentation;
         }
+    }
 
-        if (dictionary.hasValue<std::vector<int>>(key)) {
-            std::vector<int> vec = dictionary.value<std::vector<int>>(key);
-            return formatVector(vec);
+    void format(Output& out, const Dictionary& d, int indentationSteps) {
+        if (d.isEmpty()) {
+            out.buffer += "{}";
+            return;
         }
 
-        if (dictionary.hasValue<std::vector<double>>(key)) {
-            std::vector<double> vec = dictionary.value<std::vector<double>>(key);
-            return formatVector(vec);
-        }
+        const bool prettyPrint = out.prettyPrint;
+        out.buffer += '{';
+        bool isFirst = true;
+        d.visit(
+            [&](std::string_view key, const Dictionary::StorageTypes& value) {
+                if (!isFirst) {
+                    out.buffer += ',';
+                }
+                isFirst = false;
 
-        if (dictionary.hasValue<std::string>(key)) {
-            std::string value = dictionary.value<std::string>(key);
-
-            std::string luaString;
-            for (const char c : value) {
-                switch (c) {
-                    case '"':
-                        luaString += "\\\"";
-                        break;
-                    case '\\':
-                        luaString += "\\\\";
-                        break;
-                    case '\b':
-                        luaString += "\\b";
-                        break;
-                    case '\f':
-                        luaString += "\\f";
-                        break;
-                    case '\n':
-                        luaString += "\\n";
-                        break;
-                    case '\r':
-                        luaString += "\\r";
-                        break;
-                    case '\t':
-                        luaString += "\\t";
-                        break;
-                    default:
-                        luaString += c;
+                if (prettyPrint) {
+                    out.buffer += '\n';
+                    appendIndentation(out, indentationSteps + 1);
                 }
+                out.buffer += key;
+                out.buffer += prettyPrint ? " = " : "=";
+                formatValue(out, key, value, indentationSteps + 1);
+                out.flushIfNeeded();
             }
-
-            return "\"" + luaString + "\"";
+        );
+        if (prettyPrint) {
+            out.buffer += '\n';
+            appendIndentation(out, indentationSteps);
         }
-
-        throw LuaFormattingError(fmt::format(
-            "Key '{}' has invalid type for formatting dictionary as Lua", key
-        ));
+        out.buffer += '}';
     }
 }  // namespace
 
@@ -180,7 +167,26 @@ LuaFormattingError::LuaFormattingError(const std::string& msg)
 std::string formatLua(const Dictionary& dictionary, PrettyPrint prettyPrint,
                       const std::string& indentation)
 {
-    return format(dictionary, prettyPrint, indentation, 0);
+    std::string lua;
+    formatLua(dictionary, lua, prettyPrint, indentation);
+    return lua;
+}
+
+void formatLua(const Dictionary& dictionary, std::string& output,
+               PrettyPrint prettyPrint, const std::string& indentation)
+{
+    Output out = { output, nullptr, prettyPrint, indentation };
+    format(out, dictionary, 0);
+}
+
+void formatLua(const Dictionary& dictionary, std::ostream& stream,
+               PrettyPrint prettyPrint, const std::string& indentation)
+{
+    std::string buffer;
+    buffer.reserve(StreamChunkSize);
+    Output out = { buffer, &stream, prettyPrint, indentation };
+    format(out, dictionary, 0);
+    stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 }
 
 }  // namespace ghoul
@@ -28,6 +28,14 @@
 #include <algorithm>
 #include <cctype>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GHOUL_MISC_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2
+
 namespace ghoul {
 
 std::vector<std::string> tokenizeString(const std::string& input, char separator) {
@@ -84,5 +92,84 @@ void trimSurroundingCharacters(std::string& valueString, const char charToRemove
     }
 }
 
+size_t findCharacterToEscape(std::string_view value) {
+    const char* begin = value.data();
+    const char* end = value.data() + value.size();
+    const char* p = begin;
+
+#ifdef GHOUL_MISC_USE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    while (end - p >= 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, quote), _mm_cmpeq_epi8(c, backslash)),
+            // An unsigned c <= 0x1F is the only case in which max(c, 0x1F) == 0x1F
+            _mm_cmpeq_epi8(_mm_max_epu8(c, control), control)
+        );
+        const int mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward(&bit, static_cast<unsigned long>(mask));
+            return static_cast<size_t>(p - begin) + bit;
+#else // ^^^^ _MSC_VER // !_MSC_VER vvvv
+            return static_cast<size_t>(p - begin) + __builtin_ctz(mask);
+#endif // _MSC_VER
+        }
+        p += 16;
+    }
+#endif // GHOUL_MISC_USE_SSE2
+
+    for (; p != end; ++p) {
+        if (*p == '"' || *p == '\\' || static_cast<unsigned char>(*p) < 0x20) {
+            return static_cast<size_t>(p - begin);
+        }
+    }
+    return std::string_view::npos;
+}
+
+void appendEscapedString(std::string& output, std::string_view value,
+                         EscapeSyntax syntax)
+{
+    while (!value.empty()) {
+        const size_t pos = findCharacterToEscape(value);
+        if (pos == std::string_view::npos) {
+            output += value;
+            return;
+        }
+
+        output.append(value.data(), pos);
+        switch (value[pos]) {
+            case '"':  output += "\\\"";  break;
+            case '\\': output += "\\\\"; break;
+            case '\b': output += "\\b";  break;
+            case '\f': output += "\\f";  break;
+            case '\n': output += "\\n";  break;
+            case '\r': output += "\\r";  break;
+            case '\t': output += "\\t";  break;
+            default:
+            {
+                // The remaining control characters do not have a short escape sequence
+                const unsigned char c = static_cast<unsigned char>(value[pos]);
+                if (syntax == EscapeSyntax::Json) {
+                    constexpr const char Hex[] = "0123456789abcdef";
+                    output += "\\u00";
+                    output += Hex[c >> 4];
+                    output += Hex[c & 0xF];
+                }
+                else {
+                    // Always three digits so that a following digit is not consumed
+                    output += '\\';
+                    output += static_cast<char>('0' + c / 100);
+                    output += static_cast<char>('0' + c / 10 % 10);
+                    output += static_cast<char>('0' + c % 10);
+                }
+            }
+        }
+        value.remove_prefix(pos + 1);
+    }
+}
 
 } // namespace ghoul
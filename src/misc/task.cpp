@@ -0,0 +1,155 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/task.h>
+
+#include <utility>
+
+namespace ghoul {
+
+namespace internal {
+
+void TaskStateBase::addRef() {
+    _refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TaskStateBase::release() {
+    if (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        recycle();
+    }
+}
+
+bool TaskStateBase::isReady() const {
+    return _isReady.load(std::memory_order_acquire);
+}
+
+void TaskStateBase::wait() {
+    if (isReady()) {
+        return;
+    }
+
+    std::unique_lock lock(_mutex);
+    _hasWaiters = true;
+    _cv.wait(lock, [this]() { return _isReady.load(std::memory_order_relaxed); });
+}
+
+ThreadPool* TaskStateBase::pool() const {
+    return _pool;
+}
+
+void TaskStateBase::setPool(ThreadPool* pool) {
+    _pool = pool;
+}
+
+TaskId TaskStateBase::taskId() const {
+    return _taskId;
+}
+
+void TaskStateBase::setTaskId(TaskId id) {
+    _taskId = id;
+}
+
+void TaskStateBase::addContinuation(ThreadPool* pool, Task task) {
+    {
+        std::lock_guard lock(_mutex);
+        if (!_isReady) {
+            _continuations.push_back({ pool, std::move(task) });
+            return;
+        }
+    }
+
+    // The value is already available, so there is no need to wait
+    if (pool) {
+        scheduleTask(pool, std::move(task));
+    }
+    else {
+        task();
+    }
+}
+
+void TaskStateBase::finish() {
+    bool hasWaiters = false;
+    std::vector<Continuation> continuations;
+    {
+        std::lock_guard lock(_mutex);
+        _isReady.store(true, std::memory_order_release);
+        hasWaiters = _hasWaiters;
+        continuations.swap(_continuations);
+    }
+
+    if (hasWaiters) {
+        _cv.notify_all();
+    }
+
+    for (Continuation& c : continuations) {
+        if (c.pool) {
+            scheduleTask(c.pool, std::move(c.task));
+        }
+        else {
+            c.task();
+        }
+    }
+}
+
+void TaskStateBase::reset() {
+    _refCount = 1;
+    _isReady = false;
+    _exception = nullptr;
+    _pool = nullptr;
+    _taskId = 0;
+    _hasWaiters = false;
+    _continuations.clear();
+}
+
+} // namespace internal
+
+TaskDependency::TaskDependency(const TaskDependency& other)
+    : _state(other._state)
+{
+    if (_state) {
+        _state->addRef();
+    }
+}
+
+TaskDependency::TaskDependency(TaskDependency&& other) noexcept
+    : _state(std::exchange(other._state, nullptr))
+{}
+
+TaskDependency& TaskDependency::operator=(TaskDependency other) noexcept {
+    std::swap(_state, other._state);
+    return *this;
+}
+
+TaskDependency::~TaskDependency() {
+    if (_state) {
+        _state->release();
+    }
+}
+
+bool TaskDependency::isReady() const {
+    return _state && _state->isReady();
+}
+
+} // namespace ghoul
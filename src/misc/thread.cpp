@@ -36,11 +36,182 @@
 #include <Windows.h>
 #else
 #include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#endif // __linux__
 #endif
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
 
 namespace ghoul::thread {
 namespace {
 
+// Parses a list of CPU indices in the format used by the Linux kernel, for example
+// "0-3,8,10-11"
+std::vector<int> parseCpuList(std::string list) {
+    list.erase(
+        std::remove_if(
+            list.begin(),
+            list.end(),
+            [](char c) { return std::isspace(static_cast<unsigned char>(c)); }
+        ),
+        list.end()
+    );
+
+    std::vector<int> result;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+
+        try {
+            const size_t dash = range.find('-');
+            const int first = std::stoi(range.substr(0, dash));
+            const int last =
+                dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int i = first; i <= last; ++i) {
+                result.push_back(i);
+            }
+        }
+        catch (const std::logic_error&) {
+            throw ghoul::RuntimeError("Malformed list of CPUs '" + list + "'", "Thread");
+        }
+    }
+    return result;
+}
+
+std::optional<std::string> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file.good()) {
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+int readInt(const std::filesystem::path& path, int defaultValue) {
+    std::ifstream file(path);
+    int value = defaultValue;
+    if (!(file >> value)) {
+        return defaultValue;
+    }
+    return value;
+}
+
+// Returns the list of CPUs that share the cache with the highest level, which is the
+// last-level cache, or an empty list if there is no cache information
+std::vector<int> lastLevelCacheCpus(const std::filesystem::path& cpu) {
+    int highestLevel = -1;
+    std::vector<int> cpus;
+
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry :
+         std::filesystem::directory_iterator(cpu / "cache", ec))
+    {
+        if (entry.path().filename().string().rfind("index", 0) != 0) {
+            continue;
+        }
+
+        const int level = readInt(entry.path() / "level", -1);
+        std::optional<std::string> shared = readFile(entry.path() / "shared_cpu_list");
+        if (level > highestLevel && shared.has_value()) {
+            highestLevel = level;
+            cpus = parseCpuList(*shared);
+        }
+    }
+    return cpus;
+}
+
+// Used when the topology can not be detected
+CpuTopology defaultTopology() {
+    const int nCpus = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    CpuTopology topology;
+    for (int i = 0; i < nCpus; ++i) {
+        LogicalCpu cpu;
+        cpu.id = i;
+        cpu.core = i;
+        topology.cpus.push_back(cpu);
+    }
+    return topology;
+}
+
+#ifdef WIN32
+std::optional<CpuTopology> windowsTopology() {
+    using Info = SYSTEM_LOGICAL_PROCESSOR_INFORMATION;
+
+    DWORD length = 0;
+    GetLogicalProcessorInformation(nullptr, &length);
+    std::vector<Info> info(length / sizeof(Info));
+    if (info.empty() || !GetLogicalProcessorInformation(info.data(), &length)) {
+        return std::nullopt;
+    }
+
+    // The last-level cache is the cache with the highest level
+    BYTE cacheLevel = 0;
+    for (const Info& i : info) {
+        if (i.Relationship == RelationCache) {
+            cacheLevel = std::max(cacheLevel, i.Cache.Level);
+        }
+    }
+
+    std::map<int, LogicalCpu> cpus;
+    auto forEachCpu = [&cpus](ULONG_PTR mask, auto function) {
+        for (int bit = 0; bit < static_cast<int>(sizeof(ULONG_PTR) * 8); ++bit) {
+            if (mask & (static_cast<ULONG_PTR>(1) << bit)) {
+                LogicalCpu& cpu = cpus[bit];
+                cpu.id = bit;
+                function(cpu);
+            }
+        }
+    };
+
+    int nCores = 0;
+    int nPackages = 0;
+    int nCacheGroups = 0;
+    for (const Info& i : info) {
+        switch (i.Relationship) {
+            case RelationProcessorCore:
+                forEachCpu(i.ProcessorMask, [&](LogicalCpu& c) { c.core = nCores; });
+                nCores++;
+                break;
+            case RelationProcessorPackage:
+                forEachCpu(
+                    i.ProcessorMask,
+                    [&](LogicalCpu& c) { c.package = nPackages; }
+                );
+                nPackages++;
+                break;
+            case RelationCache:
+                if (i.Cache.Level == cacheLevel) {
+                    forEachCpu(
+                        i.ProcessorMask,
+                        [&](LogicalCpu& c) { c.cacheGroup = nCacheGroups; }
+                    );
+                    nCacheGroups++;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    CpuTopology topology;
+    for (const std::pair<const int, LogicalCpu>& cpu : cpus) {
+        topology.cpus.push_back(cpu.second);
+    }
+    return topology;
+}
+#endif // WIN32
+
 int convertThreadPriorityLevel([[maybe_unused]] ThreadPriorityClass c,
                                ThreadPriorityLevel p) {
 #ifdef WIN32
@@ -145,4 +316,138 @@ void setThreadBackground(std::thread& t, Background background) {
 void setThreadBackground(std::thread&, Background) {}
 #endif // WIN32
 
+void setAffinity([[maybe_unused]] std::thread& t, const std::vector<int>& cpus) {
+    ghoul_assert(!cpus.empty(), "cpus must not be empty");
+
+#if defined WIN32
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+    }
+    if (mask == 0 || SetThreadAffinityMask(t.native_handle(), mask) == 0) {
+        throw ghoul::RuntimeError(
+            "Error setting thread affinity with error " + std::to_string(GetLastError()),
+            "Thread"
+        );
+    }
+#elif defined __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    const int res = pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+    if (res != 0) {
+        throw ghoul::RuntimeError(
+            "Error setting thread affinity with error " + std::to_string(res),
+            "Thread"
+        );
+    }
+#endif
+}
+
+int CpuTopology::nPhysicalCores() const {
+    std::set<int> cores;
+    for (const LogicalCpu& cpu : cpus) {
+        cores.insert(cpu.core);
+    }
+    return static_cast<int>(cores.size());
+}
+
+int CpuTopology::nCacheGroups() const {
+    std::set<int> groups;
+    for (const LogicalCpu& cpu : cpus) {
+        groups.insert(cpu.cacheGroup);
+    }
+    return static_cast<int>(groups.size());
+}
+
+CpuTopology cpuTopology() {
+#if defined WIN32
+    std::optional<CpuTopology> topology = windowsTopology();
+    if (topology.has_value() && !topology->cpus.empty()) {
+        return *topology;
+    }
+#elif defined __linux__
+    try {
+        CpuTopology topology = cpuTopology("/sys/devices/system/cpu");
+
+        // We are only interested in the CPUs that this process is allowed to use, which
+        // might be fewer than the online CPUs, for example in a container
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            std::vector<LogicalCpu>& cpus = topology.cpus;
+            cpus.erase(
+                std::remove_if(
+                    cpus.begin(),
+                    cpus.end(),
+                    [&set](const LogicalCpu& cpu) {
+                        return cpu.id >= CPU_SETSIZE || !CPU_ISSET(cpu.id, &set);
+                    }
+                ),
+                cpus.end()
+            );
+        }
+
+        if (!topology.cpus.empty()) {
+            return topology;
+        }
+    }
+    catch (const RuntimeError&) {
+        // If the topology can not be read, we fall back to the default
+    }
+#endif
+    return defaultTopology();
+}
+
+CpuTopology cpuTopology(const std::filesystem::path& directory) {
+    std::optional<std::string> online = readFile(directory / "online");
+    if (!online.has_value()) {
+        throw ghoul::RuntimeError(
+            "Could not read the online CPUs from '" + directory.string() + "'",
+            "Thread"
+        );
+    }
+
+    // The core and cache group identifiers reported by the system are replaced by
+    // consecutive indices. The core identifiers are only unique within a package
+    std::map<std::pair<int, int>, int> cores;
+    std::map<std::vector<int>, int> cacheGroups;
+
+    CpuTopology topology;
+    for (int id : parseCpuList(*online)) {
+        const std::filesystem::path cpuPath = directory / ("cpu" + std::to_string(id));
+
+        LogicalCpu cpu;
+        cpu.id = id;
+        cpu.package = readInt(cpuPath / "topology" / "physical_package_id", 0);
+
+        const int coreId = readInt(cpuPath / "topology" / "core_id", id);
+        const int nCores = static_cast<int>(cores.size());
+        cpu.core = cores.try_emplace({ cpu.package, coreId }, nCores).first->second;
+
+        std::vector<int> cacheCpus = lastLevelCacheCpus(cpuPath);
+        if (cacheCpus.empty()) {
+            // Negative keys can not collide with lists of CPUs
+            cacheCpus = { -1 - cpu.package };
+        }
+        const int nCacheGroups = static_cast<int>(cacheGroups.size());
+        cpu.cacheGroup = cacheGroups.try_emplace(cacheCpus, nCacheGroups).first->second;
+
+        topology.cpus.push_back(cpu);
+    }
+
+    std::sort(
+        topology.cpus.begin(),
+        topology.cpus.end(),
+        [](const LogicalCpu& lhs, const LogicalCpu& rhs) { return lhs.id < rhs.id; }
+    );
+    return topology;
+}
+
 } // namespace ghoul::thread
@@ -28,32 +28,267 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/defer.h>
+#include <ghoul/misc/exception.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <tuple>
 
 namespace {
-    // The wait-out time for the condition_variable inside the worker threads
-    constexpr const std::chrono::seconds WaitTime(1);
-}  // namespace
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    // The Tasks that are pushed into the Workers' queues in the work-stealing mode are
+    // recycled so that we don't have to allocate memory for every queued Task
+    template <typename QueuedTask>
+    QueuedTask* acquireTask(ghoul::Task&& task, TimePoint enqueueTime) {
+        QueuedTask* t = ghoul::internal::ThreadLocalFreeList<QueuedTask>::acquire();
+        if (!t) {
+            t = new QueuedTask;
+        }
+        t->task = std::move(task);
+        t->enqueueTime = enqueueTime;
+        return t;
+    }
+
+    template <typename QueuedTask>
+    void releaseTask(QueuedTask* task) {
+        // Destroy the callable object before caching the Task
+        task->task = ghoul::Task();
+        ghoul::internal::ThreadLocalFreeList<QueuedTask>::release(task);
+    }
+
+    // Returns the index of the Histogram bucket for the duration, which is the position
+    // of the highest set bit
+    int bucketIndex(uint64_t nanoseconds, int nBuckets) {
+        int i = 0;
+        while (nanoseconds > 1 && i < nBuckets - 1) {
+            nanoseconds >>= 1;
+            i++;
+        }
+        return i;
+    }
+
+    // The counters are only ever written by a single Worker, so a relaxed load and store
+    // is sufficient to update the maximum
+    void updateMaximum(std::atomic<uint64_t>& maximum, uint64_t value) {
+        if (value > maximum.load(std::memory_order_relaxed)) {
+            maximum.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t toNanoseconds(std::chrono::steady_clock::duration duration) {
+        const int64_t ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    }
+
+    // The state that is shared between the caller of ThreadPool::runChunked and the
+    // helper tasks. It lives on the heap as helpers might only start after the caller
+    // has already returned, in which case they will not find any work and only touch
+    // this state
+    struct ChunkedState {
+        ChunkedState(int64_t begin, int64_t e, int64_t grain, int participants,
+                     const std::function<void(int64_t, int64_t)>& func)
+            : next(begin)
+            , end(e)
+            , grainSize(grain)
+            , nParticipants(participants)
+            , function(&func)
+        {}
+
+        // Claims the next chunk. The chunk size is proportional to the remaining work so
+        // that the early chunks are large and the later chunks balance the load
+        bool claim(int64_t& chunkBegin, int64_t& chunkEnd) {
+            int64_t current = next.load();
+            while (current < end) {
+                const int64_t size = std::max(
+                    grainSize,
+                    (end - current) / (2 * static_cast<int64_t>(nParticipants))
+                );
+                const int64_t last = std::min(end, current + size);
+                if (next.compare_exchange_weak(current, last)) {
+                    chunkBegin = current;
+                    chunkEnd = last;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Processes chunks until none are left
+        void participate() {
+            int64_t chunkBegin = 0;
+            int64_t chunkEnd = 0;
+            while (claim(chunkBegin, chunkEnd)) {
+                try {
+                    (*function)(chunkBegin, chunkEnd);
+                }
+                catch (...) {
+                    std::lock_guard lock(mutex);
+                    if (!exception) {
+                        exception = std::current_exception();
+                    }
+                    // Prevent anyone from claiming the remaining chunks
+                    next = end;
+                }
+            }
+        }
+
+        std::atomic<int64_t> next;
+        const int64_t end;
+        const int64_t grainSize;
+        const int nParticipants;
+        // Only valid as long as the caller is waiting, which is the case for as long as
+        // chunks can be claimed
+        const std::function<void(int64_t, int64_t)>* function;
+
+        // The number of helpers that are currently participating
+        std::atomic_int nActive = 0;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr exception;
+    };
+} // namespace
 
 namespace ghoul {
 
+void internal::scheduleTask(ThreadPool* pool, Task&& task) {
+    ghoul_assert(pool, "ThreadPool must not be nullptr");
+    pool->enqueue(std::move(task));
+}
+
 using Func = std::function<void()>;
 using namespace thread;
 
+ThreadPool::TaskOptions::TaskOptions(Priority taskPriority,
+                    std::optional<std::chrono::steady_clock::time_point> taskDeadline)
+    : priority(taskPriority)
+    , deadline(std::move(taskDeadline))
+{}
+
+ThreadPool::Placement::Placement(Strategy placementStrategy,
+                                 PhysicalCoresOnly physicalCores,
+                                 std::vector<int> excluded)
+    : strategy(placementStrategy)
+    , physicalCoresOnly(physicalCores)
+    , excludedCpus(std::move(excluded))
+{}
+
+std::vector<std::vector<int>> ThreadPool::Placement::workerCpus(
+                                                const thread::CpuTopology& topology) const
+{
+    if (strategy == Strategy::None) {
+        return {};
+    }
+
+    auto isExcluded = [this](int cpu) {
+        return std::find(excludedCpus.begin(), excludedCpus.end(), cpu) !=
+               excludedCpus.end();
+    };
+
+    // The set of logical CPUs that a single Worker is pinned to. The rank is the index
+    // of the hardware thread within its physical core
+    struct Unit {
+        std::vector<int> cpus;
+        int core = 0;
+        int cacheGroup = 0;
+        int rank = 0;
+    };
+    std::vector<Unit> units;
+
+    if (physicalCoresOnly) {
+        std::map<int, Unit> cores;
+        std::set<int> excludedCores;
+        for (const thread::LogicalCpu& cpu : topology.cpus) {
+            Unit& unit = cores[cpu.core];
+            unit.cpus.push_back(cpu.id);
+            unit.core = cpu.core;
+            unit.cacheGroup = cpu.cacheGroup;
+            if (isExcluded(cpu.id)) {
+                excludedCores.insert(cpu.core);
+            }
+        }
+        for (std::pair<const int, Unit>& core : cores) {
+            if (excludedCores.find(core.first) == excludedCores.end()) {
+                units.push_back(std::move(core.second));
+            }
+        }
+    }
+    else {
+        std::map<int, int> nHardwareThreads;
+        for (const thread::LogicalCpu& cpu : topology.cpus) {
+            const int rank = nHardwareThreads[cpu.core]++;
+            if (!isExcluded(cpu.id)) {
+                units.push_back({ { cpu.id }, cpu.core, cpu.cacheGroup, rank });
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> result;
+    if (strategy == Strategy::Compact) {
+        // Fill each cache group core by core before moving on to the next group
+        std::stable_sort(
+            units.begin(),
+            units.end(),
+            [](const Unit& lhs, const Unit& rhs) {
+                return std::tie(lhs.cacheGroup, lhs.core, lhs.rank) <
+                       std::tie(rhs.cacheGroup, rhs.core, rhs.rank);
+            }
+        );
+        for (Unit& unit : units) {
+            result.push_back(std::move(unit.cpus));
+        }
+    }
+    else {
+        // Within each cache group, the first hardware thread of every core is used
+        // before the second one, and the groups take turns
+        std::map<int, std::vector<Unit>> groups;
+        for (Unit& unit : units) {
+            groups[unit.cacheGroup].push_back(std::move(unit));
+        }
+        for (std::pair<const int, std::vector<Unit>>& group : groups) {
+            std::stable_sort(
+                group.second.begin(),
+                group.second.end(),
+                [](const Unit& lhs, const Unit& rhs) {
+                    return std::tie(lhs.rank, lhs.core) < std::tie(rhs.rank, rhs.core);
+                }
+            );
+        }
+
+        for (size_t i = 0; result.size() < units.size(); ++i) {
+            for (std::pair<const int, std::vector<Unit>>& group : groups) {
+                if (i < group.second.size()) {
+                    result.push_back(std::move(group.second[i].cpus));
+                }
+            }
+        }
+    }
+    return result;
+}
+
+thread_local ThreadPool::WorkerContext ThreadPool::_currentWorker;
+
 ThreadPool::ThreadPool(int nThreads, Func workerInit, Func workerDeinit,
                        ThreadPriorityClass tpc, ThreadPriorityLevel tpl,
-                       Background bg)
+                       Background bg, WorkStealing workStealing)
     : _workers(nThreads)
     , _taskQueue(std::make_shared<TaskQueue>())
     , _isRunning(std::make_shared<std::atomic_bool>(true))
     , _nWaiting(std::make_shared<std::atomic_int>(0))
-    , _mutex(std::make_shared<std::mutex>())
-    , _cv(std::make_shared<std::condition_variable>())
+    , _localQueues(std::make_shared<LocalQueueRegistry>())
+    , _eventCount(std::make_shared<EventCount>())
+    , _statistics(std::make_shared<StatisticsState>())
     , _workerInitialization(std::move(workerInit))
     , _workerDeinitialization(std::move(workerDeinit))
     , _threadPriorityClass(tpc)
     , _threadPriorityLevel(tpl)
     , _threadBackground(bg)
+    , _workStealing(workStealing)
 {
     ghoul_assert(nThreads > 0, "nThreads must be bigger than 0");
     ghoul_assert(_workerInitialization, "workerInit must not be empty");
@@ -115,7 +350,7 @@ void ThreadPool::stop(RunRemainingTasks runTasks, DetachThreads detachThreads) {
     // Wake up all of the threads, all of the threads that cannot find tasks will
     // terminate
     for (Worker& w : _workers) {
-        _cv->notify_all();
+        _eventCount->notifyAll();
         if (detachThreads) {
             // Detaching the thread to let it finish it's work independently
             w.thread->detach();
@@ -127,9 +362,9 @@ void ThreadPool::stop(RunRemainingTasks runTasks, DetachThreads detachThreads) {
     }
 
     // Delete all the workers. We don't want to actually delete them as we would otherwise
-    // lose information about their sizes
+    // lose information about their sizes. Their statistics are kept for the next start
     for (Worker& w : _workers) {
-        w = { nullptr, nullptr };
+        w = Worker{ nullptr, nullptr, nullptr, std::move(w.statistics) };
     }
 
     ghoul_assert(!isRunning(), "The ThreadPool is still running");
@@ -157,15 +392,22 @@ void ThreadPool::resize(int nThreads) {
     else {
         // the number of threads has decreased
         for (int i = oldNThreads - 1; i >= nThreads; --i) {
-            // Tell the superfluous threads to finish
-            *(_workers[i].shouldTerminate) = true;
+            if (_workers[i].thread) {
+                // Tell the superfluous threads to finish
+                *(_workers[i].shouldTerminate) = true;
 
-            // And detach the thread so we can safely remove the Worker object
-            _workers[i].thread->detach();
+                // And detach the thread so we can safely remove the Worker object
+                _workers[i].thread->detach();
+            }
+
+            if (_workers[i].statistics) {
+                std::lock_guard lock(_statistics->mutex);
+                _statistics->retired.push_back(std::move(_workers[i].statistics));
+            }
         }
         // The notification will do nothing for the first 'nThreads' threads, but it
         // will cause the remaining 'nThreads - oldNThreads' to return
-        _cv->notify_all();
+        _eventCount->notifyAll();
 
         // safe to delete because the threads are detached
         _workers.resize(nThreads);
@@ -182,7 +424,202 @@ int ThreadPool::idleThreads() const {
 }
 
 int ThreadPool::remainingTasks() const {
-    return _taskQueue->size();
+    int nTasks = _taskQueue->size();
+
+    std::lock_guard lock(_localQueues->mutex);
+    for (const std::shared_ptr<LocalQueue>& queue : _localQueues->queues) {
+        nTasks += queue->size();
+    }
+    return nTasks;
+}
+
+ThreadPool::WakeStatistics ThreadPool::wakeStatistics() const {
+    return _eventCount->statistics();
+}
+
+void ThreadPool::resetWakeStatistics() {
+    _eventCount->resetStatistics();
+}
+
+void ThreadPool::setStatisticsEnabled(bool enabled) {
+    _statistics->isEnabled = enabled;
+}
+
+bool ThreadPool::isStatisticsEnabled() const {
+    return _statistics->isEnabled;
+}
+
+ThreadPool::Statistics ThreadPool::statistics() const {
+    Statistics statistics;
+    for (const Worker& w : _workers) {
+        if (w.statistics) {
+            statistics.workers.push_back(w.statistics->snapshot());
+            w.statistics->addTo(statistics);
+        }
+        else {
+            statistics.workers.emplace_back();
+        }
+    }
+
+    {
+        std::lock_guard lock(_statistics->mutex);
+        for (const std::shared_ptr<WorkerCounters>& counters : _statistics->retired) {
+            counters->addTo(statistics);
+        }
+    }
+
+    statistics.peakQueueDepth = _taskQueue->peakSize();
+    return statistics;
+}
+
+void ThreadPool::resetStatistics() {
+    for (Worker& w : _workers) {
+        if (w.statistics) {
+            w.statistics->reset();
+        }
+    }
+
+    {
+        std::lock_guard lock(_statistics->mutex);
+        _statistics->retired.clear();
+    }
+
+    _taskQueue->resetPeakSize();
+}
+
+std::chrono::nanoseconds ThreadPool::Histogram::mean() const {
+    if (count == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return total / static_cast<int64_t>(count);
+}
+
+std::chrono::nanoseconds ThreadPool::Histogram::percentile(double fraction) const {
+    ghoul_assert(fraction >= 0.0 && fraction <= 1.0, "fraction must be between 0 and 1");
+
+    if (count == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    const uint64_t target = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count))),
+        1
+    );
+    uint64_t sum = 0;
+    for (int i = 0; i < NBuckets; ++i) {
+        sum += buckets[i];
+        if (sum >= target) {
+            const std::chrono::nanoseconds upperBound(int64_t(1) << (i + 1));
+            return std::min(upperBound, max);
+        }
+    }
+    return max;
+}
+
+void ThreadPool::HistogramCounters::add(std::chrono::nanoseconds duration) {
+    const uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    buckets[bucketIndex(ns, Histogram::NBuckets)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(ns, std::memory_order_relaxed);
+    updateMaximum(max, ns);
+}
+
+void ThreadPool::HistogramCounters::addTo(Histogram& histogram) const {
+    for (int i = 0; i < Histogram::NBuckets; ++i) {
+        const uint64_t n = buckets[i].load(std::memory_order_relaxed);
+        histogram.buckets[i] += n;
+        histogram.count += n;
+    }
+    const std::chrono::nanoseconds m(max.load(std::memory_order_relaxed));
+    histogram.total += std::chrono::nanoseconds(total.load(std::memory_order_relaxed));
+    histogram.max = std::max(histogram.max, m);
+}
+
+void ThreadPool::HistogramCounters::reset() {
+    for (std::atomic<uint64_t>& bucket : buckets) {
+        bucket = 0;
+    }
+    total = 0;
+    max = 0;
+}
+
+void ThreadPool::WorkerCounters::addTo(Statistics& statistics) const {
+    queueWait.addTo(statistics.queueWait);
+    execution.addTo(statistics.execution);
+    statistics.nTasks += nTasks.load(std::memory_order_relaxed);
+    statistics.nSteals += nSteals.load(std::memory_order_relaxed);
+    statistics.nWakeups += nWakeups.load(std::memory_order_relaxed);
+}
+
+ThreadPool::WorkerStatistics ThreadPool::WorkerCounters::snapshot() const {
+    WorkerStatistics statistics;
+    using std::chrono::nanoseconds;
+    statistics.busyTime = nanoseconds(busyTime.load(std::memory_order_relaxed));
+    statistics.idleTime = nanoseconds(idleTime.load(std::memory_order_relaxed));
+    statistics.nTasks = nTasks.load(std::memory_order_relaxed);
+    statistics.nSteals = nSteals.load(std::memory_order_relaxed);
+    statistics.nWakeups = nWakeups.load(std::memory_order_relaxed);
+    statistics.peakQueueDepth = peakQueueDepth.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void ThreadPool::WorkerCounters::reset() {
+    queueWait.reset();
+    execution.reset();
+    busyTime = 0;
+    idleTime = 0;
+    nTasks = 0;
+    nSteals = 0;
+    nWakeups = 0;
+    peakQueueDepth = 0;
+}
+
+bool ThreadPool::isWorkStealing() const {
+    return _workStealing;
+}
+
+void ThreadPool::setPlacement(Placement placement) {
+    _placement = std::move(placement);
+    const thread::CpuTopology topology = thread::cpuTopology();
+    _workerCpus = _placement.workerCpus(topology);
+
+    if (_placement.strategy == Placement::Strategy::None) {
+        // Undo a previous placement by allowing the Workers to run on all CPUs again
+        std::vector<int> cpus;
+        for (const thread::LogicalCpu& cpu : topology.cpus) {
+            cpus.push_back(cpu.id);
+        }
+        _workerCpus = { cpus };
+    }
+    else if (_workerCpus.empty()) {
+        LWARNINGC("ThreadPool", "No CPUs are left for the placement of the Workers");
+    }
+
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        if (_workers[i].thread) {
+            applyPlacement(*_workers[i].thread, i);
+        }
+    }
+
+    if (_placement.strategy == Placement::Strategy::None) {
+        _workerCpus.clear();
+    }
+}
+
+const ThreadPool::Placement& ThreadPool::placement() const {
+    return _placement;
+}
+
+void ThreadPool::applyPlacement(std::thread& workerThread, size_t index) {
+    if (_workerCpus.empty()) {
+        return;
+    }
+
+    try {
+        thread::setAffinity(workerThread, _workerCpus[index % _workerCpus.size()]);
+    }
+    catch (const RuntimeError& e) {
+        LWARNINGC("ThreadPool", "Could not pin Worker: " + std::string(e.what()));
+    }
 }
 
 void ThreadPool::clearRemainingTasks() {
@@ -190,13 +627,192 @@ void ThreadPool::clearRemainingTasks() {
         _taskQueue->pop();
     }
 
+    // We are not the owner of the Workers' queues, but stealing all of their tasks has
+    // the same effect as popping them
+    {
+        std::lock_guard lock(_localQueues->mutex);
+        for (const std::shared_ptr<LocalQueue>& queue : _localQueues->queues) {
+            while (!queue->isEmpty()) {
+                if (QueuedTask* t = queue->steal()) {
+                    releaseTask(t);
+                }
+            }
+        }
+    }
+
     ghoul_assert(_taskQueue->isEmpty(), "Task queue is not empty");
 }
 
+bool ThreadPool::cancel(TaskId id) {
+    // The task is destroyed only after the queue has been unlocked, as destroying it
+    // breaks its promise, which might queue continuations
+    Task task;
+    return _taskQueue->extract(id, task);
+}
+
+bool ThreadPool::reprioritize(TaskId id, Priority priority) {
+    return _taskQueue->reprioritize(id, priority);
+}
+
+void ThreadPool::enqueue(Task&& task) {
+    enqueue(std::move(task), TaskOptions(), 0);
+}
+
+void ThreadPool::enqueue(Task&& task, const TaskOptions& options, TaskId id) {
+    const bool hasDefaultOptions =
+        options.priority == Priority::Normal && !options.deadline.has_value();
+
+    if (_workStealing && hasDefaultOptions && _currentWorker.pool == _taskQueue.get() &&
+        _currentWorker.localQueue)
+    {
+        // We are called from one of our own Workers, so we can keep the task local to
+        // that Worker without touching the shared queue
+        LocalQueue* queue = _currentWorker.localQueue;
+        const TimePoint now = enqueueTime();
+        queue->push(acquireTask<QueuedTask>(std::move(task), now));
+        if (now != TimePoint()) {
+            std::atomic_int& peak = _currentWorker.statistics->peakQueueDepth;
+            const int depth = queue->size();
+            if (depth > peak.load(std::memory_order_relaxed)) {
+                peak.store(depth, std::memory_order_relaxed);
+            }
+        }
+    }
+    else {
+        _taskQueue->push(std::move(task), options, id, enqueueTime());
+    }
+
+    // Notify a potentially waiting thread that a new task is available
+    _eventCount->notify();
+}
+
+TaskId ThreadPool::nextTaskId() {
+    return _nextTaskId.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::chrono::steady_clock::time_point ThreadPool::enqueueTime() const {
+    if (_statistics->isEnabled.load(std::memory_order_relaxed)) {
+        return std::chrono::steady_clock::now();
+    }
+    else {
+        return TimePoint();
+    }
+}
+
+void ThreadPool::enqueueBulk(std::vector<Task>&& tasks, const TaskOptions& options,
+                             TaskId firstId)
+{
+    const int nTasks = static_cast<int>(tasks.size());
+    _taskQueue->pushMany(std::move(tasks), options, firstId, enqueueTime());
+    _eventCount->notifyMany(nTasks);
+}
+
+void ThreadPool::enqueueAfter(std::vector<TaskDependency> dependencies, Task&& task) {
+    if (dependencies.empty()) {
+        enqueue(std::move(task));
+        return;
+    }
+
+    // The dependency that finishes last queues the task
+    struct Join {
+        std::atomic_int nRemaining;
+        Task task;
+    };
+    auto join = std::make_shared<Join>();
+    join->nRemaining = static_cast<int>(dependencies.size());
+    join->task = std::move(task);
+
+    for (const TaskDependency& dependency : dependencies) {
+        dependency._state->addContinuation(nullptr, Task([this, join]() {
+            if (--join->nRemaining == 0) {
+                enqueue(std::move(join->task));
+            }
+        }));
+    }
+}
+
+ThreadPool::ScheduleOperation::ScheduleOperation(ThreadPool& pool)
+    : _pool(pool)
+{}
+
+bool ThreadPool::ScheduleOperation::await_ready() const noexcept {
+    return false;
+}
+
+void ThreadPool::ScheduleOperation::await_resume() const noexcept {}
+
+ThreadPool::ScheduleOperation ThreadPool::schedule() {
+    return ScheduleOperation(*this);
+}
+
+void ThreadPool::runChunked(int64_t begin, int64_t end, int64_t grainSize,
+                            const std::function<void(int64_t, int64_t)>& function)
+{
+    const int64_t nChunks = (end - begin + grainSize - 1) / grainSize;
+    const int nHelpers = static_cast<int>(
+        std::min<int64_t>(*_isRunning ? size() : 0, nChunks - 1)
+    );
+    if (nHelpers <= 0) {
+        // Not worth involving anyone else
+        function(begin, end);
+        return;
+    }
+
+    auto state = std::make_shared<ChunkedState>(
+        begin,
+        end,
+        grainSize,
+        nHelpers + 1,
+        function
+    );
+
+    for (int i = 0; i < nHelpers; ++i) {
+        enqueue(Task([state]() {
+            state->nActive++;
+            state->participate();
+            if (--state->nActive == 0) {
+                std::lock_guard lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }));
+    }
+
+    // We do our share of the work, and when there are no chunks left, we only have to
+    // wait for the helpers that are still working on a chunk. Helpers that have not
+    // started yet will not find any work, so we never wait for a task that is stuck in a
+    // queue, which makes nested calls from inside the Workers safe
+    state->participate();
+    {
+        std::unique_lock lock(state->mutex);
+        state->cv.wait(lock, [&state]() { return state->nActive == 0; });
+    }
+
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
 void ThreadPool::activateWorker(Worker& worker) {
     // a copy of the shared ptr to the flag
     auto shouldTerminate = std::make_shared<std::atomic_bool>(false);
 
+    // In the work-stealing mode, each Worker gets its own queue that is registered so
+    // that the other Workers can find it
+    std::shared_ptr<LocalQueue> localQueue;
+    if (_workStealing) {
+        localQueue = std::make_shared<LocalQueue>();
+
+        std::lock_guard lock(_localQueues->mutex);
+        _localQueues->queues.push_back(localQueue);
+        _localQueues->version++;
+    }
+
+    // The statistics are kept in the Worker so that they survive stopping the ThreadPool
+    std::shared_ptr<WorkerCounters> counters = worker.statistics;
+    if (!counters) {
+        counters = std::make_shared<WorkerCounters>();
+    }
+
     // We create local copies of the important variables so that we are guaranteed that
     // they continue to exist when we pass them to the 'workerLoop' lamdba. Otherwise,
     // the ThreadPool might be destructed before the workers have finished (for example
@@ -204,38 +820,168 @@ void ThreadPool::activateWorker(Worker& worker) {
     std::shared_ptr<std::atomic_bool> threadPoolIsRunning = _isRunning;
     std::shared_ptr<std::atomic_int> nWaiting = _nWaiting;
     std::shared_ptr<TaskQueue> taskQueue = _taskQueue;
-    std::shared_ptr<std::mutex> mutex = _mutex;
-    std::shared_ptr<std::condition_variable> cv = _cv;
+    std::shared_ptr<LocalQueueRegistry> localQueues = _localQueues;
+    std::shared_ptr<EventCount> eventCount = _eventCount;
+    std::shared_ptr<StatisticsState> statistics = _statistics;
 
     std::function<void()> workerInitialization = _workerInitialization;
     std::function<void()> workerDeinitialization = _workerDeinitialization;
 
-
-    volatile bool finishedInitializing = false;
+    std::atomic_bool finishedInitializing = false;
 
     // capturing the shared_ptrs by value to maintain a copy
     auto workerLoop = [
-        shouldTerminate, threadPoolIsRunning, &finishedInitializing, nWaiting, taskQueue,
-        mutex, cv, workerInitialization, workerDeinitialization
-    ]() {
+        shouldTerminate, threadPoolIsRunning, initialized = &finishedInitializing,
+        nWaiting, taskQueue, localQueue, localQueues, eventCount, statistics, counters,
+        workerInitialization, workerDeinitialization
+    ]() mutable {
+        // The flag lives on the stack of 'activateWorker', which returns as soon as the
+        // flag is set, so we must not touch it afterwards
+        auto markInitialized = [&initialized]() {
+            if (initialized) {
+                *initialized = true;
+                initialized = nullptr;
+            }
+        };
+
         // Invoke the user-defined initialization function
         workerInitialization();
         // And invoke the user-defined deinitialization function when the scope is exited
         defer { workerDeinitialization(); };
 
-        std::function<void()> task;
-        bool hasTask;
-        std::tie(task, hasTask) = taskQueue->pop();
+        _currentWorker = { taskQueue.get(), localQueue.get(), counters.get() };
+        defer {
+            _currentWorker = WorkerContext();
+            if (!localQueue) {
+                return;
+            }
+
+            // If we were asked to terminate, there might still be tasks left in our own
+            // queue that nobody has stolen yet, so we hand them over to the shared queue
+            bool hasRemainingTasks = false;
+            while (QueuedTask* t = localQueue->pop()) {
+                taskQueue->push(std::move(t->task), TaskOptions(), 0, t->enqueueTime);
+                releaseTask(t);
+                hasRemainingTasks = true;
+            }
+
+            {
+                std::lock_guard lock(localQueues->mutex);
+                std::vector<std::shared_ptr<LocalQueue>>& qs = localQueues->queues;
+                qs.erase(std::remove(qs.begin(), qs.end(), localQueue), qs.end());
+                localQueues->version++;
+            }
+
+            if (hasRemainingTasks) {
+                eventCount->notifyAll();
+            }
+        };
+
+        // The local copy of the queues from which we can steal tasks. It is only updated
+        // when the list of registered queues changes
+        std::vector<std::shared_ptr<LocalQueue>> victims;
+        int victimsVersion = -1;
+        // The state of a xorshift random number generator that determines the first
+        // Worker we try to steal from
+        uint32_t seed = static_cast<uint32_t>(
+            std::hash<std::thread::id>()(std::this_thread::get_id())
+        ) | 1;
+
+        // The point in time at which the current task was queued
+        TimePoint enqueueTime;
+
+        // Retrieves the next task for this Worker. Tasks in our own queue have priority,
+        // followed by tasks in the shared queue, and as a last resort we steal a task
+        // from one of the other Workers
+        auto nextTask = [&](Task& task) -> bool {
+            if (localQueue) {
+                if (QueuedTask* t = localQueue->pop()) {
+                    task = std::move(t->task);
+                    enqueueTime = t->enqueueTime;
+                    releaseTask(t);
+                    return true;
+                }
+            }
+
+            bool hasTask;
+            std::tie(task, hasTask) = taskQueue->pop(&enqueueTime);
+            if (hasTask || !localQueue) {
+                return hasTask;
+            }
+
+            if (localQueues->version != victimsVersion) {
+                std::lock_guard lock(localQueues->mutex);
+                victims = localQueues->queues;
+                victimsVersion = localQueues->version;
+            }
+
+            if (victims.size() < 2) {
+                // We are the only Worker, so there is nobody to steal from
+                return false;
+            }
+
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            const size_t start = seed % victims.size();
+            for (size_t i = 0; i < victims.size(); ++i) {
+                LocalQueue* victim = victims[(start + i) % victims.size()].get();
+                if (victim == localQueue.get()) {
+                    continue;
+                }
+
+                // A failed steal only means that someone else was faster, so we keep
+                // trying as long as there is something left in the victim's queue
+                while (!victim->isEmpty()) {
+                    if (QueuedTask* t = victim->steal()) {
+                        task = std::move(t->task);
+                        enqueueTime = t->enqueueTime;
+                        releaseTask(t);
+                        if (statistics->isEnabled.load(std::memory_order_relaxed)) {
+                            counters->nSteals.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+
+        Task task;
+        bool hasTask = nextTask(task);
 
         // Infinite look that only gets broken if this thread should terminate or if it
         // gets woken up without there being a task
         while (true) {  // loop #1
             // If there is something in the queue
             while (hasTask) { // loop #2
-                finishedInitializing = true;
+                markInitialized();
+
+                // Do the task and measure it if we are asked to
+                if (statistics->isEnabled.load(std::memory_order_relaxed)) {
+                    const TimePoint start = std::chrono::steady_clock::now();
+                    {
+                        ZoneScopedN("ThreadPool Task")
+                        task();
+                    }
+                    const TimePoint end = std::chrono::steady_clock::now();
 
-                // Do the task
-                task();
+                    // Tasks that were queued while the statistics were disabled don't
+                    // have a meaningful queue time
+                    if (enqueueTime != TimePoint()) {
+                        counters->queueWait.add(start - enqueueTime);
+                    }
+                    counters->execution.add(end - start);
+                    counters->busyTime.fetch_add(
+                        toNanoseconds(end - start),
+                        std::memory_order_relaxed
+                    );
+                    counters->nTasks.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    ZoneScopedN("ThreadPool Task")
+                    task();
+                }
 
                 // We cannot check for shouldTerminate earlier as if hasTask is true,
                 // we have already retrieved that value from the stack and if we don't
@@ -247,34 +993,43 @@ void ThreadPool::activateWorker(Worker& worker) {
                 // If we shouldn't terminate, we can check if there is more work
                 // if there is, we stay in this inner loop until there is no more work to
                 // be done
-                std::tie(task, hasTask) = taskQueue->pop();
+                hasTask = nextTask(task);
             }
 
             // If the ThreadPool has stopped running and there are no more tasks, we don't
             // need to sleep first, but can return immediately
             if (!*threadPoolIsRunning) {
-                finishedInitializing = true;
+                markInitialized();
                 return;
             }
 
             // If we get here, there is no more work to be done and the ThreadPool is
             // still running, so we can sleep until there is more work
             (*nWaiting)++;
+            const TimePoint idleStart =
+                statistics->isEnabled.load(std::memory_order_relaxed) ?
+                std::chrono::steady_clock::now() :
+                TimePoint();
+            defer {
+                if (idleStart != TimePoint()) {
+                    counters->idleTime.fetch_add(
+                        toNanoseconds(std::chrono::steady_clock::now() - idleStart),
+                        std::memory_order_relaxed
+                    );
+                }
+            };
             while (true) { // loop #3
-                finishedInitializing = true;
-
-                // We are doing this in an infinite loop, as we want to check regularly
-                // if there is more work. This shouldn't be necessary in normal cases, but
-                // is more of a last resort protection
-                std::unique_lock lock(*mutex);
-                cv->wait_for(
-                    lock,
-                    WaitTime
-                );
+                markInitialized();
+
+                // We announce that we want to sleep before we check for work one last
+                // time. Any task that is queued after this point changes the key and
+                // prevents us from sleeping, so no wake-up can get lost
+                const EventCount::Key key = eventCount->prepareWait();
 
-                // We woke up, so either there is work to be done
-                std::tie(task, hasTask) = taskQueue->pop();
+                // Either there is work to be done
+                hasTask = nextTask(task);
                 if (hasTask) {
+                    eventCount->cancelWait();
                     (*nWaiting)--;
                     // We have a task now, so if we break we start over with loop #1 and
                     // do the work as we enter loop #2
@@ -283,12 +1038,21 @@ void ThreadPool::activateWorker(Worker& worker) {
 
                 // Or we were asked to terminate or the ThreadPool is finished
                 if (*shouldTerminate || !*threadPoolIsRunning) {
+                    eventCount->cancelWait();
                     (*nWaiting)--;
                     return;
                 }
 
-                // If we reach this place, we just woke up spuriously or due to the timer
-                // so we stay in loop #3 and go to sleep again
+                // Or there is nothing to do and we sleep until we are notified. If we
+                // wake up, we stay in loop #3 and check again
+                bool hasSlept = false;
+                {
+                    ZoneScopedN("ThreadPool Idle")
+                    hasSlept = eventCount->commitWait(key);
+                }
+                if (hasSlept && statistics->isEnabled.load(std::memory_order_relaxed)) {
+                    counters->nWakeups.fetch_add(1, std::memory_order_relaxed);
+                }
             }
         }
     };
@@ -305,41 +1069,321 @@ void ThreadPool::activateWorker(Worker& worker) {
         thread::setThreadBackground(*thread, thread::Background::Yes);
     }
 
+    // Pin the thread to its CPUs if a placement was requested
+    applyPlacement(*thread, static_cast<size_t>(&worker - _workers.data()));
+
     // Overwrite the worker and we are done
-    worker = { std::move(thread), std::move(shouldTerminate) };
+    worker = {
+        std::move(thread),
+        std::move(shouldTerminate),
+        std::move(localQueue),
+        std::move(counters)
+    };
 
     while (!finishedInitializing) {}
 }
 
-std::tuple<ThreadPool::Task, bool> ThreadPool::TaskQueue::pop() {
+ThreadPool::EventCount::Key ThreadPool::EventCount::prepareWait() {
+    _nWaiters++;
+    // Pairs with the fence in 'notify' so that either we see the queued task or the
+    // notifier sees us as a waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return _epoch.load(std::memory_order_acquire);
+}
+
+void ThreadPool::EventCount::cancelWait() {
+    _nWaiters--;
+}
+
+bool ThreadPool::EventCount::commitWait(Key key) {
+    std::unique_lock lock(_mutex);
+    const bool shouldSleep = _epoch.load(std::memory_order_relaxed) == key;
+    if (shouldSleep) {
+        _cv.wait(lock, [this, key]() {
+            return _epoch.load(std::memory_order_relaxed) != key;
+        });
+
+        // We were actually sleeping, so this was a real wake-up
+        const std::chrono::nanoseconds latency = std::chrono::steady_clock::now() -
+                                                 _notifyTime;
+        _statistics.nWakeups++;
+        _statistics.totalLatency += latency;
+        _statistics.maxLatency = std::max(_statistics.maxLatency, latency);
+    }
+    _nWaiters--;
+    return shouldSleep;
+}
+
+void ThreadPool::EventCount::notify() {
+    notify(1);
+}
+
+void ThreadPool::EventCount::notifyMany(int count) {
+    notify(count);
+}
+
+void ThreadPool::EventCount::notifyAll() {
+    notify(std::numeric_limits<int>::max());
+}
+
+void ThreadPool::EventCount::notify(int count) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int nWaiters = _nWaiters.load(std::memory_order_relaxed);
+    if (nWaiters == 0 || count <= 0) {
+        // Nobody is waiting, so we don't need to touch the mutex at all
+        return;
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+        _epoch.fetch_add(1, std::memory_order_release);
+        _notifyTime = std::chrono::steady_clock::now();
+    }
+
+    if (count >= nWaiters) {
+        _cv.notify_all();
+    }
+    else {
+        for (int i = 0; i < count; ++i) {
+            _cv.notify_one();
+        }
+    }
+}
+
+ThreadPool::WakeStatistics ThreadPool::EventCount::statistics() const {
+    std::lock_guard lock(_mutex);
+    return _statistics;
+}
+
+void ThreadPool::EventCount::resetStatistics() {
+    std::lock_guard lock(_mutex);
+    _statistics = WakeStatistics();
+}
+
+namespace {
+    // Orders the tasks with deadlines such that the earliest deadline is on top
+    template <typename Entry>
+    bool hasLaterDeadline(const Entry& lhs, const Entry& rhs) {
+        return lhs.deadline > rhs.deadline;
+    }
+} // namespace
+
+std::tuple<Task, bool> ThreadPool::TaskQueue::pop(TimePoint* enqueueTime) {
     std::lock_guard lock(_queueMutex);
-    if (_queue.empty()) {
+
+    // Tasks with a deadline always come first
+    if (!_deadlines.empty()) {
+        std::pop_heap(_deadlines.begin(), _deadlines.end(), hasLaterDeadline<Entry>);
+        Task t = std::move(_deadlines.back().task);
+        if (enqueueTime) {
+            *enqueueTime = _deadlines.back().enqueueTime;
+        }
+        _deadlines.pop_back();
+
+        for (size_t p = 0; p < _queues.size(); ++p) {
+            if (_queues[p].size() > 0) {
+                _nSkipped[p]++;
+            }
+        }
+        return std::make_tuple(std::move(t), true);
+    }
+
+    // If a lower priority has been passed over too often, it is its turn now, otherwise
+    // we take the highest priority that has a task
+    int selected = -1;
+    for (int p = static_cast<int>(_queues.size()) - 1; p > 0; --p) {
+        if (_queues[p].size() > 0 && _nSkipped[p] >= StarvationLimit) {
+            selected = p;
+            break;
+        }
+    }
+    if (selected == -1) {
+        for (int p = 0; p < static_cast<int>(_queues.size()); ++p) {
+            if (_queues[p].size() > 0) {
+                selected = p;
+                break;
+            }
+        }
+    }
+
+    if (selected == -1) {
         // No work to be done, the default constructed Task is never read
         return std::make_tuple(Task(), false);
     }
+
+    _nSkipped[selected] = 0;
+    for (int p = selected + 1; p < static_cast<int>(_queues.size()); ++p) {
+        if (_queues[p].size() > 0) {
+            _nSkipped[p]++;
+        }
+    }
+
+    // We have a task, so we move it out of the queue and return it together with a
+    // positive reply
+    Entry e = _queues[selected].pop();
+    if (enqueueTime) {
+        *enqueueTime = e.enqueueTime;
+    }
+    return std::make_tuple(std::move(e.task), true);
+}
+
+void ThreadPool::TaskQueue::push(Task&& task, const TaskOptions& options, TaskId id,
+                                 TimePoint enqueueTime)
+{
+    std::lock_guard lock(_queueMutex);
+    if (options.deadline.has_value()) {
+        _deadlines.push_back({ std::move(task), id, *options.deadline, enqueueTime });
+        std::push_heap(_deadlines.begin(), _deadlines.end(), hasLaterDeadline<Entry>);
+    }
     else {
-        // We have a task, so we move it out of the queue
-        Task t = std::move(_queue.front());
-        // and remove the item
-        _queue.pop();
-        // and return the task together with a positive reply
-        return std::make_tuple(std::move(t), true);
+        _queues[static_cast<int>(options.priority)].push(
+            { std::move(task), id, {}, enqueueTime }
+        );
+    }
+    updatePeakSize();
+}
+
+void ThreadPool::TaskQueue::pushMany(std::vector<Task>&& tasks,
+                                     const TaskOptions& options, TaskId firstId,
+                                     TimePoint enqueueTime)
+{
+    std::lock_guard lock(_queueMutex);
+    TaskId id = firstId;
+    for (Task& task : tasks) {
+        if (options.deadline.has_value()) {
+            _deadlines.push_back({ std::move(task), id, *options.deadline, enqueueTime });
+            std::push_heap(_deadlines.begin(), _deadlines.end(), hasLaterDeadline<Entry>);
+        }
+        else {
+            _queues[static_cast<int>(options.priority)].push(
+                { std::move(task), id, {}, enqueueTime }
+            );
+        }
+        id++;
+    }
+    updatePeakSize();
+}
+
+bool ThreadPool::TaskQueue::extract(TaskId id, Task& task) {
+    if (id == 0) {
+        return false;
+    }
+
+    std::lock_guard lock(_queueMutex);
+    for (RingBuffer& queue : _queues) {
+        for (size_t i = 0; i < queue.size(); ++i) {
+            if (queue[i].id == id) {
+                task = std::move(queue.erase(i).task);
+                return true;
+            }
+        }
+    }
+
+    for (auto it = _deadlines.begin(); it != _deadlines.end(); ++it) {
+        if (it->id == id) {
+            task = std::move(it->task);
+            _deadlines.erase(it);
+            std::make_heap(_deadlines.begin(), _deadlines.end(), hasLaterDeadline<Entry>);
+            return true;
+        }
     }
+    return false;
 }
 
-void ThreadPool::TaskQueue::push(ThreadPool::Task&& task) {
+bool ThreadPool::TaskQueue::reprioritize(TaskId id, Priority priority) {
+    if (id == 0) {
+        return false;
+    }
+
     std::lock_guard lock(_queueMutex);
-    _queue.push(task);
+    for (RingBuffer& queue : _queues) {
+        for (size_t i = 0; i < queue.size(); ++i) {
+            if (queue[i].id == id) {
+                _queues[static_cast<int>(priority)].push(queue.erase(i));
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
 bool ThreadPool::TaskQueue::isEmpty() const {
     std::lock_guard lock(_queueMutex);
-    return _queue.empty();
+    return _deadlines.empty() && _queues[0].size() == 0 && _queues[1].size() == 0 &&
+           _queues[2].size() == 0;
 }
 
 int ThreadPool::TaskQueue::size() const {
     std::lock_guard lock(_queueMutex);
-    return static_cast<int>(_queue.size());
+    size_t size = _deadlines.size();
+    for (const RingBuffer& queue : _queues) {
+        size += queue.size();
+    }
+    return static_cast<int>(size);
+}
+
+int ThreadPool::TaskQueue::peakSize() const {
+    std::lock_guard lock(_queueMutex);
+    return static_cast<int>(_peakSize);
+}
+
+void ThreadPool::TaskQueue::resetPeakSize() {
+    std::lock_guard lock(_queueMutex);
+    _peakSize = 0;
+    updatePeakSize();
+}
+
+void ThreadPool::TaskQueue::updatePeakSize() {
+    size_t size = _deadlines.size();
+    for (const RingBuffer& queue : _queues) {
+        size += queue.size();
+    }
+    _peakSize = std::max(_peakSize, size);
+}
+
+void ThreadPool::TaskQueue::RingBuffer::push(Entry&& entry) {
+    if (_size == _buffer.size()) {
+        // The buffer is full, so we double its size and move the existing entries to
+        // the beginning of the new buffer
+        std::vector<Entry> buffer(std::max<size_t>(2 * _buffer.size(), 64));
+        for (size_t i = 0; i < _size; ++i) {
+            buffer[i] = std::move((*this)[i]);
+        }
+        _buffer = std::move(buffer);
+        _head = 0;
+    }
+
+    _buffer[(_head + _size) & (_buffer.size() - 1)] = std::move(entry);
+    _size++;
+}
+
+ThreadPool::TaskQueue::Entry ThreadPool::TaskQueue::RingBuffer::pop() {
+    ghoul_assert(_size > 0, "RingBuffer must not be empty");
+
+    Entry e = std::move(_buffer[_head]);
+    _head = (_head + 1) & (_buffer.size() - 1);
+    _size--;
+    return e;
+}
+
+ThreadPool::TaskQueue::Entry ThreadPool::TaskQueue::RingBuffer::erase(size_t i) {
+    ghoul_assert(i < _size, "Index out of range");
+
+    // Close the gap by moving all later entries forward by one
+    Entry e = std::move((*this)[i]);
+    for (size_t j = i; j + 1 < _size; ++j) {
+        (*this)[j] = std::move((*this)[j + 1]);
+    }
+    _size--;
+    return e;
+}
+
+ThreadPool::TaskQueue::Entry& ThreadPool::TaskQueue::RingBuffer::operator[](size_t i) {
+    return _buffer[(_head + i) & (_buffer.size() - 1)];
+}
+
+size_t ThreadPool::TaskQueue::RingBuffer::size() const {
+    return _size;
 }
 
 } // namespace openspace
@@ -248,3 +248,21 @@ TEST_CASE("Buffer: Vector", "[buffer]") {
     CHECK(fv == fv2);
     CHECK(sv == sv2);
 }
+
+TEST_CASE("Buffer: Raw Data", "[buffer]") {
+    const std::vector<ghoul::Buffer::value_type> data = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    const int i1 = 42;
+
+    ghoul::Buffer b;
+    b.serialize(data.data(), data.size());
+    b.serialize(i1);
+    CHECK(b.size() == data.size() + sizeof(int));
+
+    std::vector<ghoul::Buffer::value_type> data2(data.size());
+    b.deserialize(data2.data(), data2.size());
+    int i2;
+    b.deserialize(i2);
+
+    CHECK(data == data2);
+    CHECK(i1 == i2);
+}
@@ -27,7 +27,819 @@
 
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/lua/lua_helper.h>
+#include <ghoul/misc/crc32.h>
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/glm.h>
+#include <algorithm>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+TEST_CASE("Dictionary: Nested Value", "[dictionary]") {
+    ghoul::Dictionary c;
+    c.setValue("value", 1.0);
+    c.setValue("vec", glm::dvec3(1.0, 2.0, 3.0));
+    ghoul::Dictionary b;
+    b.setValue("c", c);
+    ghoul::Dictionary a;
+    a.setValue("b", b);
+    a.setValue("int", 2);
+
+    CHECK(a.value<double>("b.c.value") == 1.0);
+    CHECK(a.value<glm::dvec3>("b.c.vec") == glm::dvec3(1.0, 2.0, 3.0));
+    CHECK(a.hasValue<double>("b.c.value"));
+    CHECK(a.hasValue<glm::dvec3>("b.c.vec"));
+    CHECK_FALSE(a.hasValue<int>("b.c.value"));
+    CHECK(a.hasKey("b.c.value"));
+    CHECK_FALSE(a.hasKey("b.c.missing"));
+    CHECK_FALSE(a.hasKey("b.missing.value"));
+
+    // Intermediate segments that are not Dictionaries are treated as missing keys
+    CHECK_FALSE(a.hasKey("int.value"));
+    CHECK_FALSE(a.hasValue<double>("int.value"));
+
+    CHECK_THROWS_AS(a.value<double>("b.missing.value"), ghoul::Dictionary::KeyError);
+    CHECK_THROWS_AS(a.value<double>("int.value"), ghoul::Dictionary::ValueError);
+    CHECK_THROWS_AS(a.value<int>("b.c.value"), ghoul::Dictionary::ValueError);
+}
+
+TEST_CASE("Dictionary: SubDictionary", "[dictionary]") {
+    ghoul::Dictionary c;
+    c.setValue("value", 1.0);
+    ghoul::Dictionary b;
+    b.setValue("c", c);
+    ghoul::Dictionary a;
+    a.setValue("b", b);
+    a.setValue("int", 2);
+
+    const ghoul::Dictionary* pb = a.subDictionary("b");
+    REQUIRE(pb);
+    CHECK(*pb == b);
+
+    // The nested Dictionary is returned in place rather than as a copy
+    const ghoul::Dictionary* pc = a.subDictionary("b.c");
+    REQUIRE(pc);
+    CHECK(pc == pb->subDictionary("c"));
+    CHECK(pc->value<double>("value") == 1.0);
+
+    CHECK(a.subDictionary("int") == nullptr);
+    CHECK(a.subDictionary("missing") == nullptr);
+    CHECK(a.subDictionary("b.c.value") == nullptr);
+    CHECK(a.subDictionary("int.value") == nullptr);
+}
+
+TEST_CASE("Dictionary: Keys Sorted", "[dictionary]") {
+    ghoul::Dictionary d;
+    d.setValue("c", 1);
+    d.setValue("a", 2);
+    d.setValue("b", 3);
+    std::vector<std::string_view> keys = d.keys();
+    CHECK(keys == std::vector<std::string_view>{ "a", "b", "c" });
+
+    d.removeValue("a");
+    keys = d.keys();
+    CHECK(keys == std::vector<std::string_view>{ "b", "c" });
+}
+
+TEST_CASE("Dictionary: Equality Independent of Order", "[dictionary]") {
+    ghoul::Dictionary a;
+    a.setValue("a", 1);
+    a.setValue("b", 2.0);
+    ghoul::Dictionary b;
+    b.setValue("b", 2.0);
+    b.setValue("a", 1);
+    CHECK(a == b);
+    CHECK(a.isSubset(b));
+
+    b.setValue("a", 2);
+    CHECK(a != b);
+    CHECK_FALSE(a.isSubset(b));
+}
+
+TEST_CASE("Dictionary: Large", "[dictionary]") {
+    // Large enough to cross the threshold at which the Dictionary switches to a hash
+    // table and to require growing that table multiple times
+    constexpr const int N = 1000;
+
+    ghoul::Dictionary d;
+    std::map<std::string, int> reference;
+    for (int i = 0; i < N; ++i) {
+        const std::string key = "key" + std::to_string(i * 7919 % N);
+        d.setValue(key, i);
+        reference[key] = i;
+    }
+    REQUIRE(d.size() == N);
+    for (const std::pair<const std::string, int>& kv : reference) {
+        REQUIRE(d.value<int>(kv.first) == kv.second);
+    }
+
+    // Overwriting does not change the size
+    d.setValue("key0", -1);
+    reference["key0"] = -1;
+    CHECK(d.size() == N);
+    CHECK(d.value<int>("key0") == -1);
+
+    // Remove entries in a scattered order, shrinking back below the threshold
+    for (int i = 0; i < N - 5; ++i) {
+        const std::string key = "key" + std::to_string(i * 379 % N);
+        d.removeValue(key);
+        reference.erase(key);
+        if (i % 97 == 0) {
+            for (const std::pair<const std::string, int>& kv : reference) {
+                REQUIRE(d.value<int>(kv.first) == kv.second);
+            }
+        }
+    }
+    REQUIRE(d.size() == reference.size());
+    for (const std::pair<const std::string, int>& kv : reference) {
+        CHECK(d.value<int>(kv.first) == kv.second);
+    }
+
+    std::vector<std::string_view> keys = d.keys();
+    std::vector<std::string_view> referenceKeys;
+    for (const std::pair<const std::string, int>& kv : reference) {
+        referenceKeys.push_back(kv.first);
+    }
+    CHECK(keys == referenceKeys);
+
+    d.removeValue("doesnotexist");
+    CHECK(d.size() == reference.size());
+}
+
+TEST_CASE("Dictionary: Copy On Write", "[dictionary]") {
+    ghoul::Dictionary nested;
+    nested.setValue("value", 1);
+    ghoul::Dictionary a;
+    a.setValue("nested", nested);
+    a.setValue("int", 2);
+
+    ghoul::Dictionary b = a;
+    CHECK(a == b);
+    // Copies share their values until one of them is modified
+    CHECK(a.subDictionary("nested") == b.subDictionary("nested"));
+
+    b.setValue("int", 3);
+    b.setValue("new", 4.0);
+    CHECK(a.value<int>("int") == 2);
+    CHECK_FALSE(a.hasKey("new"));
+    CHECK(b.value<int>("int") == 3);
+    CHECK(b.value<double>("new") == 4.0);
+    CHECK(a.subDictionary("nested") != b.subDictionary("nested"));
+    CHECK(*a.subDictionary("nested") == *b.subDictionary("nested"));
+
+    ghoul::Dictionary c = a;
+    c.removeValue("nested");
+    CHECK(a.hasKey("nested"));
+    CHECK_FALSE(c.hasKey("nested"));
+
+    // Removing a key that does not exist leaves the values shared
+    ghoul::Dictionary d = a;
+    d.removeValue("doesnotexist");
+    CHECK(a.subDictionary("nested") == d.subDictionary("nested"));
+
+    // Modifying a Dictionary retrieved from another one does not change the original
+    ghoul::Dictionary e = a.value<ghoul::Dictionary>("nested");
+    e.setValue("value", 5);
+    CHECK(a.value<int>("nested.value") == 1);
+    CHECK(e.value<int>("value") == 5);
+
+    ghoul::Dictionary empty;
+    ghoul::Dictionary emptied;
+    emptied.setValue("a", 1);
+    emptied.removeValue("a");
+    CHECK(empty == emptied);
+    CHECK(emptied.isEmpty());
+}
+
+TEST_CASE("Dictionary: Copy On Write Threads", "[dictionary]") {
+    ghoul::Dictionary original;
+    for (int i = 0; i < 100; ++i) {
+        original.setValue("key" + std::to_string(i), i);
+    }
+
+    // Each thread modifies its own copy while all of them share the original values
+    std::vector<std::thread> threads;
+    std::vector<int> results(8, 0);
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&original, &results, t]() {
+            for (int i = 0; i < 100; ++i) {
+                ghoul::Dictionary copy = original;
+                copy.setValue("key" + std::to_string(i), t);
+                results[t] += copy.value<int>("key" + std::to_string(i)) == t;
+                results[t] += original.value<int>("key" + std::to_string(i)) == i;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (int r : results) {
+        CHECK(r == 200);
+    }
+}
+
+TEST_CASE("Dictionary: Benchmark Copy", "[.][benchmark][dictionary]") {
+    ghoul::Dictionary d;
+    for (int i = 0; i < 1000; ++i) {
+        ghoul::Dictionary nested;
+        nested.setValue("Name", "Entry" + std::to_string(i));
+        nested.setValue("Values", std::vector<double>(16, static_cast<double>(i)));
+        d.setValue("Entry" + std::to_string(i), nested);
+    }
+
+    BENCHMARK("copy (1000 nested Dictionaries)") {
+        return ghoul::Dictionary(d);
+    };
+
+    BENCHMARK("copy and modify (1000 nested Dictionaries)") {
+        ghoul::Dictionary copy = d;
+        copy.setValue("Modified", true);
+        return copy;
+    };
+}
+
+TEST_CASE("Dictionary: glm Interchangeability", "[dictionary]") {
+    ghoul::Dictionary d;
+    d.setValue("dvec3", glm::dvec3(1.0, 2.0, 3.0));
+    d.setValue("ivec2", glm::ivec2(4, 5));
+    d.setValue("vector", std::vector<double>{ 1.0, 2.0, 3.0, 4.0 });
+    d.setValue("dmat2", glm::dmat2x2(1.0, 2.0, 3.0, 4.0));
+
+    CHECK(d.hasValue<glm::dvec3>("dvec3"));
+    CHECK(d.hasValue<std::vector<double>>("dvec3"));
+    CHECK_FALSE(d.hasValue<std::vector<int>>("dvec3"));
+    CHECK_FALSE(d.hasValue<glm::dvec2>("dvec3"));
+    CHECK_FALSE(d.hasValue<glm::ivec3>("dvec3"));
+    CHECK(d.value<std::vector<double>>("dvec3") == std::vector<double>{ 1.0, 2.0, 3.0 });
+    CHECK(d.value<std::vector<int>>("ivec2") == std::vector<int>{ 4, 5 });
+
+    CHECK(d.hasValue<glm::dvec4>("vector"));
+    CHECK(d.hasValue<glm::dmat2x2>("vector"));
+    CHECK_FALSE(d.hasValue<glm::dvec3>("vector"));
+    CHECK(d.value<glm::dvec4>("vector") == glm::dvec4(1.0, 2.0, 3.0, 4.0));
+    CHECK(d.value<glm::dmat2x2>("vector") == glm::dmat2x2(1.0, 2.0, 3.0, 4.0));
+    CHECK(d.value<glm::dvec4>("dmat2") == glm::dvec4(1.0, 2.0, 3.0, 4.0));
+    CHECK_THROWS_AS(d.value<glm::dvec3>("vector"), ghoul::Dictionary::ValueError);
+    CHECK_THROWS_AS(d.value<glm::ivec4>("vector"), ghoul::Dictionary::ValueError);
+    CHECK_THROWS_AS(d.value<std::vector<int>>("dvec3"), ghoul::Dictionary::ValueError);
+
+    // Lua tables are converted into Dictionaries with 1-based keys
+    ghoul::Dictionary table;
+    table.setValue("1", 1.0);
+    table.setValue("2", 2.0);
+    table.setValue("3", 3.0);
+    d.setValue("table", table);
+    CHECK(d.hasValue<glm::dvec3>("table"));
+    CHECK_FALSE(d.hasValue<glm::dvec4>("table"));
+    CHECK(d.value<glm::dvec3>("table") == glm::dvec3(1.0, 2.0, 3.0));
+    CHECK_THROWS_AS(d.value<glm::dvec4>("table"), ghoul::Dictionary::ValueError);
+
+    // Dictionaries compare equal regardless of whether a glm type or a std::vector was
+    // used to store the same values
+    ghoul::Dictionary a;
+    a.setValue("value", glm::dvec3(1.0, 2.0, 3.0));
+    ghoul::Dictionary b;
+    b.setValue("value", std::vector<double>{ 1.0, 2.0, 3.0 });
+    CHECK(a == b);
+    CHECK(a.isSubset(b));
+    b.setValue("value", std::vector<double>{ 1.0, 2.0, 4.0 });
+    CHECK(a != b);
+    b.setValue("value", std::vector<int>{ 1, 2, 3 });
+    CHECK(a != b);
+}
+
+TEST_CASE("Dictionary: Benchmark Storage", "[.][benchmark][dictionary]") {
+    // The std::map based storage that was previously used by the Dictionary
+    using Storage = std::map<
+        std::string,
+        std::variant<
+            bool, int, double, std::string, ghoul::Dictionary, std::vector<int>,
+            std::vector<double>, std::vector<std::string>
+        >,
+        std::less<>
+    >;
+
+    for (int n : { 8, 16, 1000 }) {
+        std::vector<std::string> keys;
+        for (int i = 0; i < n; ++i) {
+            keys.push_back("SomeKeyName" + std::to_string(i));
+        }
+
+        Storage map;
+        ghoul::Dictionary dictionary;
+        for (int i = 0; i < n; ++i) {
+            map.insert_or_assign(keys[i], static_cast<double>(i));
+            dictionary.setValue(keys[i], static_cast<double>(i));
+        }
+
+        BENCHMARK("std::map construction (" + std::to_string(n) + " keys)") {
+            Storage s;
+            for (int i = 0; i < n; ++i) {
+                s.insert_or_assign(keys[i], static_cast<double>(i));
+            }
+            return s;
+        };
+
+        BENCHMARK("Dictionary construction (" + std::to_string(n) + " keys)") {
+            ghoul::Dictionary d;
+            for (int i = 0; i < n; ++i) {
+                d.setValue(keys[i], static_cast<double>(i));
+            }
+            return d;
+        };
+
+        BENCHMARK("std::map lookup (" + std::to_string(n) + " keys)") {
+            double sum = 0.0;
+            for (int i = 0; i < n; ++i) {
+                sum += std::get<double>(map.find(keys[i])->second);
+            }
+            return sum;
+        };
+
+        BENCHMARK("Dictionary lookup (" + std::to_string(n) + " keys)") {
+            double sum = 0.0;
+            for (int i = 0; i < n; ++i) {
+                sum += dictionary.value<double>(keys[i]);
+            }
+            return sum;
+        };
+
+        BENCHMARK("std::map iteration (" + std::to_string(n) + " keys)") {
+            size_t length = 0;
+            for (const auto& kv : map) {
+                length += kv.first.size();
+            }
+            return length;
+        };
+
+        BENCHMARK("Dictionary iteration (" + std::to_string(n) + " keys)") {
+            size_t length = 0;
+            for (std::string_view key : dictionary.keys()) {
+                length += key.size();
+            }
+            return length;
+        };
+    }
+}
+
+TEST_CASE("Dictionary: Key", "[dictionary]") {
+    constexpr ghoul::Dictionary::Key IntKey("int");
+    constexpr ghoul::Dictionary::Key ValueKey("b.c.value");
+    constexpr ghoul::Dictionary::Key VecKey("b.c.vec");
+    constexpr ghoul::Dictionary::Key CKey("b.c");
+    constexpr ghoul::Dictionary::Key MissingKey("b.missing.value");
+    constexpr ghoul::Dictionary::Key NonDictionaryKey("int.value");
+    static_assert(ValueKey.string() == "b.c.value");
+
+    ghoul::Dictionary c;
+    c.setValue("value", 1.0);
+    c.setValue("vec", glm::dvec3(1.0, 2.0, 3.0));
+    ghoul::Dictionary b;
+    b.setValue("c", c);
+    ghoul::Dictionary a;
+    a.setValue("b", b);
+    a.setValue("int", 2);
+
+    CHECK(a.value<int>(IntKey) == 2);
+    CHECK(a.value<double>(ValueKey) == 1.0);
+    CHECK(a.value<glm::dvec3>(VecKey) == glm::dvec3(1.0, 2.0, 3.0));
+    CHECK(a.hasValue<double>(ValueKey));
+    CHECK(a.hasValue<glm::dvec3>(VecKey));
+    CHECK_FALSE(a.hasValue<int>(ValueKey));
+    CHECK(a.hasKey(ValueKey));
+    CHECK_FALSE(a.hasKey(MissingKey));
+    CHECK_FALSE(a.hasKey(NonDictionaryKey));
+    CHECK_FALSE(a.hasValue<double>(NonDictionaryKey));
+
+    const ghoul::Dictionary* pc = a.subDictionary(CKey);
+    REQUIRE(pc);
+    CHECK(pc == a.subDictionary("b.c"));
+    CHECK(a.subDictionary(ValueKey) == nullptr);
+    CHECK(a.subDictionary(MissingKey) == nullptr);
+
+    CHECK_THROWS_AS(a.value<double>(MissingKey), ghoul::Dictionary::KeyError);
+    CHECK_THROWS_AS(a.value<double>(NonDictionaryKey), ghoul::Dictionary::ValueError);
+    CHECK_THROWS_AS(a.value<int>(ValueKey), ghoul::Dictionary::ValueError);
+
+    CHECK_THROWS_AS(
+        ghoul::Dictionary::Key("a.b.c.d.e.f.g.h.i"),
+        ghoul::Dictionary::KeyError
+    );
+}
+
+TEST_CASE("Dictionary: Visit", "[dictionary]") {
+    // Both the small, sorted storage and the hashed storage have to be visited in the
+    // same order as the keys are returned
+    for (int nEntries : { 5, 50 }) {
+        ghoul::Dictionary d;
+        for (int i = nEntries - 1; i >= 0; i--) {
+            d.setValue(std::to_string(i), i);
+        }
+        d.setValue("string", std::string("abc"));
+
+        std::vector<std::string_view> keys;
+        int sum = 0;
+        d.visit(
+            [&](std::string_view key, const ghoul::Dictionary::StorageTypes& value) {
+                keys.push_back(key);
+                if (const int* v = std::get_if<int>(&value)) {
+                    sum += *v;
+                }
+                else {
+                    CHECK(key == "string");
+                }
+            }
+        );
+        CHECK(keys == d.keys());
+        CHECK(sum == nEntries * (nEntries - 1) / 2);
+    }
+}
+
+TEST_CASE("Dictionary: Benchmark Key", "[.][benchmark][dictionary]") {
+    constexpr ghoul::Dictionary::Key RadiusKey("Renderable.Geometry.Radius");
+
+    ghoul::Dictionary geometry;
+    geometry.setValue("Radius", 1.0);
+    geometry.setValue("Segments", 32);
+    ghoul::Dictionary renderable;
+    renderable.setValue("Geometry", geometry);
+    renderable.setValue("Type", std::string("RenderableSphere"));
+    ghoul::Dictionary d;
+    d.setValue("Renderable", renderable);
+    d.setValue("Identifier", std::string("Sphere"));
+
+    BENCHMARK("string key") {
+        return d.value<double>("Renderable.Geometry.Radius");
+    };
+
+    BENCHMARK("precomputed Key") {
+        return d.value<double>(RadiusKey);
+    };
+}
+
+TEST_CASE("Dictionary: Benchmark glm", "[.][benchmark][dictionary]") {
+    ghoul::Dictionary d;
+    d.setValue("Transform", glm::dmat4x4(1.0));
+    d.setValue("Vector", std::vector<double>(16, 1.0));
+
+    BENCHMARK("value<glm::dmat4x4> from glm::dmat4x4") {
+        return d.value<glm::dmat4x4>("Transform");
+    };
+
+    BENCHMARK("value<glm::dmat4x4> from std::vector<double>") {
+        return d.value<glm::dmat4x4>("Vector");
+    };
+}
+
+namespace {
+    // Memory resource that forwards to the new/delete resource and keeps track of the
+    // number of outstanding allocations
+    class CountingResource : public pmr::memory_resource {
+    public:
+        int nAllocations = 0;
+        int nOutstanding = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            nAllocations++;
+            nOutstanding++;
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            nOutstanding--;
+            pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // A minimal arena that hands out memory from large blocks and only releases it when
+    // it is destroyed. pmr::monotonic_buffer_resource is not available on all platforms
+    class ArenaResource : public pmr::memory_resource {
+    public:
+        int nBlocks() const {
+            return static_cast<int>(_blocks.size());
+        }
+
+    private:
+        static constexpr size_t BlockSize = 64 * 1024;
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            size_t offset = (_offset + alignment - 1) / alignment * alignment;
+            if (_blocks.empty() || offset + bytes > BlockSize) {
+                const size_t size = std::max(bytes, BlockSize);
+                _blocks.push_back(std::make_unique<std::byte[]>(size));
+                offset = 0;
+            }
+            _offset = offset + bytes;
+            return _blocks.back().get() + offset;
+        }
+
+        void do_deallocate(void*, size_t, size_t) override {}
+
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::vector<std::unique_ptr<std::byte[]>> _blocks;
+        size_t _offset = 0;
+    };
+} // namespace
+
+TEST_CASE("Dictionary: Memory Resource", "[dictionary]") {
+    CountingResource resource;
+    {
+        // Any allocation from the default resource while the Dictionaries are in use
+        // would throw
+        pmr::memory_resource* defaultResource =
+            pmr::set_default_resource(pmr::null_memory_resource());
+
+        ghoul::Dictionary d(&resource);
+        CHECK(d.memoryResource() == &resource);
+        for (int i = 0; i < 100; ++i) {
+            d.setValue("String" + std::to_string(i), std::string(64, 'a'));
+        }
+        d.setValue("Vector", std::vector<double>{ 1.0, 2.0, 3.0 });
+        d.setValue("Strings", std::vector<std::string>{ std::string(64, 'b'), "c" });
+        d.setValue("Transform", glm::dmat4x4(1.0));
+
+        ghoul::Dictionary copy = d;
+        copy.setValue("Modified", true);
+        CHECK(copy.memoryResource() == &resource);
+        copy.removeValue("String0");
+
+        pmr::set_default_resource(defaultResource);
+
+        // Nested Dictionaries from a different resource are moved into the parent's
+        ghoul::Dictionary nested;
+        nested.setValue("Value", std::string(64, 'c'));
+        nested.setValue("Inner", nested);
+        CHECK(nested.memoryResource() == pmr::get_default_resource());
+        const int nAllocations = resource.nAllocations;
+        d.setValue("Nested", nested);
+        CHECK(resource.nAllocations > nAllocations);
+        REQUIRE(d.subDictionary("Nested.Inner"));
+        CHECK(d.subDictionary("Nested")->memoryResource() == &resource);
+        CHECK(d.subDictionary("Nested.Inner")->memoryResource() == &resource);
+        CHECK(d.value<std::string>("Nested.Inner.Value") == std::string(64, 'c'));
+
+        CHECK(d.value<std::string>("String99") == std::string(64, 'a'));
+        CHECK(d.value<std::vector<double>>("Vector") == std::vector<double>{ 1, 2, 3 });
+        CHECK(d.value<std::vector<std::string>>("Strings")[1] == "c");
+        CHECK(d.value<glm::dmat4x4>("Transform") == glm::dmat4x4(1.0));
+        CHECK(copy.value<bool>("Modified"));
+        CHECK_FALSE(copy.hasKey("String0"));
+        CHECK_FALSE(d.hasKey("Modified"));
+        CHECK(resource.nOutstanding > 0);
+    }
+    CHECK(resource.nOutstanding == 0);
+}
+
+TEST_CASE("Dictionary: Memory Resource Arena", "[dictionary]") {
+    ArenaResource arena;
+    ghoul::Dictionary d(&arena);
+    for (int i = 0; i < 1000; ++i) {
+        ghoul::Dictionary e(&arena);
+        e.setValue("Name", "Entry" + std::to_string(i));
+        e.setValue("Position", glm::dvec3(i, i, i));
+        d.setValue("Entry" + std::to_string(i), e);
+        CHECK(d.subDictionary("Entry" + std::to_string(i))->memoryResource() == &arena);
+    }
+    CHECK(d.size() == 1000);
+    CHECK(d.value<std::string>("Entry500.Name") == "Entry500");
+    CHECK(d.value<glm::dvec3>("Entry999.Position") == glm::dvec3(999.0));
+    CHECK(arena.nBlocks() > 1);
+}
+
+TEST_CASE("Dictionary: Benchmark Memory Resource", "[.][benchmark][dictionary]") {
+    auto build = [](ghoul::Dictionary d, pmr::memory_resource* resource) {
+        for (int i = 0; i < 100; ++i) {
+            ghoul::Dictionary e(resource);
+            e.setValue("Identifier", "Identifier" + std::to_string(i));
+            e.setValue("Position", glm::dvec3(1.0, 2.0, 3.0));
+            e.setValue("Tags", std::vector<std::string>{ "Tag1", "Tag2" });
+            d.setValue("Entry" + std::to_string(i), std::move(e));
+        }
+        return d;
+    };
+
+    BENCHMARK("construction (default resource)") {
+        return build(ghoul::Dictionary(), pmr::get_default_resource());
+    };
+
+    BENCHMARK("construction (arena resource)") {
+        ArenaResource arena;
+        return build(ghoul::Dictionary(&arena), &arena).size();
+    };
+}
+
+TEST_CASE("Dictionary: Hash", "[dictionary]") {
+    // Both the small, sorted storage and the hashed storage must not depend on the
+    // order in which the values were added
+    for (int nEntries : { 5, 50 }) {
+        ghoul::Dictionary a;
+        ghoul::Dictionary b;
+        for (int i = 0; i < nEntries; ++i) {
+            a.setValue("Key" + std::to_string(i), i);
+            b.setValue("Key" + std::to_string(nEntries - 1 - i), nEntries - 1 - i);
+        }
+        REQUIRE(a == b);
+        CHECK(a.hash() == b.hash());
+
+        b.setValue("Key0", -1);
+        CHECK(a.hash() != b.hash());
+        b.setValue("Key0", 0);
+        CHECK(a.hash() == b.hash());
+        b.removeValue("Key1");
+        CHECK(a.hash() != b.hash());
+    }
+
+    // Values that compare equal have the same hash
+    ghoul::Dictionary glm;
+    glm.setValue("Vec", glm::dvec3(1.0, 2.0, 3.0));
+    glm.setValue("Zero", 0.0);
+    ghoul::Dictionary vector;
+    vector.setValue("Vec", std::vector<double>{ 1.0, 2.0, 3.0 });
+    vector.setValue("Zero", -0.0);
+    REQUIRE(glm == vector);
+    CHECK(glm.hash() == vector.hash());
+
+    // Different types with the same numeric value are different
+    ghoul::Dictionary i;
+    i.setValue("Value", 1);
+    ghoul::Dictionary d;
+    d.setValue("Value", 1.0);
+    CHECK(i.hash() != d.hash());
+    CHECK(ghoul::Dictionary().hash() != i.hash());
+
+    // Modifying a copy of a nested Dictionary changes the hash of the parent after the
+    // copy is stored again, but not of the original
+    ghoul::Dictionary parent;
+    parent.setValue("Child", glm);
+    const uint64_t parentHash = parent.hash();
+    ghoul::Dictionary copy = parent;
+    ghoul::Dictionary child = copy.value<ghoul::Dictionary>("Child");
+    child.setValue("Zero", 1.0);
+    copy.setValue("Child", child);
+    CHECK(copy.hash() != parentHash);
+    CHECK(parent.hash() == parentHash);
+}
+
+TEST_CASE("Dictionary: Hash Key Collision", "[dictionary]") {
+    // Find two keys whose 32 bit hashes collide, which the birthday bound makes likely
+    // within a few hundred thousand keys
+    std::unordered_map<unsigned int, std::string> keys;
+    std::string first;
+    std::string second;
+    for (int i = 0; first.empty(); ++i) {
+        std::string key = "Key" + std::to_string(i);
+        auto [it, inserted] = keys.emplace(ghoul::hashCRC32(key), key);
+        if (!inserted) {
+            first = it->second;
+            second = std::move(key);
+        }
+    }
+
+    ghoul::Dictionary a;
+    a.setValue(first, 1);
+    a.setValue(second, 2);
+    ghoul::Dictionary b;
+    b.setValue(first, 2);
+    b.setValue(second, 1);
+
+    CHECK(a.hash() != b.hash());
+
+    // The swapped values are also found in nested Dictionaries
+    ghoul::Dictionary fromParent;
+    fromParent.setValue("Child", a);
+    ghoul::Dictionary toParent;
+    toParent.setValue("Child", b);
+    const ghoul::Dictionary::Patch patch = ghoul::Dictionary::diff(fromParent, toParent);
+    REQUIRE(patch.size() == 1);
+    CHECK(patch[0].changes.size() == 2);
+
+    fromParent.apply(patch);
+    CHECK(fromParent == toParent);
+}
+
+TEST_CASE("Dictionary: Diff", "[dictionary]") {
+    using Change = ghoul::Dictionary::Change;
+
+    ghoul::Dictionary unchanged;
+    for (int i = 0; i < 50; ++i) {
+        unchanged.setValue("Value" + std::to_string(i), i);
+    }
+    ghoul::Dictionary modified;
+    modified.setValue("Name", std::string("Old"));
+    modified.setValue("Removed", true);
+
+    ghoul::Dictionary a;
+    a.setValue("Unchanged", unchanged);
+    a.setValue("Modified", modified);
+    a.setValue("Double", 1.0);
+    a.setValue("TypeChange", 1);
+    a.setValue("Removed", std::string("value"));
+    a.setValue("Vec", glm::dvec3(1.0, 2.0, 3.0));
+
+    ghoul::Dictionary b = a;
+    modified.setValue("Name", std::string("New"));
+    modified.removeValue("Removed");
+    b.setValue("Modified", modified);
+    b.setValue("Double", 2.0);
+    b.setValue("TypeChange", ghoul::Dictionary());
+    b.removeValue("Removed");
+    b.setValue("Added", std::vector<std::string>{ "a", "b" });
+    // Storing an equal value of a different type is not a change
+    b.setValue("Vec", std::vector<double>{ 1.0, 2.0, 3.0 });
+    // A Dictionary that is equal but does not share its values is not a change either
+    ghoul::Dictionary unchangedCopy;
+    for (int i = 49; i >= 0; --i) {
+        unchangedCopy.setValue("Value" + std::to_string(i), i);
+    }
+    b.setValue("Unchanged", unchangedCopy);
+
+    CHECK(ghoul::Dictionary::diff(a, a).empty());
+    CHECK(ghoul::Dictionary::diff(b, b).empty());
+
+    const ghoul::Dictionary::Patch patch = ghoul::Dictionary::diff(a, b);
+    REQUIRE(patch.size() == 5);
+    CHECK(patch[0].type == Change::Type::Set);
+    CHECK(patch[0].key == "Added");
+    CHECK(patch[1].type == Change::Type::Set);
+    CHECK(patch[1].key == "Double");
+    CHECK(std::get<double>(patch[1].value) == 2.0);
+    CHECK(patch[2].type == Change::Type::Modify);
+    CHECK(patch[2].key == "Modified");
+    REQUIRE(patch[2].changes.size() == 2);
+    CHECK(patch[2].changes[0].type == Change::Type::Set);
+    CHECK(patch[2].changes[0].key == "Name");
+    CHECK(patch[2].changes[1].type == Change::Type::Remove);
+    CHECK(patch[2].changes[1].key == "Removed");
+    CHECK(patch[3].type == Change::Type::Remove);
+    CHECK(patch[3].key == "Removed");
+    CHECK(patch[4].type == Change::Type::Set);
+    CHECK(patch[4].key == "TypeChange");
+
+    ghoul::Dictionary c = a;
+    c.apply(patch);
+    CHECK(c == b);
+    CHECK(c.hash() == b.hash());
+    CHECK(a.value<std::string>("Modified.Name") == "Old");
+    CHECK(c.value<std::string>("Modified.Name") == "New");
+
+    ghoul::Dictionary d = b;
+    d.apply(ghoul::Dictionary::diff(b, a));
+    CHECK(d == a);
+
+    // Modifying a nested Dictionary that does not exist leaves the Dictionary unchanged
+    ghoul::Dictionary e;
+    e.setValue("Modified", 1);
+    const ghoul::Dictionary original = e;
+    CHECK_THROWS_AS(e.apply(patch), ghoul::Dictionary::ValueError);
+    CHECK(e == original);
+    ghoul::Dictionary f;
+    CHECK_THROWS_AS(f.apply(patch), ghoul::Dictionary::KeyError);
+    CHECK(f.isEmpty());
+}
+
+TEST_CASE("Dictionary: Benchmark Diff", "[.][benchmark][dictionary]") {
+    ghoul::Dictionary a;
+    for (int i = 0; i < 100; ++i) {
+        ghoul::Dictionary e;
+        for (int j = 0; j < 100; ++j) {
+            e.setValue("Value" + std::to_string(j), std::to_string(i * j));
+        }
+        a.setValue("Entry" + std::to_string(i), e);
+    }
+
+    // A reloaded configuration in which a single value has changed
+    ghoul::Dictionary b;
+    for (int i = 0; i < 100; ++i) {
+        ghoul::Dictionary e;
+        for (int j = 0; j < 100; ++j) {
+            e.setValue("Value" + std::to_string(j), std::to_string(i * j));
+        }
+        if (i == 50) {
+            e.setValue("Value50", std::string("changed"));
+        }
+        b.setValue("Entry" + std::to_string(i), e);
+    }
+
+    BENCHMARK("operator==") {
+        return a == b;
+    };
+
+    // After the first iteration, the hashes of the unchanged Dictionaries are cached
+    BENCHMARK("diff") {
+        return ghoul::Dictionary::diff(a, b).size();
+    };
+}
@@ -0,0 +1,421 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/misc/dictionarybinaryformat.h>
+#include <ghoul/misc/buffer.h>
+#include <ghoul/misc/crc32.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/glm.h>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+    ghoul::Dictionary createDictionary() {
+        ghoul::Dictionary nested;
+        nested.setValue("Value", 1.5);
+        nested.setValue("Name", std::string("nested"));
+
+        ghoul::Dictionary d;
+        d.setValue("Bool", true);
+        d.setValue("Int", 42);
+        d.setValue("Double", 123.456);
+        d.setValue("String", std::string("string"));
+        d.setValue("EmptyString", std::string());
+        d.setValue("IntVector", std::vector<int>{ 1, 2, 3 });
+        d.setValue("DoubleVector", std::vector<double>{ 1.0, 2.0 });
+        d.setValue("StringVector", std::vector<std::string>{ "a", "", "ccc" });
+        d.setValue("IVec3", glm::ivec3(1, 2, 3));
+        d.setValue("DVec4", glm::dvec4(1.0, 2.0, 3.0, 4.0));
+        d.setValue("DMat3x2", glm::dmat3x2(2.0));
+        d.setValue("Nested", nested);
+        d.setValue("Empty", ghoul::Dictionary());
+        return d;
+    }
+} // namespace
+
+TEST_CASE("DictionaryBinaryFormat: Roundtrip", "[dictionarybinaryformat]") {
+    const ghoul::Dictionary d = createDictionary();
+
+    ghoul::Buffer buffer;
+    ghoul::serializeDictionary(d, buffer);
+    const ghoul::Dictionary res = ghoul::deserializeDictionary(buffer);
+
+    CHECK(res == d);
+    CHECK(res.value<int>("Int") == 42);
+    CHECK(res.value<std::string>("Nested.Name") == "nested");
+    // Values keep their exact type
+    CHECK(res.value<glm::ivec3>("IVec3") == glm::ivec3(1, 2, 3));
+    CHECK(res.value<std::vector<int>>("IntVector") == std::vector<int>{ 1, 2, 3 });
+    CHECK(res.value<glm::dmat3x2>("DMat3x2") == glm::dmat3x2(2.0));
+    CHECK(res.subDictionary("Empty")->isEmpty());
+}
+
+TEST_CASE("DictionaryBinaryFormat: Roundtrip Compressed", "[dictionarybinaryformat]") {
+    ghoul::Dictionary d = createDictionary();
+    for (int i = 0; i < 100; ++i) {
+        d.setValue("Repeated" + std::to_string(i), std::string(100, 'a'));
+    }
+
+    ghoul::Buffer uncompressed;
+    ghoul::serializeDictionary(d, uncompressed);
+    ghoul::Buffer compressed;
+    ghoul::serializeDictionary(d, compressed, ghoul::Buffer::Compress::Yes);
+    CHECK(compressed.size() < uncompressed.size());
+
+    CHECK(ghoul::deserializeDictionary(compressed) == d);
+    CHECK_THROWS_AS(
+        ghoul::DictionaryView(compressed.data(), compressed.size()),
+        ghoul::DictionaryBinaryFormatError
+    );
+}
+
+TEST_CASE("DictionaryBinaryFormat: Multiple In Buffer", "[dictionarybinaryformat]") {
+    ghoul::Dictionary d1;
+    d1.setValue("a", 1);
+    ghoul::Dictionary d2;
+    d2.setValue("b", std::string("b"));
+
+    ghoul::Buffer buffer;
+    ghoul::serializeDictionary(d1, buffer, ghoul::Buffer::Compress::Yes);
+    buffer.serialize(42);
+    ghoul::serializeDictionary(d2, buffer);
+
+    CHECK(ghoul::deserializeDictionary(buffer) == d1);
+    int i;
+    buffer.deserialize(i);
+    CHECK(i == 42);
+    CHECK(ghoul::deserializeDictionary(buffer) == d2);
+}
+
+TEST_CASE("DictionaryBinaryFormat: Shared Subtrees", "[dictionarybinaryformat]") {
+    ghoul::Dictionary nested;
+    for (int i = 0; i < 100; ++i) {
+        nested.setValue("Key" + std::to_string(i), i);
+    }
+    ghoul::Dictionary single;
+    single.setValue("A", nested);
+    ghoul::Dictionary shared = single;
+    shared.setValue("B", nested);
+
+    ghoul::Buffer b1;
+    ghoul::serializeDictionary(single, b1);
+    ghoul::Buffer b2;
+    ghoul::serializeDictionary(shared, b2);
+    // The shared subtree is only stored once
+    CHECK(b2.size() < b1.size() + 100);
+
+    const ghoul::Dictionary res = ghoul::deserializeDictionary(b2);
+    CHECK(res == shared);
+    CHECK(res.value<int>("B.Key99") == 99);
+}
+
+TEST_CASE("DictionaryBinaryFormat: View", "[dictionarybinaryformat]") {
+    const ghoul::Dictionary d = createDictionary();
+    ghoul::Buffer buffer;
+    ghoul::serializeDictionary(d, buffer);
+
+    const ghoul::DictionaryView view(buffer.data(), buffer.size());
+    CHECK(view.size() == d.size());
+    CHECK(view.keys() == d.keys());
+    CHECK(view.dictionary() == d);
+
+    CHECK(view.value<bool>("Bool"));
+    CHECK(view.value<int>("Int") == 42);
+    CHECK(view.value<double>("Double") == 123.456);
+    CHECK(view.value<std::string>("String") == "string");
+    CHECK(view.value<std::string_view>("String") == "string");
+    CHECK(view.value<std::string_view>("EmptyString").empty());
+    CHECK(view.value<std::vector<std::string>>("StringVector") ==
+          std::vector<std::string>{ "a", "", "ccc" });
+    CHECK(view.value<glm::dvec4>("DVec4") == glm::dvec4(1.0, 2.0, 3.0, 4.0));
+    CHECK(view.value<ghoul::Dictionary>("Nested") == *d.subDictionary("Nested"));
+
+    CHECK(view.hasKey("Nested.Value"));
+    CHECK_FALSE(view.hasKey("Nested.Missing"));
+    CHECK_FALSE(view.hasKey("Int.Value"));
+    CHECK(view.value<double>("Nested.Value") == 1.5);
+    CHECK(view.subDictionary("Nested").value<std::string>("Name") == "nested");
+    CHECK(view.subDictionary("Empty").isEmpty());
+
+    CHECK(view.hasValue<int>("Int"));
+    CHECK_FALSE(view.hasValue<double>("Int"));
+    CHECK(view.hasValue<std::string_view>("String"));
+    CHECK(view.hasValue<ghoul::Dictionary>("Nested"));
+
+    CHECK_THROWS_AS(view.value<int>("Missing"), ghoul::Dictionary::KeyError);
+    CHECK_THROWS_AS(view.value<int>("Double"), ghoul::Dictionary::ValueError);
+    CHECK_THROWS_AS(view.subDictionary("Int"), ghoul::Dictionary::ValueError);
+}
+
+TEST_CASE("DictionaryBinaryFormat: View glm", "[dictionarybinaryformat]") {
+    const ghoul::Dictionary d = createDictionary();
+    ghoul::Buffer buffer;
+    ghoul::serializeDictionary(d, buffer);
+    const ghoul::DictionaryView view(buffer.data(), buffer.size());
+
+    CHECK(view.hasValue<glm::ivec3>("IntVector"));
+    CHECK(view.value<glm::ivec3>("IntVector") == glm::ivec3(1, 2, 3));
+    CHECK(view.hasValue<std::vector<int>>("IVec3"));
+    CHECK(view.value<std::vector<int>>("IVec3") == std::vector<int>{ 1, 2, 3 });
+    CHECK(view.value<std::vector<double>>("DMat3x2").size() == 6);
+
+    CHECK_FALSE(view.hasValue<glm::ivec4>("IntVector"));
+    CHECK_THROWS_AS(view.value<glm::ivec4>("IntVector"), ghoul::Dictionary::ValueError);
+    CHECK_FALSE(view.hasValue<glm::dvec3>("IntVector"));
+    CHECK_FALSE(view.hasValue<std::vector<int>>("DVec4"));
+}
+
+TEST_CASE("DictionaryBinaryFormat: Corrupt Data", "[dictionarybinaryformat]") {
+    ghoul::Dictionary d = createDictionary();
+    ghoul::Buffer buffer;
+    ghoul::serializeDictionary(d, buffer);
+
+    const std::vector<unsigned char> garbage(64, 0);
+    CHECK_THROWS_AS(
+        ghoul::DictionaryView(garbage.data(), garbage.size()),
+        ghoul::DictionaryBinaryFormatError
+    );
+
+    // A truncated buffer is detected either on construction or on access, but it must
+    // never read outside of the provided memory
+    for (size_t size = 1; size < buffer.size(); ++size) {
+        std::vector<unsigned char> truncated(buffer.data(), buffer.data() + size);
+        CHECK_THROWS_AS(
+            ghoul::DictionaryView(truncated.data(), truncated.size()).dictionary(),
+            ghoul::DictionaryBinaryFormatError
+        );
+    }
+}
+
+TEST_CASE("DictionaryBinaryFormat: Corrupt Buffer", "[dictionarybinaryformat]") {
+    ghoul::Dictionary d = createDictionary();
+    for (ghoul::Buffer::Compress compress : { ghoul::Buffer::Compress::No,
+                                              ghoul::Buffer::Compress::Yes })
+    {
+        ghoul::Buffer buffer;
+        ghoul::serializeDictionary(d, buffer, compress);
+
+        for (size_t size = 0; size < buffer.size(); ++size) {
+            ghoul::Buffer truncated;
+            if (size > 0) {
+                truncated.serialize(buffer.data(), size);
+            }
+            CHECK_THROWS_AS(
+                ghoul::deserializeDictionary(truncated),
+                ghoul::DictionaryBinaryFormatError
+            );
+        }
+    }
+
+    // A compressed Dictionary whose decompressed size is impossibly large is rejected
+    // before any memory is allocated for it
+    ghoul::Buffer buffer;
+    ghoul::serializeDictionary(d, buffer, ghoul::Buffer::Compress::Yes);
+    const uint32_t valuesSize = std::numeric_limits<uint32_t>::max();
+    std::memcpy(buffer.data() + 8, &valuesSize, sizeof(uint32_t));
+    CHECK_THROWS_AS(
+        ghoul::deserializeDictionary(buffer),
+        ghoul::DictionaryBinaryFormatError
+    );
+}
+
+TEST_CASE("DictionaryBinaryFormat: Cyclic Data", "[dictionarybinaryformat]") {
+    // A root node with a single entry "a" whose Dictionary value is the root node itself
+    const uint32_t dictionaryType = static_cast<uint32_t>(
+        ghoul::Dictionary::Types(ghoul::Dictionary()).index()
+    );
+    const uint32_t nEntries = 1;
+    const std::array<uint32_t, 6> entry = {
+        ghoul::hashCRC32("a"),  // hash
+        28,                     // keyOffset
+        1,                      // keyLength
+        0,                      // valueOffset
+        29,                     // valueSize
+        dictionaryType          // type
+    };
+    const uint32_t valuesSize = sizeof(uint32_t) + sizeof(entry) + 1;
+    const std::array<char, 8> header = { 'G', 'D', 'I', 'C', 1, 0, 0, 0 };
+
+    std::vector<unsigned char> data(header.size() + 2 * sizeof(uint32_t) + valuesSize);
+    unsigned char* p = data.data();
+    std::memcpy(p, header.data(), header.size());
+    std::memcpy(p + 8, &valuesSize, sizeof(uint32_t));
+    std::memcpy(p + 12, &valuesSize, sizeof(uint32_t));
+    std::memcpy(p + 16, &nEntries, sizeof(uint32_t));
+    std::memcpy(p + 20, entry.data(), sizeof(entry));
+    p[16 + 28] = 'a';
+
+    const ghoul::DictionaryView view(data.data(), data.size());
+    CHECK(view.hasKey("a"));
+    CHECK_THROWS_AS(view.hasKey("a.a"), ghoul::DictionaryBinaryFormatError);
+    CHECK_THROWS_AS(view.value<int>("a.a.a"), ghoul::DictionaryBinaryFormatError);
+    CHECK_THROWS_AS(view.dictionary(), ghoul::DictionaryBinaryFormatError);
+
+    ghoul::Buffer buffer;
+    buffer.serialize(data.data(), data.size());
+    CHECK_THROWS_AS(
+        ghoul::deserializeDictionary(buffer),
+        ghoul::DictionaryBinaryFormatError
+    );
+}
+
+TEST_CASE("DictionaryBinaryFormat: Invalid Keys", "[dictionarybinaryformat]") {
+    // A root node with a single int entry with the provided key
+    auto serialized = [](const std::string& key) {
+        const uint32_t intType = static_cast<uint32_t>(
+            ghoul::Dictionary::Types(0).index()
+        );
+        const uint32_t nEntries = 1;
+        const uint32_t keyLength = static_cast<uint32_t>(key.size());
+        const std::array<uint32_t, 6> entry = {
+            ghoul::hashCRC32(key),  // hash
+            28,                     // keyOffset
+            keyLength,              // keyLength
+            28 + keyLength,         // valueOffset
+            4,                      // valueSize
+            intType                 // type
+        };
+        const uint32_t valuesSize = sizeof(uint32_t) + sizeof(entry) + keyLength + 4;
+        const std::array<char, 8> header = { 'G', 'D', 'I', 'C', 1, 0, 0, 0 };
+
+        std::vector<unsigned char> data(
+            header.size() + 2 * sizeof(uint32_t) + valuesSize
+        );
+        unsigned char* p = data.data();
+        const int value = 1;
+        std::memcpy(p, header.data(), header.size());
+        std::memcpy(p + 8, &valuesSize, sizeof(uint32_t));
+        std::memcpy(p + 12, &valuesSize, sizeof(uint32_t));
+        std::memcpy(p + 16, &nEntries, sizeof(uint32_t));
+        std::memcpy(p + 20, entry.data(), sizeof(entry));
+        std::memcpy(p + 16 + 28, key.data(), keyLength);
+        std::memcpy(p + 16 + 28 + keyLength, &value, sizeof(int));
+
+        ghoul::Buffer buffer;
+        buffer.serialize(data.data(), data.size());
+        return buffer;
+    };
+
+    ghoul::Buffer valid = serialized("a");
+    CHECK(ghoul::deserializeDictionary(valid).value<int>("a") == 1);
+
+    ghoul::Buffer empty = serialized("");
+    CHECK_THROWS_AS(
+        ghoul::deserializeDictionary(empty),
+        ghoul::DictionaryBinaryFormatError
+    );
+
+    ghoul::Buffer dotted = serialized("a.");
+    CHECK_THROWS_AS(
+        ghoul::deserializeDictionary(dotted),
+        ghoul::DictionaryBinaryFormatError
+    );
+}
+
+TEST_CASE("DictionaryBinaryFormat: Maximum Depth", "[dictionarybinaryformat]") {
+    auto nested = [](int depth) {
+        ghoul::Dictionary d;
+        for (int i = 1; i < depth; ++i) {
+            ghoul::Dictionary parent;
+            parent.setValue("a", std::move(d));
+            d = std::move(parent);
+        }
+        return d;
+    };
+    auto key = [](int depth) {
+        std::string res = "a";
+        for (int i = 2; i < depth; ++i) {
+            res += ".a";
+        }
+        return res;
+    };
+
+    ghoul::Buffer valid;
+    ghoul::serializeDictionary(nested(512), valid);
+    const ghoul::DictionaryView validView(valid.data(), valid.size());
+    CHECK(validView.hasKey(key(512)));
+    CHECK(ghoul::deserializeDictionary(valid).hasKey(key(512)));
+
+    ghoul::Buffer tooDeep;
+    ghoul::serializeDictionary(nested(513), tooDeep);
+    const ghoul::DictionaryView tooDeepView(tooDeep.data(), tooDeep.size());
+    // Looking up a key in the innermost node requires entering the 513th level
+    CHECK_THROWS_AS(
+        tooDeepView.hasKey(key(513) + ".a"),
+        ghoul::DictionaryBinaryFormatError
+    );
+    CHECK_THROWS_AS(
+        ghoul::deserializeDictionary(tooDeep),
+        ghoul::DictionaryBinaryFormatError
+    );
+}
+
+TEST_CASE("DictionaryBinaryFormat: Benchmark", "[.][benchmark][dictionarybinaryformat]") {
+    ghoul::Dictionary d;
+    for (int i = 0; i < 1000; ++i) {
+        ghoul::Dictionary e;
+        e.setValue("Identifier", "Identifier" + std::to_string(i));
+        e.setValue("Position", glm::dvec3(1.0, 2.0, 3.0));
+        e.setValue("Tags", std::vector<std::string>{ "Tag1", "Tag2" });
+        d.setValue("Entry" + std::to_string(i), e);
+    }
+
+    ghoul::Buffer buffer;
+    ghoul::serializeDictionary(d, buffer);
+    ghoul::Buffer compressed;
+    ghoul::serializeDictionary(d, compressed, ghoul::Buffer::Compress::Yes);
+
+    BENCHMARK("serialize") {
+        ghoul::Buffer b;
+        ghoul::serializeDictionary(d, b);
+        return b.size();
+    };
+
+    BENCHMARK("serialize compressed") {
+        ghoul::Buffer b;
+        ghoul::serializeDictionary(d, b, ghoul::Buffer::Compress::Yes);
+        return b.size();
+    };
+
+    BENCHMARK("deserialize") {
+        ghoul::Buffer b = buffer;
+        return ghoul::deserializeDictionary(b).size();
+    };
+
+    BENCHMARK("deserialize compressed") {
+        ghoul::Buffer b = compressed;
+        return ghoul::deserializeDictionary(b).size();
+    };
+
+    BENCHMARK("view lookup") {
+        const ghoul::DictionaryView view(buffer.data(), buffer.size());
+        return view.value<glm::dvec3>("Entry500.Position");
+    };
+}
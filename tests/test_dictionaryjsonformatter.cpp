@@ -27,6 +27,8 @@
 
 #include <ghoul/misc/dictionaryjsonformatter.h>
 #include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/dictionaryjsonparser.h>
+#include <sstream>
 #include <string>
 
 TEST_CASE("DictionaryJsonFormatter: Empty Dictionary", "[dictionaryjsonformatter]") {
@@ -210,3 +212,77 @@ TEST_CASE("DictionaryJsonFormatter: Nested Dictionary", "[dictionaryjsonformatte
         "\"vec4\":[0,0,0,0]}"
     );
 }
+
+TEST_CASE("DictionaryJsonFormatter: Escaped Strings", "[dictionaryjsonformatter]") {
+    using namespace std::string_literals;
+    ghoul::Dictionary d;
+    // Longer than a single vector register to test the escape scanning across blocks
+    d.setValue("string", "0123456789abcdef\"quote\" and \\ and\nnew\tline 0123456789"s);
+
+    std::string res = ghoul::formatJson(d);
+    CHECK(
+        res ==
+        "{\"string\":\"0123456789abcdef\\\"quote\\\" and \\\\ and\\nnew\\tline "
+        "0123456789\"}"
+    );
+
+    // Control characters without a short escape sequence are written as \u00XX
+    const std::string control = "a\x01" "b\x1F" "0\x7F"s;
+    ghoul::Dictionary c;
+    c.setValue("string", control);
+    res = ghoul::formatJson(c);
+    CHECK(res == "{\"string\":\"a\\u0001b\\u001f0\x7F\"}");
+    CHECK(ghoul::parseJson(res).value<std::string>("string") == control);
+}
+
+TEST_CASE("DictionaryJsonFormatter: Output Overloads", "[dictionaryjsonformatter]") {
+    ghoul::Dictionary nested;
+    nested.setValue("int", 1);
+    nested.setValue("vec", std::vector<double>{ 1.5, 2.5 });
+    ghoul::Dictionary d;
+    for (int i = 0; i < 100; i++) {
+        d.setValue("dict" + std::to_string(i), nested);
+    }
+    const std::string expected = ghoul::formatJson(d);
+
+    std::string output = "prefix";
+    ghoul::formatJson(d, output);
+    CHECK(output == "prefix" + expected);
+
+    std::stringstream stream;
+    ghoul::formatJson(d, stream);
+    CHECK(stream.str() == expected);
+
+    ghoul::Dictionary invalid;
+    invalid.setValue("strings", std::vector<std::string>{ "a", "b" });
+    std::string invalidOutput;
+    CHECK_THROWS_AS(
+        ghoul::formatJson(invalid, invalidOutput),
+        ghoul::JsonFormattingError
+    );
+}
+
+TEST_CASE("DictionaryJsonFormatter: Benchmark",
+          "[.][benchmark][dictionaryjsonformatter]")
+{
+    ghoul::Dictionary d;
+    for (int i = 0; i < 1000; i++) {
+        ghoul::Dictionary e;
+        e.setValue("name", "Entry number " + std::to_string(i));
+        e.setValue("value", i * 0.5);
+        e.setValue("position", glm::dvec3(i, i + 1, i + 2));
+        e.setValue("enabled", i % 2 == 0);
+        d.setValue(std::to_string(i), e);
+    }
+
+    BENCHMARK("String") {
+        return ghoul::formatJson(d);
+    };
+
+    std::string buffer;
+    BENCHMARK("Reused Buffer") {
+        buffer.clear();
+        ghoul::formatJson(d, buffer);
+        return buffer.size();
+    };
+}
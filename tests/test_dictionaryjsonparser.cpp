@@ -0,0 +1,364 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/misc/dictionaryjsonparser.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/dictionaryjsonformatter.h>
+#include <ghoul/glm.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+TEST_CASE("DictionaryJsonParser: Empty", "[dictionaryjsonparser]") {
+    CHECK(ghoul::parseJson("{}").isEmpty());
+    CHECK(ghoul::parseJson("[]").isEmpty());
+    CHECK(ghoul::parseJson(" \n\t\r{ \n}\n ").isEmpty());
+}
+
+TEST_CASE("DictionaryJsonParser: Simple Values", "[dictionaryjsonparser]") {
+    const ghoul::Dictionary d = ghoul::parseJson(R"({
+        "boolFalse": false,
+        "boolTrue": true,
+        "int": 1,
+        "double": -2.5e-3,
+        "string": "abc",
+        "null": null
+    })");
+
+    CHECK(d.size() == 5);
+    CHECK_FALSE(d.value<bool>("boolFalse"));
+    CHECK(d.value<bool>("boolTrue"));
+    // All numbers are stored as doubles, just like in the Lua conversion
+    CHECK(d.hasValue<double>("int"));
+    CHECK(d.value<double>("int") == 1.0);
+    CHECK(d.value<double>("double") == -2.5e-3);
+    CHECK(d.value<std::string>("string") == "abc");
+    CHECK_FALSE(d.hasKey("null"));
+}
+
+TEST_CASE("DictionaryJsonParser: Nested", "[dictionaryjsonparser]") {
+    const ghoul::Dictionary d = ghoul::parseJson(R"({
+        "a": { "b": { "c": 1 }, "d": [] },
+        "vec3": [1, 2, 3],
+        "mixed": ["a", true, null, { "e": "f" }],
+        "nested": [[1], [[2]]]
+    })");
+
+    CHECK(d.value<double>("a.b.c") == 1.0);
+    CHECK(d.subDictionary("a.d")->isEmpty());
+
+    // Arrays use 1-based keys and can be retrieved as glm types
+    CHECK(d.value<double>("vec3.1") == 1.0);
+    CHECK(d.value<glm::dvec3>("vec3") == glm::dvec3(1.0, 2.0, 3.0));
+
+    CHECK(d.value<std::string>("mixed.1") == "a");
+    CHECK(d.value<bool>("mixed.2"));
+    CHECK_FALSE(d.hasKey("mixed.3"));
+    CHECK(d.value<std::string>("mixed.4.e") == "f");
+
+    CHECK(d.value<double>("nested.1.1") == 1.0);
+    CHECK(d.value<double>("nested.2.1.1") == 2.0);
+}
+
+TEST_CASE("DictionaryJsonParser: Top-Level Array", "[dictionaryjsonparser]") {
+    const ghoul::Dictionary d = ghoul::parseJson(R"([ "a", "b" ])");
+    CHECK(d.keys() == std::vector<std::string_view>{ "1", "2" });
+    CHECK(d.value<std::string>("2") == "b");
+}
+
+TEST_CASE("DictionaryJsonParser: Duplicate Keys", "[dictionaryjsonparser]") {
+    const ghoul::Dictionary d = ghoul::parseJson(R"({ "a": 1, "a": 2 })");
+    CHECK(d.size() == 1);
+    CHECK(d.value<double>("a") == 2.0);
+}
+
+TEST_CASE("DictionaryJsonParser: Numbers", "[dictionaryjsonparser]") {
+    const ghoul::Dictionary d = ghoul::parseJson(R"([
+        0, -0, 123456789, -1.5, 1e3, 1E+3, 2.5e-2, 0.1, 1.7976931348623157e308,
+        1e400, -1e400, 1e-400
+    ])");
+
+    CHECK(d.value<double>("1") == 0.0);
+    CHECK(d.value<double>("2") == 0.0);
+    CHECK(d.value<double>("3") == 123456789.0);
+    CHECK(d.value<double>("4") == -1.5);
+    CHECK(d.value<double>("5") == 1000.0);
+    CHECK(d.value<double>("6") == 1000.0);
+    CHECK(d.value<double>("7") == 0.025);
+    CHECK(d.value<double>("8") == 0.1);
+    CHECK(d.value<double>("9") == 1.7976931348623157e308);
+    CHECK(d.value<double>("10") == HUGE_VAL);
+    CHECK(d.value<double>("11") == -HUGE_VAL);
+    CHECK(d.value<double>("12") == 0.0);
+}
+
+TEST_CASE("DictionaryJsonParser: Strings", "[dictionaryjsonparser]") {
+    const ghoul::Dictionary d = ghoul::parseJson(R"({
+        "escapes": "a\"b\\c\/d\be\ff\ng\rh\ti",
+        "unicode": "\u0041\u00e9\u20AC\ud83d\ude00",
+        "utf8": "Ærøskøbing",
+        "long": "0123456789abcdef0123456789abcdef\n0123456789abcdef0123456789abcdef",
+        "\u006bey": 1
+    })");
+
+    CHECK(d.value<std::string>("escapes") == "a\"b\\c/d\be\ff\ng\rh\ti");
+    CHECK(d.value<std::string>("unicode") == "A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+    CHECK(d.value<std::string>("utf8") == "Ærøskøbing");
+    CHECK(
+        d.value<std::string>("long") ==
+        "0123456789abcdef0123456789abcdef\n0123456789abcdef0123456789abcdef"
+    );
+    CHECK(d.hasKey("key"));
+}
+
+TEST_CASE("DictionaryJsonParser: Byte Order Mark", "[dictionaryjsonparser]") {
+    const ghoul::Dictionary d = ghoul::parseJson("\xEF\xBB\xBF{ \"a\": true }");
+    CHECK(d.value<bool>("a"));
+}
+
+TEST_CASE("DictionaryJsonParser: Formatter Roundtrip", "[dictionaryjsonparser]") {
+    ghoul::Dictionary nested;
+    nested.setValue("value", 0.5);
+    nested.setValue("string", std::string("with \"quotes\"\n and \\ backslash"));
+
+    ghoul::Dictionary d;
+    d.setValue("bool", true);
+    d.setValue("double", 2.2);
+    d.setValue("vec3", glm::dvec3(1.0, 2.0, 3.0));
+    d.setValue("nested", nested);
+
+    const ghoul::Dictionary res = ghoul::parseJson(ghoul::formatJson(d));
+    CHECK(res.value<bool>("bool"));
+    CHECK(res.value<double>("double") == 2.2);
+    CHECK(res.value<glm::dvec3>("vec3") == glm::dvec3(1.0, 2.0, 3.0));
+    CHECK(*res.subDictionary("nested") == nested);
+}
+
+TEST_CASE("DictionaryJsonParser: Errors", "[dictionaryjsonparser]") {
+    const std::vector<std::string> invalid = {
+        "",
+        "   ",
+        "1",
+        "\"string\"",
+        "{",
+        "[",
+        "{ \"a\" }",
+        "{ \"a\": }",
+        "{ \"a\": 1, }",
+        "[ 1, ]",
+        "[ 1 2 ]",
+        "{ \"a\": 1 ]",
+        "[ 1 }",
+        "{ a: 1 }",
+        "{ 'a': 1 }",
+        "[ tru ]",
+        "[ nul ]",
+        "[ True ]",
+        "[ 01 ]",
+        "[ 1. ]",
+        "[ .5 ]",
+        "[ +1 ]",
+        "[ 1e ]",
+        "[ - ]",
+        "[ NaN ]",
+        "[ Infinity ]",
+        "[ \"unterminated ]",
+        "[ \"invalid \\x escape\" ]",
+        "[ \"control \n character\" ]",
+        "[ \"\\u12\" ]",
+        "[ \"\\ud83d\" ]",
+        "[ \"\\ude00\" ]",
+        "[ \"\\ud83d\\u0041\" ]",
+        "{} {}",
+        "{} x"
+    };
+
+    for (const std::string& json : invalid) {
+        INFO(json);
+        CHECK_THROWS_AS(ghoul::parseJson(json), ghoul::JsonParsingError);
+    }
+}
+
+TEST_CASE("DictionaryJsonParser: Error Location", "[dictionaryjsonparser]") {
+    try {
+        ghoul::parseJson("{\n  \"a\": 1,\n  \"b\": x\n}");
+        FAIL("No exception thrown");
+    }
+    catch (const ghoul::JsonParsingError& e) {
+        CHECK(e.line == 3);
+        CHECK(e.column == 8);
+    }
+}
+
+namespace {
+    // Handler that records all events as a string
+    class RecordingHandler : public ghoul::JsonHandler {
+    public:
+        std::string events;
+
+        void beginObject() override { events += "{"; }
+        void endObject() override { events += "}"; }
+        void beginArray() override { events += "["; }
+        void endArray() override { events += "]"; }
+        void key(std::string_view key) override {
+            events += "k(" + std::string(key) + ")";
+        }
+        void null() override { events += "n"; }
+        void value(bool value) override { events += value ? "t" : "f"; }
+        void value(double value) override {
+            events += "d(" + std::to_string(static_cast<int>(value)) + ")";
+        }
+        void value(std::string_view value) override {
+            events += "s(" + std::string(value) + ")";
+        }
+    };
+
+    std::string createLargeJson(int nEntries, bool pretty) {
+        const std::string newline = pretty ? "\n" : "";
+        const std::string indent = pretty ? "        " : "";
+        std::string json = "[" + newline;
+        for (int i = 0; i < nEntries; ++i) {
+            json += indent + "{" + newline;
+            json += indent + indent + "\"Identifier\": \"Entry" + std::to_string(i) +
+                "\"," + newline;
+            json += indent + indent + "\"Description\": \"A longer description of the "
+                "entry with an \\\"escaped\\\" quote\"," + newline;
+            json += indent + indent + "\"Position\": [ 1.5, -2.25e3, " +
+                std::to_string(i) + " ]," + newline;
+            json += indent + indent + "\"Enabled\": true" + newline;
+            json += indent + "}" + (i < nEntries - 1 ? "," : "") + newline;
+        }
+        json += "]";
+        return json;
+    }
+
+    class CountingHandler : public ghoul::JsonHandler {
+    public:
+        size_t nEvents = 0;
+
+        void beginObject() override { nEvents++; }
+        void endObject() override { nEvents++; }
+        void beginArray() override { nEvents++; }
+        void endArray() override { nEvents++; }
+        void key(std::string_view) override { nEvents++; }
+        void null() override { nEvents++; }
+        void value(bool) override { nEvents++; }
+        void value(double) override { nEvents++; }
+        void value(std::string_view) override { nEvents++; }
+    };
+} // namespace
+
+TEST_CASE("DictionaryJsonParser: Handler", "[dictionaryjsonparser]") {
+    RecordingHandler handler;
+    ghoul::parseJson(
+        R"({ "a": [1, "b\n", null, {}], "c": { "d": false }, "e": true })",
+        handler
+    );
+    CHECK(handler.events == "{k(a)[d(1)s(b\n)n{}]k(c){k(d)f}k(e)t}");
+
+    // The handler also accepts scalar documents
+    RecordingHandler scalar;
+    ghoul::parseJson(" 42 ", scalar);
+    CHECK(scalar.events == "d(42)");
+}
+
+TEST_CASE("DictionaryJsonParser: Invalid Keys", "[dictionaryjsonparser]") {
+    try {
+        ghoul::parseJson("{\n  \"a\": 1,\n  \"\": 2\n}");
+        FAIL("No exception thrown");
+    }
+    catch (const ghoul::JsonParsingError& e) {
+        CHECK(e.line == 3);
+        CHECK(e.column == 3);
+    }
+
+    try {
+        ghoul::parseJson(R"({ "a": { "b.c": 1 } })");
+        FAIL("No exception thrown");
+    }
+    catch (const ghoul::JsonParsingError& e) {
+        CHECK(e.line == 1);
+        CHECK(e.column == 10);
+    }
+
+    // The streaming parser does not impose the restrictions of Dictionary keys
+    RecordingHandler handler;
+    ghoul::parseJson(R"({ "": 1, "a.b": 2 })", handler);
+    CHECK(handler.events == "{k()d(1)k(a.b)d(2)}");
+}
+
+TEST_CASE("DictionaryJsonParser: Maximum Depth", "[dictionaryjsonparser]") {
+    auto nested = [](int depth) {
+        return std::string(depth, '[') + std::string(depth, ']');
+    };
+
+    CHECK_FALSE(ghoul::parseJson(nested(512)).isEmpty());
+    CHECK_THROWS_AS(ghoul::parseJson(nested(513)), ghoul::JsonParsingError);
+    CHECK_THROWS_AS(ghoul::parseJson(nested(100000)), ghoul::JsonParsingError);
+
+    CountingHandler handler;
+    CHECK_THROWS_AS(ghoul::parseJson(nested(513), handler), ghoul::JsonParsingError);
+}
+
+TEST_CASE("DictionaryJsonParser: Large", "[dictionaryjsonparser]") {
+    const std::string json = createLargeJson(1000, true);
+    const ghoul::Dictionary d = ghoul::parseJson(json);
+    CHECK(d.size() == 1000);
+    CHECK(d.value<std::string>("1000.Identifier") == "Entry999");
+    CHECK(
+        d.value<std::string>("1.Description") ==
+        "A longer description of the entry with an \"escaped\" quote"
+    );
+    CHECK(d.value<glm::dvec3>("500.Position") == glm::dvec3(1.5, -2250.0, 499.0));
+    CHECK(ghoul::parseJson(createLargeJson(1000, false)) == d);
+}
+
+TEST_CASE("DictionaryJsonParser: Benchmark", "[.][benchmark][dictionaryjsonparser]") {
+    // About 20 MB each
+    const std::string pretty = createLargeJson(100000, true);
+    const std::string compact = createLargeJson(130000, false);
+
+    BENCHMARK("parse to Dictionary (pretty)") {
+        return ghoul::parseJson(pretty).size();
+    };
+
+    BENCHMARK("parse to Dictionary (compact)") {
+        return ghoul::parseJson(compact).size();
+    };
+
+    BENCHMARK("parse with handler (pretty)") {
+        CountingHandler handler;
+        ghoul::parseJson(pretty, handler);
+        return handler.nEvents;
+    };
+
+    BENCHMARK("parse with handler (compact)") {
+        CountingHandler handler;
+        ghoul::parseJson(compact, handler);
+        return handler.nEvents;
+    };
+}
@@ -27,6 +27,7 @@
 
 #include <ghoul/misc/dictionaryluaformatter.h>
 #include <ghoul/misc/dictionary.h>
+#include <sstream>
 #include <string>
 
 TEST_CASE("DictionaryLuaFormatter: Empty Dictionary", "[dictionaryluaformatter]") {
@@ -210,3 +211,70 @@ TEST_CASE("DictionaryLuaFormatter: Nested Dictionary", "[dictionaryluaformatter]
         "vec4={0,0,0,0}}"
     );
 }
+
+TEST_CASE("DictionaryLuaFormatter: Escaped Strings", "[dictionaryluaformatter]") {
+    using namespace std::string_literals;
+    ghoul::Dictionary d;
+    // Longer than a single vector register to test the escape scanning across blocks
+    d.setValue("string", "0123456789abcdef\"quote\" and \\ and\nnew\tline 0123456789"s);
+
+    std::string res = ghoul::formatLua(d);
+    CHECK(
+        res ==
+        "{string=\"0123456789abcdef\\\"quote\\\" and \\\\ and\\nnew\\tline "
+        "0123456789\"}"
+    );
+
+    // Control characters without a short escape sequence are written as \ddd
+    ghoul::Dictionary c;
+    c.setValue("string", "a\x01" "b\x1F" "0"s);
+    res = ghoul::formatLua(c);
+    CHECK(res == "{string=\"a\\001b\\0310\"}");
+}
+
+TEST_CASE("DictionaryLuaFormatter: Output Overloads", "[dictionaryluaformatter]") {
+    ghoul::Dictionary nested;
+    nested.setValue("int", 1);
+    nested.setValue("vec", std::vector<double>{ 1.5, 2.5 });
+    ghoul::Dictionary d;
+    for (int i = 0; i < 100; i++) {
+        d.setValue("dict" + std::to_string(i), nested);
+    }
+    const std::string expected = ghoul::formatLua(d);
+
+    std::string output = "prefix";
+    ghoul::formatLua(d, output);
+    CHECK(output == "prefix" + expected);
+
+    std::stringstream stream;
+    ghoul::formatLua(d, stream);
+    CHECK(stream.str() == expected);
+
+    ghoul::Dictionary invalid;
+    invalid.setValue("strings", std::vector<std::string>{ "a", "b" });
+    std::string invalidOutput;
+    CHECK_THROWS_AS(ghoul::formatLua(invalid, invalidOutput), ghoul::LuaFormattingError);
+}
+
+TEST_CASE("DictionaryLuaFormatter: Benchmark", "[.][benchmark][dictionaryluaformatter]") {
+    ghoul::Dictionary d;
+    for (int i = 0; i < 1000; i++) {
+        ghoul::Dictionary e;
+        e.setValue("name", "Entry number " + std::to_string(i));
+        e.setValue("value", i * 0.5);
+        e.setValue("position", glm::dvec3(i, i + 1, i + 2));
+        e.setValue("enabled", i % 2 == 0);
+        d.setValue(std::to_string(i), e);
+    }
+
+    BENCHMARK("String") {
+        return ghoul::formatLua(d);
+    };
+
+    std::string buffer;
+    BENCHMARK("Reused Buffer") {
+        buffer.clear();
+        ghoul::formatLua(d, buffer);
+        return buffer.size();
+    };
+}
@@ -0,0 +1,151 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/fmt.h>
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/lua/lua_helper.h>
+#include <ghoul/lua/luaallocator.h>
+#include <ghoul/lua/luastate.h>
+#include <cstring>
+
+namespace {
+    // Lua's own accounting of the memory that it has requested from the allocator
+    size_t luaMemoryUsage(lua_State* state) {
+        return static_cast<size_t>(lua_gc(state, LUA_GCCOUNT, 0)) * 1024 +
+            static_cast<size_t>(lua_gc(state, LUA_GCCOUNTB, 0));
+    }
+
+    constexpr const char Script[] = R"(
+        local t = {}
+        for i = 1, 10000 do
+            t[i] = { name = 'entry' .. i, value = i, list = { i, i + 1, i + 2 } }
+        end
+        return #t
+    )";
+} // namespace
+
+TEST_CASE("LuaAllocator: Reuse", "[luaallocator]") {
+    using ghoul::lua::LuaAllocator;
+    LuaAllocator allocator;
+
+    void* a = LuaAllocator::allocate(&allocator, nullptr, LUA_TTABLE, 20);
+    REQUIRE(a != nullptr);
+    CHECK(allocator.statistics().liveBytes == 20);
+    CHECK(allocator.statistics().pooledBytes == LuaAllocator::ChunkSize);
+
+    // Resizing within the same size class keeps the block
+    CHECK(LuaAllocator::allocate(&allocator, a, 20, 30) == a);
+    CHECK(allocator.statistics().liveBytes == 30);
+
+    // A freed block is reused for the next allocation of the same size class
+    CHECK(LuaAllocator::allocate(&allocator, a, 30, 0) == nullptr);
+    CHECK(allocator.statistics().liveBytes == 0);
+    CHECK(LuaAllocator::allocate(&allocator, nullptr, LUA_TSTRING, 17) == a);
+
+    // Resizing into a different size class keeps the contents
+    std::memset(a, 42, 17);
+    void* b = LuaAllocator::allocate(&allocator, a, 17, 100);
+    REQUIRE(b != nullptr);
+    CHECK(b != a);
+    for (int i = 0; i < 17; ++i) {
+        CHECK(static_cast<unsigned char*>(b)[i] == 42);
+    }
+
+    // Large blocks are not taken from the pools
+    constexpr size_t Large = LuaAllocator::MaxPooledSize + 1;
+    void* c = LuaAllocator::allocate(&allocator, b, 100, Large);
+    REQUIRE(c != nullptr);
+    CHECK(static_cast<unsigned char*>(c)[16] == 42);
+    void* e = LuaAllocator::allocate(&allocator, c, Large, 4 * Large);
+    CHECK(e != nullptr);
+    CHECK(allocator.statistics().nLargeAllocations == 2);
+    CHECK(allocator.statistics().liveBytes == 4 * Large);
+    CHECK(allocator.statistics().peakBytes == 4 * Large);
+
+    void* d = LuaAllocator::allocate(&allocator, nullptr, LUA_TSTRING, 100);
+    CHECK(d == b);
+
+    const LuaAllocator::Statistics& stats = allocator.statistics();
+    CHECK(stats.nAllocations == 3);
+    CHECK(stats.nReallocations == 4);
+    CHECK(stats.nDeallocations == 1);
+    CHECK(stats.pooledBytes == LuaAllocator::ChunkSize);
+
+    LuaAllocator::allocate(&allocator, d, 100, 0);
+    LuaAllocator::allocate(&allocator, e, 4 * Large, 0);
+    CHECK(allocator.statistics().liveBytes == 0);
+}
+
+TEST_CASE("LuaAllocator: State", "[luaallocator]") {
+    using ghoul::lua::LuaState;
+
+    LuaState state(
+        LuaState::IncludeStandardLibrary::Yes,
+        LuaState::StrictState::No,
+        LuaState::PooledAllocator::Yes
+    );
+    const ghoul::lua::LuaAllocator* allocator =
+        ghoul::lua::LuaAllocator::fromState(state);
+    REQUIRE(allocator != nullptr);
+    CHECK(allocator->statistics().liveBytes == luaMemoryUsage(state));
+
+    ghoul::lua::runScript(state, Script);
+    CHECK(ghoul::lua::value<double>(state) == 10000.0);
+    CHECK(allocator->statistics().liveBytes == luaMemoryUsage(state));
+
+    // After the garbage collection, the peak remains but the live bytes are reduced
+    lua_gc(state, LUA_GCCOLLECT, 0);
+    CHECK(allocator->statistics().liveBytes == luaMemoryUsage(state));
+    CHECK(allocator->statistics().liveBytes < allocator->statistics().peakBytes);
+    CHECK(
+        allocator->statistics().nDeallocations < allocator->statistics().nAllocations
+    );
+
+    // States with the default allocator do not have a LuaAllocator
+    LuaState defaultState;
+    CHECK(ghoul::lua::LuaAllocator::fromState(defaultState) == nullptr);
+}
+
+TEST_CASE("LuaAllocator: Benchmark", "[.][benchmark][luaallocator]") {
+    using ghoul::lua::LuaState;
+
+    BENCHMARK("default allocator") {
+        LuaState state(LuaState::IncludeStandardLibrary::Yes, LuaState::StrictState::No);
+        ghoul::lua::runScript(state, Script);
+        return ghoul::lua::value<double>(state);
+    };
+
+    BENCHMARK("pooled allocator") {
+        LuaState state(
+            LuaState::IncludeStandardLibrary::Yes,
+            LuaState::StrictState::No,
+            LuaState::PooledAllocator::Yes
+        );
+        ghoul::lua::runScript(state, Script);
+        return ghoul::lua::value<double>(state);
+    };
+}
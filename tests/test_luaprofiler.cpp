@@ -0,0 +1,324 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/lua/lua_helper.h>
+#include <ghoul/lua/luaallocator.h>
+#include <ghoul/lua/luaprofiler.h>
+#include <ghoul/lua/luastate.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/dictionaryjsonparser.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+    using ghoul::lua::LuaProfiler;
+
+    constexpr const char Functions[] = R"(
+        function leaf()
+            local t = {}
+            for i = 1, 100 do t[i] = { i } end
+            return #t
+        end
+        function middle()
+            local n = 0
+            for i = 1, 10 do n = n + leaf() end
+            return n
+        end
+        function fact(n)
+            if n <= 1 then return 1 end
+            return n * fact(n - 1)
+        end
+    )";
+
+    using Statistics = std::vector<LuaProfiler::FunctionStatistics>;
+
+    const LuaProfiler::FunctionStatistics* find(const Statistics& s,
+                                                const std::string& name)
+    {
+        const auto it = std::find_if(
+            s.begin(), s.end(),
+            [&name](const LuaProfiler::FunctionStatistics& f) {
+                return f.name.rfind(name + " (", 0) == 0;
+            }
+        );
+        return it != s.end() ? &*it : nullptr;
+    }
+} // namespace
+
+TEST_CASE("LuaProfiler: Statistics", "[luaprofiler]") {
+    ghoul::lua::LuaState state;
+    ghoul::lua::runScript(state, Functions);
+
+    LuaProfiler profiler(state);
+    CHECK_FALSE(profiler.isRunning());
+
+    const auto before = std::chrono::steady_clock::now();
+    profiler.start();
+    CHECK(profiler.isRunning());
+    ghoul::lua::runScript(state, "Result = middle() + fact(10)");
+    profiler.stop();
+    const auto duration = std::chrono::steady_clock::now() - before;
+    CHECK_FALSE(profiler.isRunning());
+
+    const std::vector<LuaProfiler::FunctionStatistics> stats = profiler.statistics();
+    const LuaProfiler::FunctionStatistics* leaf = find(stats, "leaf");
+    const LuaProfiler::FunctionStatistics* middle = find(stats, "middle");
+    const LuaProfiler::FunctionStatistics* fact = find(stats, "fact");
+    REQUIRE(leaf);
+    REQUIRE(middle);
+    REQUIRE(fact);
+
+    CHECK(leaf->nCalls == 10);
+    CHECK(middle->nCalls == 1);
+    CHECK(fact->nCalls == 10);
+
+    // Each call of leaf creates at least 100 tables
+    CHECK(leaf->nAllocations >= 1000);
+    CHECK(middle->nAllocations < leaf->nAllocations);
+    CHECK(leaf->allocatedBytes > 0);
+
+    CHECK(middle->inclusiveTime >= leaf->inclusiveTime);
+    CHECK(middle->exclusiveTime <= middle->inclusiveTime);
+    CHECK(fact->exclusiveTime <= fact->inclusiveTime);
+
+    std::chrono::nanoseconds total = std::chrono::nanoseconds(0);
+    for (const LuaProfiler::FunctionStatistics& s : stats) {
+        total += s.exclusiveTime;
+    }
+    CHECK(total <= duration);
+
+    // The results are sorted by their exclusive time
+    CHECK(std::is_sorted(
+        stats.begin(), stats.end(),
+        [](const LuaProfiler::FunctionStatistics& lhs,
+           const LuaProfiler::FunctionStatistics& rhs)
+        {
+            return lhs.exclusiveTime > rhs.exclusiveTime;
+        }
+    ));
+
+    // Nothing is recorded while the profiler is stopped
+    ghoul::lua::runScript(state, "middle()");
+    CHECK(find(profiler.statistics(), "middle")->nCalls == 1);
+
+    // Profiling again accumulates the results
+    profiler.start();
+    ghoul::lua::runScript(state, "middle()");
+    profiler.stop();
+    CHECK(find(profiler.statistics(), "middle")->nCalls == 2);
+
+    profiler.reset();
+    CHECK(profiler.statistics().empty());
+}
+
+TEST_CASE("LuaProfiler: Errors And Coroutines", "[luaprofiler]") {
+    ghoul::lua::LuaState state;
+    ghoul::lua::runScript(state, Functions);
+
+    LuaProfiler profiler(state);
+    profiler.start();
+    ghoul::lua::runScript(state, R"(
+        local function fail() leaf() error('failure') end
+        pcall(function() fail() end)
+        leaf()
+        local co = coroutine.wrap(function()
+            middle()
+            coroutine.yield()
+            leaf()
+        end)
+        co()
+        co()
+    )");
+    profiler.stop();
+
+    const std::vector<LuaProfiler::FunctionStatistics> stats = profiler.statistics();
+    REQUIRE(find(stats, "leaf"));
+    CHECK(find(stats, "leaf")->nCalls == 13);
+    REQUIRE(find(stats, "fail"));
+    CHECK(find(stats, "fail")->nCalls == 1);
+    REQUIRE(find(stats, "pcall"));
+    CHECK(find(stats, "pcall")->nCalls == 1);
+    CHECK(find(stats, "pcall")->exclusiveTime <= find(stats, "pcall")->inclusiveTime);
+    REQUIRE(find(stats, "middle"));
+    CHECK(find(stats, "middle")->nCalls == 1);
+
+    // A coroutine that outlives the profiling no longer calls the hook afterwards
+    profiler.reset();
+    profiler.start();
+    ghoul::lua::runScript(state, R"(
+        Co = coroutine.create(function()
+            coroutine.yield()
+            leaf()
+        end)
+        coroutine.resume(Co)
+    )");
+    profiler.stop();
+    lua_getglobal(state, "Co");
+    lua_State* co = lua_tothread(state, -1);
+    REQUIRE(co);
+    CHECK(lua_gethook(co) != nullptr);
+    ghoul::lua::runScript(state, "coroutine.resume(Co)");
+    CHECK(lua_gethook(co) == nullptr);
+    lua_pop(state, 1);
+    CHECK(!find(profiler.statistics(), "leaf"));
+}
+
+TEST_CASE("LuaProfiler: Suspended Coroutines", "[luaprofiler]") {
+    using namespace std::chrono_literals;
+
+    ghoul::lua::LuaState state;
+    LuaProfiler profiler(state);
+    profiler.start();
+    ghoul::lua::runScript(state, R"(
+        function suspended() coroutine.yield() end
+        function failing() error('failure') end
+        Resumed = coroutine.wrap(function() suspended() end)
+        Resumed()
+        local abandoned = coroutine.wrap(function() suspended() end)
+        abandoned()
+        coroutine.resume(coroutine.create(function() failing() end))
+    )");
+    std::this_thread::sleep_for(100ms);
+    ghoul::lua::runScript(state, "Resumed()\ncollectgarbage()");
+    std::this_thread::sleep_for(100ms);
+    profiler.stop();
+
+    // Neither the time during which the coroutines were suspended nor the time after
+    // the coroutine failed is attributed to the calls
+    const std::vector<LuaProfiler::FunctionStatistics> stats = profiler.statistics();
+    REQUIRE(find(stats, "suspended"));
+    CHECK(find(stats, "suspended")->nCalls == 2);
+    CHECK(find(stats, "suspended")->inclusiveTime < 50ms);
+    REQUIRE(find(stats, "yield"));
+    CHECK(find(stats, "yield")->nCalls == 2);
+    CHECK(find(stats, "yield")->inclusiveTime < 50ms);
+    REQUIRE(find(stats, "failing"));
+    CHECK(find(stats, "failing")->nCalls == 1);
+    CHECK(find(stats, "failing")->inclusiveTime < 50ms);
+}
+
+TEST_CASE("LuaProfiler: Report", "[luaprofiler]") {
+    ghoul::lua::LuaState state;
+    ghoul::lua::runScript(state, Functions);
+
+    LuaProfiler profiler(state);
+    profiler.start();
+    ghoul::lua::runScript(state, "middle()");
+    profiler.stop();
+
+    const std::string report = profiler.report();
+    CHECK(report.rfind("     Calls", 0) == 0);
+    CHECK(report.find("leaf (") != std::string::npos);
+    CHECK(report.find("middle (") != std::string::npos);
+
+    const std::string shortReport = profiler.report(1);
+    CHECK(std::count(shortReport.begin(), shortReport.end(), '\n') == 2);
+}
+
+TEST_CASE("LuaProfiler: Chrome Trace", "[luaprofiler]") {
+    ghoul::lua::LuaState state;
+    ghoul::lua::runScript(state, Functions);
+
+    LuaProfiler profiler(state, LuaProfiler::RecordTrace::Yes);
+    CHECK(ghoul::parseJson(profiler.chromeTrace()).hasValue<ghoul::Dictionary>(
+        "traceEvents"
+    ));
+
+    profiler.start();
+    ghoul::lua::runScript(state, "middle()");
+    profiler.stop();
+
+    const ghoul::Dictionary trace = ghoul::parseJson(profiler.chromeTrace());
+    const ghoul::Dictionary events = trace.value<ghoul::Dictionary>("traceEvents");
+    // At least the calls of middle, leaf, and the main chunk
+    CHECK(events.size() >= 12);
+
+    int nLeaf = 0;
+    for (size_t i = 1; i <= events.size(); ++i) {
+        const ghoul::Dictionary e = events.value<ghoul::Dictionary>(std::to_string(i));
+        CHECK(e.value<std::string>("ph") == "X");
+        CHECK(e.value<double>("dur") >= 0.0);
+        if (e.value<std::string>("name").rfind("leaf (", 0) == 0) {
+            nLeaf++;
+        }
+    }
+    CHECK(nLeaf == 10);
+}
+
+TEST_CASE("LuaProfiler: Restores State", "[luaprofiler]") {
+    using ghoul::lua::LuaState;
+    LuaState state(
+        LuaState::IncludeStandardLibrary::Yes,
+        LuaState::StrictState::No,
+        LuaState::PooledAllocator::Yes
+    );
+    const ghoul::lua::LuaAllocator* allocator =
+        ghoul::lua::LuaAllocator::fromState(state);
+    REQUIRE(allocator);
+
+    {
+        LuaProfiler profiler(state);
+        profiler.start();
+        CHECK(ghoul::lua::LuaAllocator::fromState(state) == nullptr);
+        ghoul::lua::runScript(state, Functions);
+        // The destructor stops the profiler
+    }
+    CHECK(ghoul::lua::LuaAllocator::fromState(state) == allocator);
+    CHECK(lua_gethook(state) == nullptr);
+
+    // Another profiler can be started once the first one is gone
+    LuaProfiler profiler(state);
+    profiler.start();
+    ghoul::lua::runScript(state, "leaf()");
+    profiler.stop();
+    CHECK(find(profiler.statistics(), "leaf")->nCalls == 1);
+}
+
+TEST_CASE("LuaProfiler: Benchmark", "[.][benchmark][luaprofiler]") {
+    ghoul::lua::LuaState state;
+    ghoul::lua::runScript(state, Functions);
+
+    BENCHMARK("without profiler") {
+        ghoul::lua::runScript(state, "Result = middle() + fact(10)");
+    };
+
+    LuaProfiler profiler(state);
+    profiler.start();
+    BENCHMARK("with profiler") {
+        ghoul::lua::runScript(state, "Result = middle() + fact(10)");
+    };
+    profiler.stop();
+
+    LuaProfiler tracer(state, LuaProfiler::RecordTrace::Yes);
+    tracer.start();
+    BENCHMARK("with profiler and trace") {
+        ghoul::lua::runScript(state, "Result = middle() + fact(10)");
+    };
+    tracer.stop();
+}
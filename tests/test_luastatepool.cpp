@@ -0,0 +1,177 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/lua/lua_helper.h>
+#include <ghoul/lua/luastatepool.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/threadpool.h>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    std::vector<std::filesystem::path> testFiles() {
+        std::vector<std::filesystem::path> res;
+        for (int i = 1; i <= 5; ++i) {
+            res.push_back(
+                absPath(fmt::format("${{UNIT_TEST}}/luatodictionary/test{}.cfg", i))
+            );
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("LuaStatePool: Checkout", "[luastatepool]") {
+    ghoul::lua::LuaStatePool pool(2);
+    CHECK(pool.nIdleStates() == 2);
+
+    lua_State* first = nullptr;
+    {
+        ghoul::lua::LuaStatePool::Handle handle = pool.checkout();
+        first = handle;
+        REQUIRE(first != nullptr);
+        CHECK(pool.nIdleStates() == 1);
+
+        // Leaving values on the stack must not leak them to the next user of the state
+        lua_pushnumber(handle, 1.0);
+        lua_pushnumber(handle, 2.0);
+
+        ghoul::lua::LuaStatePool::Handle second = pool.checkout();
+        CHECK(static_cast<lua_State*>(second) != first);
+        CHECK(pool.nIdleStates() == 0);
+
+        // Checking out more states than are idle creates new ones
+        ghoul::lua::LuaStatePool::Handle third = pool.checkout();
+        CHECK(static_cast<lua_State*>(third) != nullptr);
+        CHECK(pool.nIdleStates() == 0);
+    }
+    CHECK(pool.nIdleStates() == 3);
+
+    // Moving a Handle transfers the ownership of the state
+    ghoul::lua::LuaStatePool::Handle handle = pool.checkout();
+    ghoul::lua::LuaStatePool::Handle moved = std::move(handle);
+    CHECK(pool.nIdleStates() == 2);
+    moved = ghoul::lua::LuaStatePool::Handle();
+    CHECK(pool.nIdleStates() == 3);
+
+    ghoul::lua::LuaStatePool::Handle reused = pool.checkout();
+    CHECK(lua_gettop(reused) == 0);
+
+    pool.clear();
+    CHECK(pool.nIdleStates() == 0);
+}
+
+TEST_CASE("LuaStatePool: Load Dictionaries", "[luastatepool]") {
+    const std::vector<std::filesystem::path> files = testFiles();
+
+    std::vector<ghoul::Dictionary> expected;
+    for (const std::filesystem::path& file : files) {
+        expected.push_back(ghoul::lua::loadDictionaryFromFile(file.string()));
+    }
+
+    ghoul::ThreadPool threadPool(4);
+    ghoul::lua::LuaStatePool statePool;
+
+    // Load every file multiple times to make the tasks overlap
+    std::vector<std::filesystem::path> repeated;
+    for (int i = 0; i < 20; ++i) {
+        repeated.insert(repeated.end(), files.begin(), files.end());
+    }
+    std::vector<ghoul::Dictionary> res = ghoul::lua::loadDictionariesFromFiles(
+        repeated,
+        threadPool,
+        &statePool
+    );
+    REQUIRE(res.size() == repeated.size());
+    for (size_t i = 0; i < res.size(); ++i) {
+        CHECK(res[i] == expected[i % expected.size()]);
+    }
+    // No more states are created than there are tasks running at the same time
+    CHECK(statePool.nIdleStates() <= 4);
+
+    // The implicit global pool is used if no pool is passed
+    std::vector<ghoul::Dictionary> global = ghoul::lua::loadDictionariesFromFiles(
+        files,
+        threadPool
+    );
+    CHECK(global == expected);
+
+    CHECK(ghoul::lua::loadDictionariesFromFiles({}, threadPool).empty());
+}
+
+TEST_CASE("LuaStatePool: Load Dictionaries Error", "[luastatepool]") {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "ghoul_test_luastatepool";
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path broken = directory / "broken.lua";
+    {
+        std::ofstream file(broken);
+        file << "return { a = ";
+    }
+
+    std::vector<std::filesystem::path> files = testFiles();
+    files.insert(files.begin() + 2, broken);
+
+    ghoul::ThreadPool threadPool(2);
+    ghoul::lua::LuaStatePool statePool;
+    CHECK_THROWS_AS(
+        ghoul::lua::loadDictionariesFromFiles(files, threadPool, &statePool),
+        ghoul::lua::LuaLoadingException
+    );
+
+    // The states of the failed and the successful tasks are available again
+    ghoul::lua::LuaStatePool::Handle handle = statePool.checkout();
+    CHECK(lua_gettop(handle) == 0);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("LuaStatePool: Benchmark", "[.][benchmark][luastatepool]") {
+    std::vector<std::filesystem::path> files;
+    for (int i = 0; i < 100; ++i) {
+        const std::vector<std::filesystem::path> f = testFiles();
+        files.insert(files.end(), f.begin(), f.end());
+    }
+
+    ghoul::lua::LuaState state;
+    BENCHMARK("serial") {
+        std::vector<ghoul::Dictionary> res;
+        for (const std::filesystem::path& file : files) {
+            res.push_back(ghoul::lua::loadDictionaryFromFile(file.string(), state));
+        }
+        return res.size();
+    };
+
+    ghoul::ThreadPool threadPool(4);
+    ghoul::lua::LuaStatePool statePool(4);
+    BENCHMARK("parallel") {
+        using namespace ghoul::lua;
+        return loadDictionariesFromFiles(files, threadPool, &statePool).size();
+    };
+}
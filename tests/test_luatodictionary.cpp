@@ -30,7 +30,9 @@
 #include <ghoul/lua/luastate.h>
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/glm.h>
+#include <chrono>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <iostream>
 
@@ -106,3 +108,205 @@ TEST_CASE("LuaToDictionary: Nested Tables 2", "[luatodictionary]") {
     ghoul::Dictionary d = ghoul::lua::value<ghoul::Dictionary>(state);
     CHECK(d.hasValue<ghoul::Dictionary>("Server"));
 }
+
+TEST_CASE("LuaToDictionary: Memory Resource", "[luatodictionary]") {
+    constexpr const char* TestString = R"(
+        glob = {
+            A = {
+                B = { "a", "b" },
+                C = { D = 1, E = true }
+            }
+        }
+)";
+
+    ghoul::lua::LuaState state;
+    ghoul::lua::runScript(state, TestString);
+    lua_getglobal(state, "glob");
+
+    // Nested tables are converted using the memory resource of the target Dictionary
+    class Resource : public pmr::memory_resource {
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+    Resource resource;
+    ghoul::Dictionary dict(&resource);
+    ghoul::lua::luaDictionaryFromState(state, dict);
+    REQUIRE(dict.subDictionary("A.B"));
+    CHECK(dict.subDictionary("A.B")->memoryResource() == &resource);
+    CHECK(dict.value<std::string>("A.B.2") == "b");
+    CHECK(dict.value<double>("A.C.D") == 1.0);
+    CHECK(dict.value<bool>("A.C.E"));
+}
+
+TEST_CASE("LuaToDictionary: Benchmark", "[.][benchmark][luatodictionary]") {
+    constexpr int NEntries = 100000;
+
+    ghoul::lua::LuaState state;
+    for (int i = 1; i <= 5; ++i) {
+        const std::filesystem::path file =
+            absPath(fmt::format("${{UNIT_TEST}}/luatodictionary/test{}.cfg", i));
+
+        // Scale each fixture up to a table that contains NEntries copies of it
+        ghoul::lua::runScript(
+            state,
+            fmt::format(
+                "local f = loadfile([[{}]]) Table = {{}} "
+                "for i = 1, {} do Table[i] = f() end",
+                file.string(), NEntries
+            )
+        );
+        lua_getglobal(state, "Table");
+
+        BENCHMARK(fmt::format("test{}.cfg x {}", i, NEntries)) {
+            return ghoul::lua::luaDictionaryFromState(state).size();
+        };
+
+        lua_settop(state, 0);
+    }
+}
+
+TEST_CASE("LuaToDictionary: Bytecode Cache", "[luatodictionary]") {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "ghoul_test_bytecode_cache";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "cache");
+    FileSys.createCacheManager(directory / "cache");
+    ghoul::lua::setBytecodeCacheEnabled(true);
+
+    const std::filesystem::path script = directory / "script.lua";
+    // Every version of the script gets a distinct modification time, even if the file
+    // system only stores the time with a coarse resolution
+    using Time = std::filesystem::file_time_type;
+    const Time now = Time::clock::now();
+    int version = 0;
+    auto writeScript = [&](const std::string& content) {
+        {
+            std::ofstream file(script);
+            file << content;
+        }
+        version++;
+        const Time time = now + std::chrono::seconds(10 * version);
+        std::filesystem::last_write_time(script, time);
+    };
+    auto cachedFiles = [&directory]() {
+        std::vector<std::filesystem::path> res;
+        namespace fs = std::filesystem;
+        for (const fs::directory_entry& e : fs::recursive_directory_iterator(directory)) {
+            if (e.is_regular_file() && e.path().filename() == "script.lua" &&
+                e.path() != directory / "script.lua")
+            {
+                res.push_back(e.path());
+            }
+        }
+        return res;
+    };
+
+    writeScript("return { a = 1, b = { 'c', 'd' } }");
+    ghoul::Dictionary first = ghoul::lua::loadDictionaryFromFile(script.string());
+    CHECK(first.value<double>("a") == 1.0);
+    CHECK(cachedFiles().size() == 1);
+
+    // The second load uses the cached bytecode
+    ghoul::Dictionary second = ghoul::lua::loadDictionaryFromFile(script.string());
+    CHECK(second == first);
+    CHECK(cachedFiles().size() == 1);
+
+    // Modifying the script invalidates the cached bytecode, which is replaced
+    writeScript("return { a = 2, b = { 'c', 'd' } }");
+    ghoul::Dictionary third = ghoul::lua::loadDictionaryFromFile(script.string());
+    CHECK(third.value<double>("a") == 2.0);
+    CHECK(cachedFiles().size() == 1);
+
+    // Valid bytecode with a header that belongs to a different script is not used
+    const std::filesystem::path cached = cachedFiles().front();
+    auto readCached = [&cached]() {
+        std::ifstream file(cached, std::ifstream::binary);
+        return std::string(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        );
+    };
+    const std::string previous = readCached();
+    const size_t headerEnd = previous.find('\n');
+    REQUIRE(headerEnd != std::string::npos);
+    writeScript("return { a = 3, b = { 'c', 'd' } }");
+    ghoul::Dictionary foreign = ghoul::lua::loadDictionaryFromFile(script.string());
+    CHECK(foreign.value<double>("a") == 3.0);
+    const std::string current = readCached();
+    {
+        std::ofstream file(cached, std::ofstream::binary);
+        file << "GhoulLuaBytecode|/other/script.lua|0|0|0\n";
+        file << previous.substr(headerEnd + 1);
+    }
+    ghoul::Dictionary recompiled = ghoul::lua::loadDictionaryFromFile(script.string());
+    CHECK(recompiled == foreign);
+    CHECK(readCached() == current);
+    CHECK(cachedFiles().size() == 1);
+
+    // Damaged bytecode is replaced by compiling the script again
+    for (const std::filesystem::path& p : cachedFiles()) {
+        std::ofstream file(p, std::ofstream::binary);
+        file << "\x1bLua damaged";
+    }
+    ghoul::Dictionary fourth = ghoul::lua::loadDictionaryFromFile(script.string());
+    CHECK(fourth == recompiled);
+
+    ghoul::lua::LuaState state;
+    writeScript("Value = 42");
+    ghoul::lua::runScriptFile(state, script);
+    ghoul::lua::runScriptFile(state, script);
+    lua_getglobal(state, "Value");
+    CHECK(ghoul::lua::value<double>(state) == 42.0);
+
+    ghoul::lua::setBytecodeCacheEnabled(false);
+    FileSys.destroyCacheManager();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("LuaToDictionary: Benchmark Bytecode Cache",
+          "[.][benchmark][luatodictionary]")
+{
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "ghoul_benchmark_bytecode_cache";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "cache");
+    FileSys.createCacheManager(directory / "cache");
+
+    // A script that is expensive to parse, but cheap to run
+    const std::filesystem::path script = directory / "script.lua";
+    {
+        std::ofstream file(script);
+        file << "return {\n";
+        for (int i = 0; i < 10000; ++i) {
+            file << fmt::format(
+                "  Entry{0} = {{ Name = 'Entry {0}', Value = {0} }},\n", i
+            );
+        }
+        file << "}\n";
+    }
+
+    ghoul::lua::LuaState state;
+    BENCHMARK("runScriptFile (source)") {
+        ghoul::lua::runScriptFile(state, script);
+        lua_settop(state, 0);
+    };
+
+    ghoul::lua::setBytecodeCacheEnabled(true);
+    BENCHMARK("runScriptFile (bytecode cache)") {
+        ghoul::lua::runScriptFile(state, script);
+        lua_settop(state, 0);
+    };
+    ghoul::lua::setBytecodeCacheEnabled(false);
+
+    FileSys.destroyCacheManager();
+    std::filesystem::remove_all(directory);
+}
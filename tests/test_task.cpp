@@ -0,0 +1,180 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/misc/exception.h>
+#include <ghoul/misc/task.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <thread>
+
+TEST_CASE("Task: Inline Storage", "[task]") {
+    int value = 0;
+    auto small = [&value]() { value++; };
+    STATIC_REQUIRE(ghoul::Task::isStoredInline<decltype(small)>());
+
+    std::array<char, 2 * ghoul::Task::InlineSize> buffer = {};
+    auto large = [buffer, &value]() { value += static_cast<int>(buffer.size()); };
+    STATIC_REQUIRE_FALSE(ghoul::Task::isStoredInline<decltype(large)>());
+
+    ghoul::Task t1(small);
+    ghoul::Task t2(large);
+    REQUIRE(t1);
+    REQUIRE(t2);
+    t1();
+    t2();
+    CHECK(value == 1 + 2 * static_cast<int>(ghoul::Task::InlineSize));
+}
+
+TEST_CASE("Task: Move Only", "[task]") {
+    auto ptr = std::make_unique<int>(5);
+    int result = 0;
+    ghoul::Task t1([p = std::move(ptr), &result]() { result = *p; });
+
+    ghoul::Task t2(std::move(t1));
+    CHECK_FALSE(t1);
+    REQUIRE(t2);
+
+    ghoul::Task t3;
+    CHECK_FALSE(t3);
+    t3 = std::move(t2);
+    CHECK_FALSE(t2);
+    REQUIRE(t3);
+
+    t3();
+    CHECK(result == 5);
+}
+
+TEST_CASE("Task: Destroys Callable", "[task]") {
+    auto ptr = std::make_shared<int>(1);
+    {
+        ghoul::Task t([ptr]() {});
+        CHECK(ptr.use_count() == 2);
+        ghoul::Task t2(std::move(t));
+        CHECK(ptr.use_count() == 2);
+    }
+    CHECK(ptr.use_count() == 1);
+}
+
+TEST_CASE("TaskFuture: Value", "[task]") {
+    ghoul::TaskPromise<std::string> promise;
+    ghoul::TaskFuture<std::string> future = promise.future();
+    REQUIRE(future.isValid());
+    CHECK_FALSE(future.isReady());
+
+    std::thread t([p = std::move(promise)]() mutable { p.setValue("abc"); });
+    CHECK(future.get() == "abc");
+    CHECK_FALSE(future.isValid());
+    t.join();
+}
+
+TEST_CASE("TaskFuture: Void", "[task]") {
+    ghoul::TaskPromise<void> promise;
+    ghoul::TaskFuture<void> future = promise.future();
+    promise.setValue();
+    CHECK(future.isReady());
+    CHECK_NOTHROW(future.get());
+}
+
+TEST_CASE("TaskFuture: Exception", "[task]") {
+    ghoul::TaskPromise<int> promise;
+    ghoul::TaskFuture<int> future = promise.future();
+    promise.setException(std::make_exception_ptr(std::logic_error("error")));
+    CHECK_THROWS_AS(future.get(), std::logic_error);
+}
+
+TEST_CASE("TaskFuture: Broken Promise", "[task]") {
+    ghoul::TaskFuture<int> future;
+    {
+        ghoul::TaskPromise<int> promise;
+        future = promise.future();
+    }
+    REQUIRE(future.isReady());
+    CHECK_THROWS_AS(future.get(), ghoul::RuntimeError);
+}
+
+TEST_CASE("TaskFuture: Recycled State", "[task]") {
+    // The shared states are reused, so a stale value must never leak into a new future
+    for (int i = 0; i < 10; ++i) {
+        ghoul::TaskPromise<int> promise;
+        ghoul::TaskFuture<int> future = promise.future();
+        CHECK_FALSE(future.isReady());
+        promise.setValue(i);
+        CHECK(future.get() == i);
+    }
+}
+
+TEST_CASE("TaskFuture: Then Inline", "[task]") {
+    ghoul::TaskPromise<int> promise;
+    ghoul::TaskFuture<std::string> future = promise.future()
+        .then([](int v) { return v * 2; })
+        .then([](int v) { return std::to_string(v); });
+    CHECK_FALSE(future.isReady());
+
+    // Without a ThreadPool, the continuations run on the thread that sets the value
+    promise.setValue(21);
+    REQUIRE(future.isReady());
+    CHECK(future.get() == "42");
+}
+
+TEST_CASE("TaskFuture: Then Ready", "[task]") {
+    ghoul::TaskPromise<void> promise;
+    ghoul::TaskFuture<void> future = promise.future();
+    promise.setValue();
+
+    bool hasRun = false;
+    ghoul::TaskFuture<void> f = future.then([&hasRun]() { hasRun = true; });
+    CHECK_FALSE(future.isValid());
+    CHECK(hasRun);
+    CHECK_NOTHROW(f.get());
+}
+
+TEST_CASE("TaskFuture: Then Exception", "[task]") {
+    ghoul::TaskPromise<int> promise;
+    bool hasRun = false;
+    ghoul::TaskFuture<int> future = promise.future().then([&hasRun](int v) {
+        hasRun = true;
+        return v;
+    });
+    promise.setException(std::make_exception_ptr(std::logic_error("error")));
+
+    CHECK_FALSE(hasRun);
+    CHECK_THROWS_AS(future.get(), std::logic_error);
+}
+
+TEST_CASE("TaskDependency: Ready", "[task]") {
+    ghoul::TaskPromise<int> promise;
+    ghoul::TaskFuture<int> future = promise.future();
+    ghoul::TaskDependency dependency = future;
+    CHECK_FALSE(dependency.isReady());
+
+    promise.setValue(1);
+    CHECK(dependency.isReady());
+    // The dependency does not consume the value
+    CHECK(future.get() == 1);
+    CHECK(dependency.isReady());
+}
@@ -0,0 +1,973 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/misc/coroutinetask.h>
+#include <ghoul/misc/exception.h>
+#include <ghoul/misc/threadpool.h>
+#include <ghoul/misc/workstealingqueue.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Recursively spawns tasks from within the Workers until depth reaches 0
+    void spawnTasks(ghoul::ThreadPool& pool, std::atomic_int& counter, int depth) {
+        counter++;
+        if (depth == 0) {
+            return;
+        }
+        pool.queue([&pool, &counter, depth]() { spawnTasks(pool, counter, depth - 1); });
+        pool.queue([&pool, &counter, depth]() { spawnTasks(pool, counter, depth - 1); });
+    }
+
+    // 2 cache groups with 2 cores each and 2 hardware threads per core, numbered like
+    // on Linux, where the second hardware threads of all cores come last
+    ghoul::thread::CpuTopology exampleTopology() {
+        ghoul::thread::CpuTopology topology;
+        for (int id = 0; id < 8; ++id) {
+            ghoul::thread::LogicalCpu cpu;
+            cpu.id = id;
+            cpu.core = id % 4;
+            cpu.package = 0;
+            cpu.cacheGroup = (id % 4) / 2;
+            topology.cpus.push_back(cpu);
+        }
+        return topology;
+    }
+
+    // Stands in for a coroutine handle so that ThreadPool::schedule can be tested
+    // without C++20
+    struct RecordingHandle {
+        void resume() {
+            threadId->set_value(std::this_thread::get_id());
+        }
+
+        std::promise<std::thread::id>* threadId;
+    };
+
+#ifdef GHOUL_HAS_COROUTINES
+    ghoul::CoroutineTask<std::thread::id> threadIdOnPool(ghoul::ThreadPool& pool) {
+        co_await pool.schedule();
+        co_return std::this_thread::get_id();
+    }
+
+    ghoul::CoroutineTask<int> square(ghoul::ThreadPool& pool, int value) {
+        co_await pool.schedule();
+        co_return value * value;
+    }
+
+    ghoul::CoroutineTask<int> sumOfSquares(ghoul::ThreadPool& pool, int n) {
+        int sum = 0;
+        for (int i = 1; i <= n; ++i) {
+            sum += co_await square(pool, i);
+        }
+        co_return sum;
+    }
+
+    ghoul::CoroutineTask<int> throwing(ghoul::ThreadPool& pool) {
+        co_await pool.schedule();
+        throw std::runtime_error("error");
+    }
+
+    ghoul::CoroutineTask<int> catching(ghoul::ThreadPool& pool) {
+        try {
+            co_await throwing(pool);
+        }
+        catch (const std::runtime_error&) {
+            co_return 1;
+        }
+        co_return 0;
+    }
+
+    ghoul::CoroutineTask<int> immediate(int value) {
+        co_return value;
+    }
+
+    // Awaits many coroutines that finish synchronously one after another
+    ghoul::CoroutineTask<int> longChain(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; ++i) {
+            sum += co_await immediate(1);
+        }
+        co_return sum;
+    }
+#endif // GHOUL_HAS_COROUTINES
+
+    void writeFile(const std::filesystem::path& path, const std::string& content) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path);
+        file << content << '\n';
+    }
+} // namespace
+
+TEST_CASE("WorkStealingQueue: Push Pop", "[threadpool]") {
+    ghoul::WorkStealingQueue<int> queue;
+    CHECK(queue.isEmpty());
+    CHECK(queue.pop() == nullptr);
+    CHECK(queue.steal() == nullptr);
+
+    queue.push(new int(1));
+    queue.push(new int(2));
+    queue.push(new int(3));
+    CHECK(queue.size() == 3);
+
+    // The owner pops from the bottom
+    int* i = queue.pop();
+    REQUIRE(i);
+    CHECK(*i == 3);
+    delete i;
+
+    // Thieves steal from the top
+    i = queue.steal();
+    REQUIRE(i);
+    CHECK(*i == 1);
+    delete i;
+
+    i = queue.pop();
+    REQUIRE(i);
+    CHECK(*i == 2);
+    delete i;
+
+    CHECK(queue.isEmpty());
+}
+
+TEST_CASE("WorkStealingQueue: Grow", "[threadpool]") {
+    ghoul::WorkStealingQueue<int> queue(2);
+    for (int i = 0; i < 100; ++i) {
+        queue.push(new int(i));
+    }
+    CHECK(queue.size() == 100);
+
+    for (int i = 0; i < 100; ++i) {
+        int* v = queue.steal();
+        REQUIRE(v);
+        CHECK(*v == i);
+        delete v;
+    }
+    CHECK(queue.isEmpty());
+}
+
+TEST_CASE("WorkStealingQueue: Concurrent Steal", "[threadpool]") {
+    constexpr const int NItems = 10000;
+    ghoul::WorkStealingQueue<int> queue;
+    std::atomic_int sum = 0;
+    std::atomic_bool done = false;
+
+    auto thief = [&]() {
+        while (!done || !queue.isEmpty()) {
+            if (int* v = queue.steal()) {
+                sum += *v;
+                delete v;
+            }
+        }
+    };
+    std::thread t1(thief);
+    std::thread t2(thief);
+
+    for (int i = 0; i < NItems; ++i) {
+        queue.push(new int(1));
+        if (i % 3 == 0) {
+            if (int* v = queue.pop()) {
+                sum += *v;
+                delete v;
+            }
+        }
+    }
+    done = true;
+    t1.join();
+    t2.join();
+
+    CHECK(sum == NItems);
+}
+
+TEST_CASE("ThreadPool: Queue", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(pool.queue([](int v) { return v * 2; }, i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        CHECK(futures[i].get() == i * 2);
+    }
+    pool.stop();
+    CHECK(pool.remainingTasks() == 0);
+}
+
+TEST_CASE("ThreadPool: WorkStealing Nested Tasks", "[threadpool]") {
+    ghoul::ThreadPool pool(
+        4,
+        []() {},
+        []() {},
+        ghoul::thread::ThreadPriorityClass::Normal,
+        ghoul::thread::ThreadPriorityLevel::Normal,
+        ghoul::thread::Background::No,
+        ghoul::ThreadPool::WorkStealing::Yes
+    );
+    CHECK(pool.isWorkStealing());
+
+    std::atomic_int counter = 0;
+    constexpr const int Depth = 12;
+    pool.queue([&pool, &counter]() { spawnTasks(pool, counter, Depth); });
+    pool.stop();
+
+    // A full binary tree of depth 12 has 2^13 - 1 nodes
+    CHECK(counter == (1 << (Depth + 1)) - 1);
+    CHECK(pool.remainingTasks() == 0);
+}
+
+TEST_CASE("ThreadPool: Wake Statistics", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+
+    for (int i = 0; i < 10; ++i) {
+        // Give the Workers time to go to sleep before queueing the next task
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        pool.queue([]() {}).get();
+    }
+
+    const ghoul::ThreadPool::WakeStatistics stats = pool.wakeStatistics();
+    CHECK(stats.nWakeups > 0);
+    CHECK(stats.maxLatency <= stats.totalLatency);
+    // Without the polling, a woken Worker should be much faster than any timeout
+    CHECK(stats.maxLatency < std::chrono::milliseconds(500));
+
+    pool.resetWakeStatistics();
+    CHECK(pool.wakeStatistics().nWakeups == 0);
+}
+
+TEST_CASE("ThreadPool: Statistics Disabled", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+    CHECK_FALSE(pool.isStatisticsEnabled());
+
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([]() {}).get();
+    }
+
+    const ghoul::ThreadPool::Statistics stats = pool.statistics();
+    CHECK(stats.nTasks == 0);
+    CHECK(stats.execution.count == 0);
+    CHECK(stats.queueWait.count == 0);
+    REQUIRE(stats.workers.size() == 2);
+    CHECK(stats.workers[0].busyTime.count() == 0);
+}
+
+TEST_CASE("ThreadPool: Statistics", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+    pool.setStatisticsEnabled(true);
+    CHECK(pool.isStatisticsEnabled());
+
+    // Block both Workers so that the following tasks pile up in the queue
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<ghoul::TaskFuture<void>> futures;
+    for (int i = 0; i < 2; ++i) {
+        futures.push_back(pool.submit([released]() { released.wait(); }));
+    }
+    for (int i = 0; i < 20; ++i) {
+        futures.push_back(pool.submit([]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }));
+    }
+    release.set_value();
+    for (ghoul::TaskFuture<void>& f : futures) {
+        f.get();
+    }
+
+    // Stopping the pool lets the Workers finish the bookkeeping of the last tasks, and
+    // the statistics are kept after the pool is stopped
+    pool.stop();
+
+    const ghoul::ThreadPool::Statistics stats = pool.statistics();
+    CHECK(stats.nTasks == 22);
+    CHECK(stats.execution.count == 22);
+    CHECK(stats.queueWait.count == 22);
+    CHECK(stats.peakQueueDepth >= 20);
+    CHECK(stats.execution.max >= std::chrono::microseconds(100));
+    CHECK(stats.execution.mean() >= std::chrono::microseconds(100));
+    CHECK(stats.execution.percentile(0.5) >= std::chrono::microseconds(100));
+    CHECK(stats.execution.percentile(1.0) == stats.execution.max);
+
+    REQUIRE(stats.workers.size() == 2);
+    uint64_t nTasks = 0;
+    std::chrono::nanoseconds busyTime = std::chrono::nanoseconds(0);
+    for (const ghoul::ThreadPool::WorkerStatistics& w : stats.workers) {
+        nTasks += w.nTasks;
+        busyTime += w.busyTime;
+    }
+    CHECK(nTasks == 22);
+    CHECK(busyTime == stats.execution.total);
+
+    pool.resetStatistics();
+    const ghoul::ThreadPool::Statistics reset = pool.statistics();
+    CHECK(reset.nTasks == 0);
+    CHECK(reset.execution.count == 0);
+    CHECK(reset.peakQueueDepth == 0);
+}
+
+TEST_CASE("ThreadPool: Statistics Resize", "[threadpool]") {
+    ghoul::ThreadPool pool(3);
+    pool.setStatisticsEnabled(true);
+
+    for (int i = 0; i < 30; ++i) {
+        pool.submit([]() {}).get();
+    }
+    pool.stop();
+
+    // The tasks of the removed Workers are still part of the totals
+    pool.resize(1);
+    const ghoul::ThreadPool::Statistics stats = pool.statistics();
+    CHECK(stats.workers.size() == 1);
+    CHECK(stats.nTasks == 30);
+
+    pool.resetStatistics();
+    CHECK(pool.statistics().nTasks == 0);
+}
+
+TEST_CASE("ThreadPool: Statistics Work Stealing", "[threadpool]") {
+    ghoul::ThreadPool pool(
+        4,
+        []() {},
+        []() {},
+        ghoul::thread::ThreadPriorityClass::Normal,
+        ghoul::thread::ThreadPriorityLevel::Normal,
+        ghoul::thread::Background::No,
+        ghoul::ThreadPool::WorkStealing::Yes
+    );
+    pool.setStatisticsEnabled(true);
+
+    // A single task spawns many tasks into its Worker's own queue, from which the other
+    // Workers have to steal
+    std::atomic_int counter = 0;
+    pool.submit([&pool, &counter]() {
+        for (int i = 0; i < 200; ++i) {
+            pool.submit([&counter]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                counter++;
+            });
+        }
+    }).get();
+    pool.stop();
+    REQUIRE(counter == 200);
+
+    const ghoul::ThreadPool::Statistics stats = pool.statistics();
+    CHECK(stats.nTasks == 201);
+    CHECK(stats.queueWait.count == 201);
+    CHECK(stats.nSteals > 0);
+
+    int peakQueueDepth = 0;
+    for (const ghoul::ThreadPool::WorkerStatistics& w : stats.workers) {
+        peakQueueDepth = std::max(peakQueueDepth, w.peakQueueDepth);
+    }
+    CHECK(peakQueueDepth > 1);
+}
+
+TEST_CASE("ThreadPool: Histogram", "[threadpool]") {
+    ghoul::ThreadPool::Histogram histogram;
+    CHECK(histogram.mean().count() == 0);
+    CHECK(histogram.percentile(0.5).count() == 0);
+
+    // 3 durations of ~1000 ns and one of ~1000000 ns
+    histogram.buckets[9] = 3;
+    histogram.buckets[19] = 1;
+    histogram.count = 4;
+    histogram.total = std::chrono::nanoseconds(3 * 1000 + 1000000);
+    histogram.max = std::chrono::nanoseconds(1000000);
+
+    CHECK(histogram.mean() == std::chrono::nanoseconds(250750));
+    CHECK(histogram.percentile(0.5) == std::chrono::nanoseconds(1024));
+    CHECK(histogram.percentile(0.75) == std::chrono::nanoseconds(1024));
+    CHECK(histogram.percentile(0.99) == std::chrono::nanoseconds(1000000));
+}
+
+TEST_CASE("Thread: CpuTopology From Directory", "[threadpool]") {
+    // Recreate the example topology in the layout of /sys/devices/system/cpu
+    const std::filesystem::path root =
+        std::filesystem::temp_directory_path() / "ghoul_test_cputopology";
+    std::filesystem::remove_all(root);
+    writeFile(root / "online", "0-7");
+    for (int id = 0; id < 8; ++id) {
+        const std::filesystem::path cpu = root / ("cpu" + std::to_string(id));
+        writeFile(cpu / "topology" / "core_id", std::to_string(id % 4));
+        writeFile(cpu / "topology" / "physical_package_id", "0");
+        writeFile(cpu / "cache" / "index0" / "level", "1");
+        writeFile(
+            cpu / "cache" / "index0" / "shared_cpu_list",
+            std::to_string(id % 4) + "," + std::to_string(id % 4 + 4)
+        );
+        writeFile(cpu / "cache" / "index3" / "level", "3");
+        writeFile(
+            cpu / "cache" / "index3" / "shared_cpu_list",
+            (id % 4) < 2 ? "0-1,4-5" : "2-3,6-7"
+        );
+    }
+
+    const ghoul::thread::CpuTopology topology = ghoul::thread::cpuTopology(root);
+    std::filesystem::remove_all(root);
+
+    REQUIRE(topology.cpus.size() == 8);
+    CHECK(topology.nPhysicalCores() == 4);
+    CHECK(topology.nCacheGroups() == 2);
+    for (int id = 0; id < 8; ++id) {
+        CHECK(topology.cpus[id].id == id);
+    }
+    CHECK(topology.cpus[0].core == topology.cpus[4].core);
+    CHECK(topology.cpus[0].core != topology.cpus[1].core);
+    CHECK(topology.cpus[0].cacheGroup == topology.cpus[5].cacheGroup);
+    CHECK(topology.cpus[0].cacheGroup != topology.cpus[2].cacheGroup);
+
+    CHECK_THROWS_AS(
+        ghoul::thread::cpuTopology(root / "does-not-exist"),
+        ghoul::RuntimeError
+    );
+}
+
+TEST_CASE("Thread: CpuTopology", "[threadpool]") {
+    const ghoul::thread::CpuTopology topology = ghoul::thread::cpuTopology();
+    REQUIRE_FALSE(topology.cpus.empty());
+    CHECK(topology.nPhysicalCores() >= 1);
+    CHECK(topology.nPhysicalCores() <= static_cast<int>(topology.cpus.size()));
+
+    std::set<int> ids;
+    for (const ghoul::thread::LogicalCpu& cpu : topology.cpus) {
+        ids.insert(cpu.id);
+    }
+    CHECK(ids.size() == topology.cpus.size());
+
+    // Pinning a thread to all available CPUs must always work
+    std::vector<int> cpus(ids.begin(), ids.end());
+    std::thread t([]() {});
+    CHECK_NOTHROW(ghoul::thread::setAffinity(t, cpus));
+    t.join();
+}
+
+TEST_CASE("ThreadPool: Placement", "[threadpool]") {
+    using Placement = ghoul::ThreadPool::Placement;
+    using PhysicalCoresOnly = ghoul::ThreadPool::PhysicalCoresOnly;
+    using Cpus = std::vector<std::vector<int>>;
+    const ghoul::thread::CpuTopology topology = exampleTopology();
+
+    CHECK(Placement().workerCpus(topology).empty());
+
+    CHECK(
+        Placement(Placement::Strategy::Compact).workerCpus(topology) ==
+        Cpus{ { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } }
+    );
+    CHECK(
+        Placement(Placement::Strategy::Spread).workerCpus(topology) ==
+        Cpus{ { 0, 4 }, { 2, 6 }, { 1, 5 }, { 3, 7 } }
+    );
+    CHECK(
+        Placement(Placement::Strategy::Compact, PhysicalCoresOnly::No)
+            .workerCpus(topology) ==
+        Cpus{ { 0 }, { 4 }, { 1 }, { 5 }, { 2 }, { 6 }, { 3 }, { 7 } }
+    );
+    CHECK(
+        Placement(Placement::Strategy::Spread, PhysicalCoresOnly::No)
+            .workerCpus(topology) ==
+        Cpus{ { 0 }, { 2 }, { 1 }, { 3 }, { 4 }, { 6 }, { 5 }, { 7 } }
+    );
+
+    // Excluding a hardware thread removes its whole core
+    CHECK(
+        Placement(Placement::Strategy::Spread, PhysicalCoresOnly::Yes, { 4 })
+            .workerCpus(topology) ==
+        Cpus{ { 1, 5 }, { 2, 6 }, { 3, 7 } }
+    );
+    CHECK(
+        Placement(Placement::Strategy::Compact, PhysicalCoresOnly::No, { 0, 1 })
+            .workerCpus(topology) ==
+        Cpus{ { 4 }, { 5 }, { 2 }, { 6 }, { 3 }, { 7 } }
+    );
+    CHECK(
+        Placement(Placement::Strategy::Compact, PhysicalCoresOnly::Yes, { 0, 1, 2, 3 })
+            .workerCpus(topology)
+            .empty()
+    );
+}
+
+TEST_CASE("ThreadPool: Set Placement", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+    pool.setPlacement(ghoul::ThreadPool::Placement(
+        ghoul::ThreadPool::Placement::Strategy::Compact,
+        ghoul::ThreadPool::PhysicalCoresOnly::No
+    ));
+    CHECK(pool.placement().strategy == ghoul::ThreadPool::Placement::Strategy::Compact);
+
+    // The pinned Workers, including the ones added later, still process all tasks
+    pool.resize(4);
+    std::atomic_int counter = 0;
+    std::vector<ghoul::TaskFuture<void>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(pool.submit([&counter]() { counter++; }));
+    }
+    for (ghoul::TaskFuture<void>& f : futures) {
+        f.get();
+    }
+    CHECK(counter == 100);
+
+    pool.setPlacement(ghoul::ThreadPool::Placement());
+    CHECK(pool.submit([]() { return 1; }).get() == 1);
+}
+
+TEST_CASE("ThreadPool: Schedule", "[threadpool]") {
+    ghoul::ThreadPool pool(1);
+    ghoul::ThreadPool::ScheduleOperation operation = pool.schedule();
+    CHECK_FALSE(operation.await_ready());
+
+    // The suspended coroutine is resumed on the Worker
+    std::promise<std::thread::id> threadId;
+    operation.await_suspend(RecordingHandle{ &threadId });
+    CHECK(threadId.get_future().get() != std::this_thread::get_id());
+}
+
+#ifdef GHOUL_HAS_COROUTINES
+TEST_CASE("CoroutineTask: Resumes On Pool", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+    ghoul::CoroutineTask<std::thread::id> task = threadIdOnPool(pool);
+    CHECK(task.isValid());
+    CHECK_FALSE(task.isReady());
+
+    const std::thread::id id = ghoul::spawn(pool, std::move(task)).get();
+    CHECK(id != std::this_thread::get_id());
+}
+
+TEST_CASE("CoroutineTask: Chain", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+    CHECK(ghoul::spawn(pool, sumOfSquares(pool, 10)).get() == 385);
+
+    // Many concurrent chains on a small pool, none of which blocks a Worker
+    std::vector<ghoul::TaskFuture<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(ghoul::spawn(pool, sumOfSquares(pool, 5)));
+    }
+    for (ghoul::TaskFuture<int>& f : futures) {
+        CHECK(f.get() == 55);
+    }
+}
+
+TEST_CASE("CoroutineTask: Exception", "[threadpool]") {
+    ghoul::ThreadPool pool(1);
+    CHECK_THROWS_AS(ghoul::spawn(pool, throwing(pool)).get(), std::runtime_error);
+    CHECK(ghoul::spawn(pool, catching(pool)).get() == 1);
+}
+
+TEST_CASE("CoroutineTask: Long Synchronous Chain", "[threadpool]") {
+    ghoul::ThreadPool pool(1);
+    CHECK(ghoul::spawn(pool, longChain(10000)).get() == 10000);
+}
+#endif // GHOUL_HAS_COROUTINES
+
+TEST_CASE("ThreadPool: Submit", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+
+    std::vector<ghoul::TaskFuture<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(pool.submit([](int v) { return v * 2; }, i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        CHECK(futures[i].get() == i * 2);
+    }
+
+    ghoul::TaskFuture<void> f = pool.submit([]() { throw std::logic_error("error"); });
+    CHECK_THROWS_AS(f.get(), std::logic_error);
+}
+
+TEST_CASE("ThreadPool: Queue Packaged Task", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+    std::packaged_task<int(int, int)> task([](int a, int b) { return a + b; });
+    std::future<int> f = pool.queue(std::move(task), 1, 2);
+    CHECK(f.get() == 3);
+}
+
+TEST_CASE("ThreadPool: Clear Remaining Tasks Breaks Promises", "[threadpool]") {
+    ghoul::ThreadPool pool(1);
+    pool.stop();
+
+    ghoul::TaskFuture<int> f = pool.submit([]() { return 1; });
+    pool.clearRemainingTasks();
+    CHECK_THROWS_AS(f.get(), ghoul::RuntimeError);
+}
+
+TEST_CASE("ThreadPool: SubmitBulk", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+
+    std::vector<std::function<int()>> functions;
+    for (int i = 0; i < 1000; ++i) {
+        functions.push_back([i]() { return i * 2; });
+    }
+    functions[10] = []() -> int { throw std::logic_error("error"); };
+
+    ghoul::ThreadPool::BulkSubmission<int> result = pool.submitBulk(
+        functions.begin(),
+        functions.end()
+    );
+    REQUIRE(result.futures.size() == functions.size());
+
+    // The combined future becomes ready even though one of the tasks failed
+    CHECK_NOTHROW(result.done.get());
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(result.futures[i].isReady());
+        if (i == 10) {
+            CHECK_THROWS_AS(result.futures[i].get(), std::logic_error);
+        }
+        else {
+            CHECK(result.futures[i].get() == i * 2);
+        }
+    }
+}
+
+TEST_CASE("ThreadPool: SubmitBulk Empty", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+
+    std::vector<std::function<void()>> functions;
+    ghoul::ThreadPool::BulkSubmission<void> result = pool.submitBulk(
+        functions.begin(),
+        functions.end()
+    );
+    CHECK(result.futures.empty());
+    CHECK(result.done.isReady());
+}
+
+TEST_CASE("ThreadPool: SubmitBulk Priority", "[threadpool]") {
+    using Priority = ghoul::ThreadPool::Priority;
+
+    ghoul::ThreadPool pool(1);
+    pool.stop();
+
+    std::vector<int> order;
+    std::vector<std::function<void()>> low = {
+        [&order]() { order.push_back(2); },
+        [&order]() { order.push_back(3); }
+    };
+    std::vector<std::function<void()>> high = {
+        [&order]() { order.push_back(0); },
+        [&order]() { order.push_back(1); }
+    };
+    pool.submitBulk(low.begin(), low.end(), Priority::Low);
+    pool.submitBulk(high.begin(), high.end(), Priority::High);
+    CHECK(pool.remainingTasks() == 4);
+
+    pool.start();
+    pool.stop();
+    CHECK(order == std::vector<int>{ 0, 1, 2, 3 });
+}
+
+TEST_CASE("ThreadPool: Benchmark Submission", "[.][benchmark][threadpool]") {
+    // Each benchmark submits NTasks small tasks, so the submissions per second are
+    // NTasks divided by the reported mean time
+    constexpr const int NTasks = 10000;
+    ghoul::ThreadPool pool(4);
+
+    BENCHMARK("queue with std::future (10000 tasks)") {
+        std::vector<std::future<int>> futures;
+        futures.reserve(NTasks);
+        for (int i = 0; i < NTasks; ++i) {
+            futures.push_back(pool.queue([i]() { return i; }));
+        }
+        int sum = 0;
+        for (std::future<int>& f : futures) {
+            sum += f.get();
+        }
+        return sum;
+    };
+
+    BENCHMARK("submit with TaskFuture (10000 tasks)") {
+        std::vector<ghoul::TaskFuture<int>> futures;
+        futures.reserve(NTasks);
+        for (int i = 0; i < NTasks; ++i) {
+            futures.push_back(pool.submit([i]() { return i; }));
+        }
+        int sum = 0;
+        for (ghoul::TaskFuture<int>& f : futures) {
+            sum += f.get();
+        }
+        return sum;
+    };
+
+    BENCHMARK("submitBulk with TaskFuture (10000 tasks)") {
+        auto function = []() { return 1; };
+        std::vector<decltype(function)> functions(NTasks, function);
+        ghoul::ThreadPool::BulkSubmission<int> result = pool.submitBulk(
+            functions.begin(),
+            functions.end()
+        );
+        result.done.wait();
+        int sum = 0;
+        for (ghoul::TaskFuture<int>& f : result.futures) {
+            sum += f.get();
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("ThreadPool: ParallelFor", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+
+    std::vector<int> values(10000, 0);
+    pool.parallelFor(size_t(0), values.size(), size_t(16), [&values](size_t i) {
+        values[i] += static_cast<int>(i);
+    });
+    for (size_t i = 0; i < values.size(); ++i) {
+        REQUIRE(values[i] == static_cast<int>(i));
+    }
+
+    // Empty ranges and ranges smaller than the grain size
+    int count = 0;
+    pool.parallelFor(5, 5, 1, [&count](int) { count++; });
+    CHECK(count == 0);
+    pool.parallelFor(0, 3, 100, [&count](int) { count++; });
+    CHECK(count == 3);
+}
+
+TEST_CASE("ThreadPool: ParallelReduce", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+
+    const int64_t sum = pool.parallelReduce(
+        1, 100001, 64, int64_t(0),
+        [](int i) { return static_cast<int64_t>(i); },
+        [](int64_t a, int64_t b) { return a + b; }
+    );
+    CHECK(sum == int64_t(100000) * 100001 / 2);
+
+    const double max = pool.parallelReduce(
+        0, 1000, 8, 0.0,
+        [](int i) { return static_cast<double>((i * 7919) % 1000); },
+        [](double a, double b) { return std::max(a, b); }
+    );
+    CHECK(max == 999.0);
+}
+
+TEST_CASE("ThreadPool: ParallelFor Exception", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+
+    std::atomic_int count = 0;
+    CHECK_THROWS_AS(
+        pool.parallelFor(0, 10000, 1, [&count](int i) {
+            count++;
+            if (i == 500) {
+                throw std::logic_error("error");
+            }
+        }),
+        std::logic_error
+    );
+    CHECK(count < 10000);
+}
+
+TEST_CASE("ThreadPool: ParallelFor Nested", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+
+    // Every Worker is blocked in an outer task that runs another parallelFor, so the
+    // inner loops can only finish if the calling Workers do the work themselves
+    std::atomic_int count = 0;
+    std::vector<ghoul::TaskFuture<void>> futures;
+    for (int i = 0; i < 8; ++i) {
+        futures.push_back(pool.submit([&pool, &count]() {
+            pool.parallelFor(0, 100, 1, [&pool, &count](int) {
+                pool.parallelFor(0, 10, 1, [&count](int) { count++; });
+            });
+        }));
+    }
+    for (ghoul::TaskFuture<void>& f : futures) {
+        f.get();
+    }
+    CHECK(count == 8 * 100 * 10);
+}
+
+TEST_CASE("ThreadPool: ParallelFor Stopped", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+    pool.stop();
+
+    int count = 0;
+    pool.parallelFor(0, 1000, 10, [&count](int) { count++; });
+    CHECK(count == 1000);
+}
+
+TEST_CASE("ThreadPool: Then", "[threadpool]") {
+    ghoul::ThreadPool pool(2);
+
+    std::thread::id workerId;
+    ghoul::TaskFuture<int> future = pool.submit([]() { return 2; })
+        .then([](int v) { return v + 1; })
+        .then([&workerId](int v) {
+            workerId = std::this_thread::get_id();
+            return v * 10;
+        });
+
+    CHECK(future.get() == 30);
+    // The continuations are executed in the ThreadPool
+    CHECK(workerId != std::this_thread::get_id());
+}
+
+TEST_CASE("ThreadPool: SubmitAfter", "[threadpool]") {
+    ghoul::ThreadPool pool(4);
+
+    // A diamond: a -> (b, c) -> d
+    std::atomic_int a = 0;
+    std::atomic_int bc = 0;
+    ghoul::TaskFuture<int> fa = pool.submit([&a]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        a = 1;
+        return 1;
+    });
+    ghoul::TaskFuture<int> fb = pool.submitAfter({ fa }, [&a, &bc]() {
+        bc += a;
+        return 2;
+    });
+    ghoul::TaskFuture<int> fc = pool.submitAfter({ fa }, [&a, &bc]() {
+        bc += a;
+        return 3;
+    });
+    ghoul::TaskFuture<int> fd = pool.submitAfter({ fb, fc }, [&bc]() { return bc.load(); });
+
+    CHECK(fd.get() == 2);
+    CHECK(fa.get() == 1);
+    CHECK(fb.get() == 2);
+    CHECK(fc.get() == 3);
+}
+
+TEST_CASE("ThreadPool: Task Graph Without Blocking Workers", "[threadpool]") {
+    // With a single Worker, a task that waits for another task would deadlock, but the
+    // continuations are only queued once their inputs are available
+    ghoul::ThreadPool pool(1);
+
+    std::vector<ghoul::TaskFuture<int>> loads;
+    for (int i = 0; i < 10; ++i) {
+        loads.push_back(pool.submit([i]() { return i; }));
+    }
+
+    std::vector<ghoul::TaskDependency> dependencies(loads.begin(), loads.end());
+    std::vector<ghoul::TaskFuture<int>> decodes;
+    for (ghoul::TaskFuture<int>& load : loads) {
+        decodes.push_back(load.then([](int v) { return v * v; }));
+    }
+    ghoul::TaskFuture<void> done = pool.submitAfter(std::move(dependencies), []() {});
+
+    done.get();
+    int sum = 0;
+    for (ghoul::TaskFuture<int>& decode : decodes) {
+        sum += decode.get();
+    }
+    CHECK(sum == 285);
+}
+
+TEST_CASE("ThreadPool: Priorities And Deadlines", "[threadpool]") {
+    using Priority = ghoul::ThreadPool::Priority;
+
+    // With a stopped ThreadPool, all tasks are queued before the single Worker starts
+    ghoul::ThreadPool pool(1);
+    pool.stop();
+
+    std::vector<int> order;
+    const auto now = std::chrono::steady_clock::now();
+    pool.submit({ Priority::Low }, [&order]() { order.push_back(4); });
+    pool.submit([&order]() { order.push_back(3); });
+    pool.submit({ Priority::High }, [&order]() { order.push_back(2); });
+    pool.submit(
+        { Priority::Low, now + std::chrono::milliseconds(10) },
+        [&order]() { order.push_back(1); }
+    );
+    pool.submit(
+        { Priority::Low, now + std::chrono::milliseconds(5) },
+        [&order]() { order.push_back(0); }
+    );
+    CHECK(pool.remainingTasks() == 5);
+
+    pool.start();
+    pool.stop();
+    CHECK(order == std::vector<int>{ 0, 1, 2, 3, 4 });
+}
+
+TEST_CASE("ThreadPool: Starvation Protection", "[threadpool]") {
+    using Priority = ghoul::ThreadPool::Priority;
+
+    ghoul::ThreadPool pool(1);
+    pool.stop();
+
+    std::vector<int> order;
+    pool.submit({ Priority::Low }, [&order]() { order.push_back(-1); });
+    for (int i = 0; i < 2 * ghoul::ThreadPool::StarvationLimit; ++i) {
+        pool.submit({ Priority::High }, [&order, i]() { order.push_back(i); });
+    }
+
+    pool.start();
+    pool.stop();
+
+    // The low priority task has been passed over StarvationLimit times
+    auto it = std::find(order.begin(), order.end(), -1);
+    REQUIRE(it != order.end());
+    CHECK(std::distance(order.begin(), it) == ghoul::ThreadPool::StarvationLimit);
+}
+
+TEST_CASE("ThreadPool: Cancel", "[threadpool]") {
+    ghoul::ThreadPool pool(1);
+    pool.stop();
+
+    std::vector<int> order;
+    ghoul::TaskFuture<void> f1 = pool.submit([&order]() { order.push_back(1); });
+    ghoul::TaskFuture<void> f2 = pool.submit([&order]() { order.push_back(2); });
+    ghoul::TaskFuture<void> f3 = pool.submit([&order]() { order.push_back(3); });
+    CHECK(f1.taskId() != f2.taskId());
+
+    CHECK(pool.cancel(f2.taskId()));
+    CHECK_FALSE(pool.cancel(f2.taskId()));
+    CHECK(pool.remainingTasks() == 2);
+    CHECK_THROWS_AS(f2.get(), ghoul::RuntimeError);
+
+    pool.start();
+    pool.stop();
+    CHECK(order == std::vector<int>{ 1, 3 });
+    CHECK_FALSE(pool.cancel(f1.taskId()));
+}
+
+TEST_CASE("ThreadPool: Reprioritize", "[threadpool]") {
+    using Priority = ghoul::ThreadPool::Priority;
+
+    ghoul::ThreadPool pool(1);
+    pool.stop();
+
+    std::vector<int> order;
+    ghoul::TaskFuture<void> f1 = pool.submit([&order]() { order.push_back(1); });
+    ghoul::TaskFuture<void> f2 = pool.submit(
+        { Priority::Low },
+        [&order]() { order.push_back(2); }
+    );
+    CHECK(pool.reprioritize(f2.taskId(), Priority::High));
+
+    pool.start();
+    pool.stop();
+    CHECK(order == std::vector<int>{ 2, 1 });
+    CHECK_FALSE(pool.reprioritize(f1.taskId(), Priority::High));
+}